@@ -32,11 +32,16 @@
 
 // std includes
 #include <any>
+#include <functional>
 #include <iomanip>
+#include <mutex>
 #include <sstream>
+#include <type_traits>
 #include <unordered_map>
 // ROS includes
+#include <rclcpp/expand_topic_or_service_name.hpp>
 #include <rclcpp/rclcpp.hpp>
+#include <rclcpp/serialization.hpp>
 // tf2 includes
 #include <tf2_ros/transform_broadcaster.h>
 #include <tf2_ros/transform_listener.h>
@@ -50,15 +55,18 @@
 // ROS msg includes
 #include <diagnostic_msgs/msg/diagnostic_array.hpp>
 #include <diagnostic_msgs/msg/diagnostic_status.hpp>
+#include <diagnostic_msgs/msg/key_value.hpp>
 #include <geometry_msgs/msg/pose_with_covariance_stamped.hpp>
 #include <geometry_msgs/msg/quaternion.hpp>
 #include <geometry_msgs/msg/twist_with_covariance.hpp>
 #include <geometry_msgs/msg/twist_with_covariance_stamped.hpp>
 #include <gps_msgs/msg/gps_fix.hpp>
 #include <nav_msgs/msg/odometry.hpp>
+#include <rosgraph_msgs/msg/clock.hpp>
 #include <sensor_msgs/msg/imu.hpp>
 #include <sensor_msgs/msg/nav_sat_fix.hpp>
 #include <sensor_msgs/msg/time_reference.hpp>
+#include <tf2_msgs/msg/tf_message.hpp>
 // GNSS msg includes
 #include <septentrio_gnss_driver/msg/aim_plus_status.hpp>
 #include <septentrio_gnss_driver/msg/att_cov_euler.hpp>
@@ -93,6 +101,7 @@
 #include <septentrio_gnss_driver/msg/ins_nav_geod.hpp>
 #include <septentrio_gnss_driver/msg/vel_sensor_setup.hpp>
 // Rosaic includes
+#include <septentrio_gnss_driver/communication/replay_clock.hpp>
 #include <septentrio_gnss_driver/communication/settings.hpp>
 #include <septentrio_gnss_driver/parsers/string_utilities.hpp>
 
@@ -104,6 +113,7 @@ typedef rclcpp::Time TimestampRos;
 // ROS messages
 typedef diagnostic_msgs::msg::DiagnosticArray DiagnosticArrayMsg;
 typedef diagnostic_msgs::msg::DiagnosticStatus DiagnosticStatusMsg;
+typedef diagnostic_msgs::msg::KeyValue KeyValueMsg;
 typedef geometry_msgs::msg::Quaternion QuaternionMsg;
 typedef geometry_msgs::msg::PoseWithCovarianceStamped PoseWithCovarianceStampedMsg;
 typedef geometry_msgs::msg::TwistWithCovarianceStamped TwistWithCovarianceStampedMsg;
@@ -115,6 +125,7 @@ typedef sensor_msgs::msg::NavSatStatus NavSatStatusMsg;
 typedef sensor_msgs::msg::TimeReference TimeReferenceMsg;
 typedef sensor_msgs::msg::Imu ImuMsg;
 typedef nav_msgs::msg::Odometry LocalizationMsg;
+typedef rosgraph_msgs::msg::Clock ClockMsg;
 
 // Septentrio GNSS SBF messages
 typedef septentrio_gnss_driver::msg::AIMPlusStatus AimPlusStatusMsg;
@@ -170,6 +181,30 @@ inline Timestamp timestampFromRos(const TimestampRos& tsr)
     return tsr.nanoseconds();
 }
 
+/**
+ * @brief Receives the messages of a node instead of them being published, e.g. to
+ * write a bag offline
+ * @param[in] topic Fully qualified topic name
+ * @param[in] type Message type, e.g. "sensor_msgs/msg/NavSatFix"
+ * @param[in] message Serialized message
+ * @param[in] stamp Header stamp of the message, 0 if it has no header
+ */
+typedef std::function<void(const std::string& topic, const std::string& type,
+                           std::shared_ptr<rclcpp::SerializedMessage> message,
+                           Timestamp stamp)>
+    MessageSink;
+
+//! Whether a message type has a header with a stamp
+template <typename M, typename = void>
+struct HasHeader : std::false_type
+{
+};
+template <typename M>
+struct HasHeader<M, std::void_t<decltype(std::declval<M>().header.stamp)>> :
+    std::true_type
+{
+};
+
 /**
  * @brief Log level for ROS logging
  */
@@ -304,6 +339,12 @@ public:
      */
     Timestamp getTime() const { return this->now().nanoseconds(); }
 
+    /**
+     * @brief Whether the node's clock is driven by the /clock topic
+     * @return True if simulated time is active
+     */
+    bool usesSimTime() const { return this->get_clock()->ros_time_is_active(); }
+
     /**
      * @brief Publishing function
      * @param[in] topic String of topic
@@ -312,19 +353,29 @@ public:
     template <typename M>
     void publishMessage(const std::string& topic, const M& msg)
     {
-        auto it = topicMap_.find(topic);
-        if (it != topicMap_.end())
+        if (messageSink_)
         {
-            typename rclcpp::Publisher<M>::SharedPtr ptr =
-                std::any_cast<typename rclcpp::Publisher<M>::SharedPtr>(it->second);
-            ptr->publish(msg);
-        } else
+            sinkMessage(topic, msg);
+            return;
+        }
+
+        typename rclcpp::Publisher<M>::SharedPtr pub;
         {
-            typename rclcpp::Publisher<M>::SharedPtr pub =
-                this->create_publisher<M>(topic, queueSize_);
-            topicMap_.insert(std::make_pair(topic, pub));
-            pub->publish(msg);
+            // Messages may be published from the processing thread and from
+            // timers
+            std::lock_guard<std::mutex> lock(topicMapMutex_);
+            auto it = topicMap_.find(topic);
+            if (it != topicMap_.end())
+            {
+                pub = std::any_cast<typename rclcpp::Publisher<M>::SharedPtr>(
+                    it->second);
+            } else
+            {
+                pub = this->create_publisher<M>(topic, queueSize_);
+                topicMap_.insert(std::make_pair(topic, pub));
+            }
         }
+        pub->publish(msg);
     }
 
     /**
@@ -395,9 +446,22 @@ public:
             transformStamped.child_frame_id = settings_.local_frame_id;
         }
 
+        if (messageSink_)
+        {
+            tf2_msgs::msg::TFMessage tfMsg;
+            tfMsg.transforms.push_back(transformStamped);
+            sinkMessage("/tf", tfMsg);
+            return;
+        }
         tf2Publisher_.sendTransform(transformStamped);
     }
 
+    /**
+     * @brief Passes all messages to a sink instead of publishing them
+     * @param[in] sink Message sink, e.g. writing a bag
+     */
+    void setMessageSink(MessageSink sink) { messageSink_ = std::move(sink); }
+
     /**
      * @brief Set INS to true
      */
@@ -428,6 +492,11 @@ public:
      */
     bool hasImprovedVsmHandling() { return capabilities_.has_improved_vsm_handling; }
 
+    /**
+     * @brief Clock pacing the replay of files
+     */
+    io::ReplayClock& replayClock() { return replayClock_; }
+
 private:
     void callbackOdometry(const nav_msgs::msg::Odometry::SharedPtr odo)
     {
@@ -570,8 +639,36 @@ protected:
     virtual void sendVelocity(const std::string& velNmea) = 0;
 
 private:
+    template <typename M>
+    void sinkMessage(const std::string& topic, const M& msg)
+    {
+        std::string name;
+        {
+            std::lock_guard<std::mutex> lock(topicMapMutex_);
+            auto it = sinkTopics_.find(topic);
+            if (it == sinkTopics_.end())
+                it = sinkTopics_
+                         .emplace(topic, rclcpp::expand_topic_or_service_name(
+                                             topic, this->get_name(),
+                                             this->get_namespace()))
+                         .first;
+            name = it->second;
+        }
+
+        auto serialized = std::make_shared<rclcpp::SerializedMessage>();
+        rclcpp::Serialization<M>().serialize_message(&msg, serialized.get());
+        Timestamp stamp = 0;
+        if constexpr (HasHeader<M>::value)
+            stamp = timestampFromRos(msg.header.stamp);
+        else if constexpr (std::is_same<M, tf2_msgs::msg::TFMessage>::value)
+            stamp = timestampFromRos(msg.transforms.front().header.stamp);
+        messageSink_(name, rosidl_generator_traits::name<M>(), serialized, stamp);
+    }
+
     //! Map of topics and publishers
     std::unordered_map<std::string, std::any> topicMap_;
+    //! Mutex for topicMap_ and sinkTopics_
+    std::mutex topicMapMutex_;
     //! Publisher queue size
     uint32_t queueSize_ = 1;
     //! Transform publisher
@@ -588,4 +685,10 @@ private:
     tf2_ros::TransformListener tfListener_;
     // Capabilities of Rx
     Capabilities capabilities_;
+    //! Paces the replay of files
+    io::ReplayClock replayClock_;
+    //! Receives the messages instead of publishers if set
+    MessageSink messageSink_;
+    //! Fully qualified names of the topics passed to messageSink_
+    std::unordered_map<std::string, std::string> sinkTopics_;
 };
\ No newline at end of file
@@ -58,6 +58,12 @@
 
 #pragma once
 
+// C++
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <thread>
+
 // Boost includes
 #include <boost/asio.hpp>
 #include <boost/bind.hpp>
@@ -68,8 +74,14 @@
 #include <septentrio_gnss_driver/parsers/parsing_utilities.hpp>
 
 // local includes
+#include <septentrio_gnss_driver/communication/connection_monitor.hpp>
 #include <septentrio_gnss_driver/communication/io.hpp>
-#include <septentrio_gnss_driver/communication/telegram.hpp>
+#include <septentrio_gnss_driver/communication/io_context_pool.hpp>
+#include <septentrio_gnss_driver/communication/io_diagnostics.hpp>
+#include <septentrio_gnss_driver/communication/receive_clock.hpp>
+#include <septentrio_gnss_driver/communication/telegram_framer.hpp>
+#include <septentrio_gnss_driver/communication/telegram_queue.hpp>
+#include <septentrio_gnss_driver/communication/write_queue.hpp>
 
 /**
  * @file async_manager.hpp
@@ -82,6 +94,10 @@
 
 namespace io {
 
+    //! Number of bytes of a file framed at once, the telegrams share a timestamp.
+    //! Other handlers of the connection run in between when reading a capture.
+    static const size_t MAPPED_SLICE_SIZE = 1048576;
+
     /**
      * @class AsyncManagerBase
      * @brief Interface (in C++ terms), that could be used for any I/O manager,
@@ -90,11 +106,41 @@ namespace io {
     class AsyncManagerBase
     {
     public:
+        //! Called on the I/O thread with each message whose write failed
+        typedef std::function<void(const std::string& message,
+                                   const std::string& error)>
+            WriteFailureHandler;
+
         virtual ~AsyncManagerBase() {}
         //! Connects the stream
         [[nodiscard]] virtual bool connect() = 0;
-        //! Sends commands to the receiver
-        virtual void send(const std::string& cmd) = 0;
+        /**
+         * @brief Sends commands or data to the receiver
+         * @param[in] cmd Command or data
+         * @param[in] priority REALTIME is sent before queued COMMANDs
+         */
+        virtual void send(std::string cmd,
+                          write_priority::WritePriority priority) = 0;
+        /**
+         * @brief Appends the I/O statistics to a diagnostic status
+         * @param[in] prefix Prefix of the keys
+         * @param[in,out] status Diagnostic status
+         */
+        virtual void appendDiagnostics(const std::string& prefix,
+                                       DiagnosticStatusMsg& status) const = 0;
+        //! Number of telegrams discarded due to a wrong CRC
+        [[nodiscard]] virtual uint64_t crcFailures() const = 0;
+        /**
+         * @brief Reconnects if no data arrives for a given time
+         * @param[in] timeout Maximum time without data
+         */
+        virtual void monitorSilence(std::chrono::milliseconds timeout) = 0;
+        /**
+         * @brief Sets the handler of failed writes, e.g. to give up on the
+         * commands waiting for a response. Has to be set before sending.
+         * @param[in] handler Handler of failed writes
+         */
+        virtual void setWriteFailureHandler(WriteFailureHandler handler) = 0;
     };
 
     /**
@@ -111,9 +157,14 @@ namespace io {
         /**
          * @brief Class constructor
          * @param[in] node Pointer to node
-         * @param[in] telegramQueue Telegram queue
+         * @param[in] telegramQueue Telegram queue, has to be closed before
+         * destruction if a memory-mapped file is replayed
+         * @param[in] ioPool Runs the I/O, has to be stopped before destruction
+         * @param[in] recorder Records the received bytes if set, has to outlive
+         * the I/O
          */
-        AsyncManager(ROSaicNodeBase* node, TelegramQueue* telegramQueue);
+        AsyncManager(ROSaicNodeBase* node, TelegramQueue* telegramQueue,
+                     IoContextPool* ioPool, RecordChannel* recorder = nullptr);
 
         ~AsyncManager();
 
@@ -121,14 +172,60 @@ namespace io {
 
         void setPort(const std::string& port);
 
-        void send(const std::string& cmd);
+        void monitorSilence(std::chrono::milliseconds timeout);
+
+        void setWriteFailureHandler(WriteFailureHandler handler)
+        {
+            writeFailureHandler_ = std::move(handler);
+        }
+
+        void send(std::string cmd, write_priority::WritePriority priority);
+
+        void appendDiagnostics(const std::string& prefix,
+                               DiagnosticStatusMsg& status) const;
+
+        [[nodiscard]] uint64_t crcFailures() const
+        {
+            return framer_.statistics().crcFailures;
+        }
 
     private:
         void receive();
-        void close();
-        void runIoService();
-        void runWatchdog();
-        void write(const std::string& cmd);
+        /**
+         * @brief Called when reading failed, schedules reconnecting unless a file
+         * has been read completely
+         * @param[in] error Description of the error
+         */
+        void handleReadError(const std::string& error);
+        //! Tries to reconnect after the next backoff delay
+        void scheduleReconnect();
+        //! Periodically writes to a TCP connection to detect if it was lost
+        void scheduleAliveCheck();
+        //! Periodically checks whether data arrived within the silence timeout
+        void scheduleSilenceCheck();
+        //! Updates the outage statistics on arrival of data
+        void dataReceived();
+        /**
+         * @brief Continues reading after the telegram queue drained
+         * @param[in] pause Pause of the framer which may end
+         */
+        void resumeReading(uint64_t pause);
+        //! Hands over the telegram read byte by byte and reads the next one, or
+        //! pauses until the telegram queue drained
+        void enqueueTelegram();
+        //! Writes the next batch of the write queue
+        void write();
+        void readChunk();
+        //! Reads a chunk with recvmsg() to obtain the kernel receive timestamp
+        void readChunkTimestamped();
+        //! Frames the byte ranges of a memory-mapped file in place, runs on its own
+        //! thread since it waits for space in the telegram queue
+        void readMapped();
+        //! Decodes the next packets of a capture and frames the stream of the Rx
+        void readPackets();
+        void commitChunk(size_t numBytes, Timestamp stamp);
+        //! Logs the SBF blocks failing the CRC check since the given count
+        void logCrcFailures(uint64_t crcFailures);
         void resync();
         template <uint8_t index>
         void readSync();
@@ -140,11 +237,30 @@ namespace io {
 
         //! Pointer to the node
         ROSaicNodeBase* node_;
-        std::shared_ptr<boost::asio::io_service> ioService_;
+        //! Runs the handlers of the stream and the timers one at a time
+        IoExecutor strand_;
         IoType ioInterface_;
         std::atomic<bool> running_;
-        std::thread ioThread_;
-        std::thread watchdogThread_;
+        boost::asio::steady_timer reconnectTimer_;
+        boost::asio::steady_timer aliveTimer_;
+        boost::asio::steady_timer silenceTimer_;
+        //! Maximum time without data before reconnecting, 0 if not monitored
+        std::chrono::milliseconds silenceTimeout_{0};
+        //! Whether the stream is being read, only used by the strand
+        bool connected_ = false;
+        //! Whether a reconnection is in progress, only used by the strand
+        bool connecting_ = false;
+        //! Whether writing the queue waits for the reconnection
+        bool writeDeferred_ = false;
+        //! Whether reading byte by byte waits for the telegram queue to drain,
+        //! only used by the strand
+        bool paused_ = false;
+        //! Number of pauses of reading byte by byte, identifies the current one
+        uint64_t pauses_ = 0;
+        //! Replays a memory-mapped file
+        std::thread mappedThread_;
+        ReconnectBackoff backoff_;
+        ConnectionMonitor monitor_;
 
         std::array<uint8_t, 1> buf_;
         //! Timestamp of receiving buffer
@@ -153,15 +269,47 @@ namespace io {
         std::shared_ptr<Telegram> telegram_;
         //! TelegramQueue
         TelegramQueue* telegramQueue_;
+        //! Pool of telegrams
+        TelegramPool telegramPool_;
+        //! Framer for bulk reads
+        TelegramFramer framer_;
+        //! Clock for arrival timestamps
+        ReceiveClock clock_;
+        //! Outbound messages
+        WriteQueue writeQueue_;
+        //! Buffers of the batch being written
+        std::vector<boost::asio::const_buffer> writeBuffers_;
+        WriteFailureHandler writeFailureHandler_;
     };
 
     template <typename IoType>
     AsyncManager<IoType>::AsyncManager(ROSaicNodeBase* node,
-                                       TelegramQueue* telegramQueue) :
+                                       TelegramQueue* telegramQueue,
+                                       IoContextPool* ioPool,
+                                       RecordChannel* recorder) :
         node_(node),
-        ioService_(new boost::asio::io_service), ioInterface_(node, ioService_),
-        telegramQueue_(telegramQueue)
+        strand_(ioPool->makeStrand()), ioInterface_(node, strand_), running_(false),
+        reconnectTimer_(strand_), aliveTimer_(strand_), silenceTimer_(strand_),
+        backoff_(node->settings()->reconnect_delay_s,
+                 node->settings()->reconnect_max_delay_s,
+                 node->settings()->reconnect_jitter),
+        telegramQueue_(telegramQueue),
+        telegramPool_(node->settings()->telegram_pool_size),
+        framer_(telegramQueue, &telegramPool_), clock_(node)
     {
+        // Reading stops instead of blocking the I/O thread while the queue is full
+        framer_.setResumeHandler([this](uint64_t pause) {
+            boost::asio::post(strand_, [this, pause]() { resumeReading(pause); });
+        });
+        if (recorder)
+        {
+            // Byte-wise reading only sees the telegrams, not the stream
+            if (node_->settings()->bulk_read)
+                framer_.setRecorder(recorder);
+            else
+                node_->log(log_level::WARN,
+                           "Recording the received bytes requires io.bulk_read.");
+        }
         node_->log(log_level::DEBUG, "AsyncManager created.");
     }
 
@@ -169,12 +317,10 @@ namespace io {
     AsyncManager<IoType>::~AsyncManager()
     {
         running_ = false;
-        close();
-        node_->log(log_level::DEBUG, "AsyncManager shutting down threads");
-        ioService_->stop();
-        ioThread_.join();
-        watchdogThread_.join();
-        node_->log(log_level::DEBUG, "AsyncManager threads stopped");
+        telegramQueue_->cancel(this);
+        if (mappedThread_.joinable())
+            mappedThread_.join();
+        node_->log(log_level::DEBUG, "AsyncManager stopped");
     }
 
     template <typename IoType>
@@ -186,7 +332,8 @@ namespace io {
         {
             return false;
         }
-        receive();
+        // The stream is only used by the strand from now on
+        boost::asio::post(strand_, [this]() { receive(); });
 
         return true;
     }
@@ -198,7 +345,18 @@ namespace io {
     }
 
     template <typename IoType>
-    void AsyncManager<IoType>::send(const std::string& cmd)
+    void AsyncManager<IoType>::monitorSilence(std::chrono::milliseconds timeout)
+    {
+        boost::asio::post(strand_, [this, timeout]() {
+            silenceTimeout_ = timeout;
+            monitor_.watch();
+            scheduleSilenceCheck();
+        });
+    }
+
+    template <typename IoType>
+    void AsyncManager<IoType>::send(std::string cmd,
+                                    write_priority::WritePriority priority)
     {
         if (cmd.size() == 0)
         {
@@ -207,95 +365,479 @@ namespace io {
             return;
         }
 
-        ioService_->post(boost::bind(&AsyncManager<IoType>::write, this, cmd));
+        // Only one write may be in flight, it continues with queued messages
+        if (writeQueue_.push(std::move(cmd), priority))
+            boost::asio::post(strand_, [this]() { write(); });
     }
 
     template <typename IoType>
-    void AsyncManager<IoType>::receive()
+    void AsyncManager<IoType>::appendDiagnostics(const std::string& prefix,
+                                                 DiagnosticStatusMsg& status) const
     {
-        resync();
-        ioThread_ =
-            std::thread(std::bind(&AsyncManager<IoType>::runIoService, this));
-        if (!watchdogThread_.joinable())
-            watchdogThread_ =
-                std::thread(std::bind(&AsyncManager::runWatchdog, this));
+        if (node_->settings()->bulk_read ||
+            std::is_same<PcapFileIo, IoType>::value)
+            addDiagnosticValues(status, prefix, framer_.statistics());
+        if constexpr (std::is_same<PcapFileIo, IoType>::value)
+            addDiagnosticValues(status, prefix, ioInterface_.statistics());
+        addDiagnosticValues(status, prefix, telegramPool_.statistics());
+        if (node_->settings()->kernel_timestamps)
+            addDiagnosticValues(status, prefix, clock_.statistics());
+        addDiagnosticValues(status, prefix, monitor_.statistics());
+        addDiagnosticValues(status, prefix, writeQueue_);
     }
 
     template <typename IoType>
-    void AsyncManager<IoType>::close()
+    void AsyncManager<IoType>::receive()
     {
-        ioService_->post([this]() { ioInterface_.close(); });
+        if constexpr (std::is_same<SbfFileIo, IoType>::value)
+        {
+            if (ioInterface_.mapped())
+            {
+                connected_ = true;
+                framer_.reset();
+                framer_.setResumeHandler(nullptr);
+                mappedThread_ = std::thread(&AsyncManager::readMapped, this);
+                std::string error;
+                if (!configureThread(mappedThread_.native_handle(),
+                                     "septentrio_file", ThreadScheduling(), error))
+                    node_->log(log_level::WARN, "File replay thread: " + error);
+                return;
+            }
+        }
+        if constexpr (std::is_same<PcapFileIo, IoType>::value)
+        {
+            connected_ = true;
+            framer_.reset();
+            readPackets();
+            return;
+        }
+        if (node_->settings()->bulk_read)
+        {
+            framer_.reset();
+            readChunk();
+        } else
+        {
+            if (paused_)
+            {
+                telegramQueue_->cancel(this);
+                paused_ = false;
+            }
+            resync();
+        }
+        connected_ = true;
+        if constexpr (std::is_same<TcpIo, IoType>::value)
+        {
+            if (!node_->settings()->tcp_keepalive)
+                scheduleAliveCheck();
+        }
     }
 
     template <typename IoType>
-    void AsyncManager<IoType>::runIoService()
+    void AsyncManager<IoType>::handleReadError(const std::string& error)
     {
-        ioService_->run();
-        node_->log(log_level::DEBUG, "AsyncManager ioService terminated.");
+        // Closing the stream after a loss makes the pending read fail as well
+        if (!running_ || !connected_)
+            return;
+        connected_ = false;
+
+        if (node_->settings()->read_from_sbf_log ||
+            node_->settings()->read_from_pcap)
+        {
+            node_->log(
+                log_level::INFO,
+                "AsyncManager finished reading file. Node will continue to publish queued messages.");
+            return;
+        }
+
+        node_->log(log_level::ERROR, "AsyncManager connection lost (" + error +
+                                         "). Trying to reconnect.");
+        monitor_.lost();
+        aliveTimer_.cancel();
+        ioInterface_.close();
+        scheduleReconnect();
     }
 
     template <typename IoType>
-    void AsyncManager<IoType>::runWatchdog()
+    void AsyncManager<IoType>::scheduleReconnect()
     {
-        while (running_)
-        {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-            if (running_ && ioService_->stopped())
-            {
-                if (node_->settings()->read_from_sbf_log ||
-                    node_->settings()->read_from_pcap)
+        reconnectTimer_.expires_after(backoff_.next());
+        reconnectTimer_.async_wait([this](const boost::system::error_code& ec) {
+            if (ec || !running_)
+                return;
+
+            monitor_.attempt();
+            connecting_ = true;
+            auto connected = [this](bool success) {
+                connecting_ = false;
+                if (!running_)
+                    return;
+                if (success)
                 {
-                    node_->log(
-                        log_level::INFO,
-                        "AsyncManager finished reading file. Node will continue to publish queued messages.");
-                    break;
+                    monitor_.reconnected();
+                    node_->log(log_level::INFO,
+                               "AsyncManager reconnected after " +
+                                   std::to_string(backoff_.attempts()) +
+                                   " attempt(s).");
+                    receive();
+                    if (writeDeferred_)
+                    {
+                        writeDeferred_ = false;
+                        write();
+                    }
                 } else
+                    scheduleReconnect();
+            };
+            // Connecting blocks for up to seconds, which would stall the other
+            // streams sharing the I/O threads
+            if constexpr (std::is_same<TcpIo, IoType>::value ||
+                          std::is_same<SerialIo, IoType>::value)
+                ioInterface_.asyncConnect(connected);
+            else
+                connected(ioInterface_.connect());
+        });
+    }
+
+    template <typename IoType>
+    void AsyncManager<IoType>::scheduleAliveCheck()
+    {
+        aliveTimer_.expires_after(std::chrono::seconds(1));
+        aliveTimer_.async_wait([this](const boost::system::error_code& ec) {
+            if (ec || !running_)
+                return;
+
+            // A write to a lost TCP connection fails, which makes the pending
+            // read fail as well
+            send(" ", write_priority::COMMAND);
+            scheduleAliveCheck();
+        });
+    }
+
+    template <typename IoType>
+    void AsyncManager<IoType>::scheduleSilenceCheck()
+    {
+        silenceTimer_.expires_after(silenceTimeout_ / 2);
+        silenceTimer_.async_wait([this](const boost::system::error_code& ec) {
+            if (ec || !running_)
+                return;
+
+            // Reconnecting restarts measuring the silence, a connection is
+            // not read while the telegram queue is full
+            std::chrono::nanoseconds silence = monitor_.silence();
+            if (connected_ && !paused_ && !framer_.paused() &&
+                (silence > silenceTimeout_))
+                handleReadError(
+                    "no data for " +
+                    std::to_string(
+                        std::chrono::duration_cast<std::chrono::milliseconds>(
+                            silence)
+                            .count()) +
+                    " ms");
+            scheduleSilenceCheck();
+        });
+    }
+
+    template <typename IoType>
+    void AsyncManager<IoType>::dataReceived()
+    {
+        if (monitor_.dataReceived())
+        {
+            // The backoff only starts over once a reconnection delivers data
+            backoff_.reset();
+            node_->log(log_level::INFO,
+                       "AsyncManager data resumed after an outage of " +
+                           std::to_string(monitor_.lastOutageMs()) + " ms.");
+        }
+    }
+
+    template <typename IoType>
+    void AsyncManager<IoType>::resumeReading(uint64_t pause)
+    {
+        if (!running_ || !connected_ || !framer_.resume(pause))
+            return;
+        // The silence is measured from now on
+        monitor_.watch();
+        if constexpr (std::is_same<PcapFileIo, IoType>::value)
+            readPackets();
+        else
+            readChunk();
+    }
+
+    template <typename IoType>
+    void AsyncManager<IoType>::enqueueTelegram()
+    {
+        while (!telegramQueue_->offer(telegram_))
+        {
+            paused_ = true;
+            uint64_t pause = ++pauses_;
+            if (telegramQueue_->resumeWhenDrained(
+                    *telegram_, this, [this, pause]() {
+                        boost::asio::post(strand_, [this, pause]() {
+                            if (!running_ || !connected_ || !paused_ ||
+                                (pause != pauses_))
+                                return;
+                            paused_ = false;
+                            monitor_.watch();
+                            enqueueTelegram();
+                        });
+                    }))
+                return;
+            paused_ = false;
+        }
+        resync();
+    }
+
+    template <typename IoType>
+    void AsyncManager<IoType>::write()
+    {
+        // The stream is being replaced, the queue is written once it is up
+        if (connecting_)
+        {
+            writeDeferred_ = true;
+            return;
+        }
+
+        const std::vector<std::string>& batch = writeQueue_.gather();
+        writeBuffers_.clear();
+        for (const std::string& message : batch)
+            writeBuffers_.push_back(boost::asio::buffer(message));
+
+        boost::asio::async_write(
+            *(ioInterface_.stream_), writeBuffers_,
+            [this, &batch](boost::system::error_code ec, std::size_t /*length*/) {
+                for (const std::string& cmd : batch)
                 {
-                    node_->log(log_level::ERROR,
-                               "AsyncManager connection lost. Trying to reconnect.");
-                    ioService_->reset();
-                    ioThread_.join();
-                    while (!ioInterface_.connect())
-                        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-                    receive();
+                    if (!ec)
+                    {
+                        // Prints the data that was sent
+                        node_->log(log_level::DEBUG,
+                                   "AsyncManager sent the following " +
+                                       std::to_string(cmd.size()) +
+                                       " bytes to the Rx: " + cmd);
+                    } else
+                    {
+                        node_->log(log_level::ERROR,
+                                   "AsyncManager was unable to send the following " +
+                                       std::to_string(cmd.size()) +
+                                       " bytes to the Rx: " + cmd);
+                        if (writeFailureHandler_)
+                            writeFailureHandler_(cmd, ec.message());
+                    }
                 }
-            } else if (running_ && std::is_same<TcpIo, IoType>::value)
+                if (writeQueue_.complete(!ec))
+                    write();
+            });
+    }
+
+    template <typename IoType>
+    void AsyncManager<IoType>::readChunk()
+    {
+        if constexpr (std::is_same<TcpIo, IoType>::value)
+        {
+            if (node_->settings()->kernel_timestamps)
             {
-                // Send to check if TCP connection still alive
-                std::string empty = " ";
-                boost::asio::async_write(
-                    *(ioInterface_.stream_), boost::asio::buffer(empty.data(), 1),
-                    [](boost::system::error_code ec, std::size_t /*length*/) {});
+                readChunkTimestamped();
+                return;
             }
         }
+
+        ioInterface_.stream_->async_read_some(
+            boost::asio::buffer(framer_.prepare(READ_CHUNK_SIZE), READ_CHUNK_SIZE),
+            [this](boost::system::error_code ec, std::size_t numBytes) {
+                Timestamp stamp = clock_.now();
+
+                if (!ec)
+                {
+                    commitChunk(numBytes, stamp);
+                    // Continued by resumeReading()
+                    if (!framer_.paused())
+                        readChunk();
+                } else
+                {
+                    node_->log(log_level::DEBUG,
+                               "AsyncManager chunk read error: " + ec.message());
+                    handleReadError(ec.message());
+                }
+            });
     }
 
     template <typename IoType>
-    void AsyncManager<IoType>::write(const std::string& cmd)
+    void AsyncManager<IoType>::readChunkTimestamped()
     {
-        boost::asio::async_write(
-            *(ioInterface_.stream_), boost::asio::buffer(cmd.data(), cmd.size()),
-            [this, cmd](boost::system::error_code ec, std::size_t /*length*/) {
-                if (!ec)
+        ioInterface_.stream_->async_wait(
+            boost::asio::socket_base::wait_read,
+            [this](boost::system::error_code ec) {
+                if (ec)
                 {
-                    // Prints the data that was sent
-                    node_->log(log_level::DEBUG, "AsyncManager sent the following " +
-                                                     std::to_string(cmd.size()) +
-                                                     " bytes to the Rx: " + cmd);
+                    node_->log(log_level::DEBUG,
+                               "AsyncManager chunk read error: " + ec.message());
+                    handleReadError(ec.message());
+                    return;
+                }
+
+                timespec kernelStamp;
+                ssize_t numBytes = receiveWithTimestamp(
+                    ioInterface_.stream_->native_handle(),
+                    framer_.prepare(READ_CHUNK_SIZE), READ_CHUNK_SIZE, nullptr,
+                    nullptr, kernelStamp);
+                Timestamp stamp = clock_.now();
+
+                if (numBytes > 0)
+                {
+                    // For TCP the kernel stamps the latest segment of the chunk
+                    if (kernelStamp.tv_sec != 0)
+                    {
+                        Timestamp kernel = clock_.fromKernel(kernelStamp);
+                        clock_.recordKernelDelay(kernel, stamp);
+                        stamp = kernel;
+                    }
+                    commitChunk(numBytes, stamp);
+                    if (!framer_.paused())
+                        readChunkTimestamped();
+                } else if ((numBytes < 0) &&
+                           ((errno == EAGAIN) || (errno == EWOULDBLOCK) ||
+                            (errno == EINTR)))
+                {
+                    readChunkTimestamped();
                 } else
                 {
-                    node_->log(log_level::ERROR,
-                               "AsyncManager was unable to send the following " +
-                                   std::to_string(cmd.size()) +
-                                   " bytes to the Rx: " + cmd);
+                    std::string error =
+                        (numBytes == 0) ? "end of file" : std::strerror(errno);
+                    node_->log(log_level::DEBUG,
+                               "AsyncManager chunk read error: " + error);
+                    handleReadError(error);
                 }
             });
     }
 
+    template <typename IoType>
+    void AsyncManager<IoType>::readMapped()
+    {
+        if constexpr (std::is_same<SbfFileIo, IoType>::value)
+        {
+            const auto& ranges = ioInterface_.ranges();
+            const uint8_t* data = ioInterface_.data();
+            for (size_t range = 0; running_ && (range < ranges.size()); ++range)
+            {
+                size_t offset = ranges[range].begin;
+                while (running_)
+                {
+                    size_t end =
+                        std::min(offset + MAPPED_SLICE_SIZE, ranges[range].end);
+                    uint64_t crcFailures = framer_.statistics().crcFailures;
+                    // Telegrams are copied straight from the mapping into the
+                    // pooled telegrams, the queue blocks while the processing
+                    // thread catches up
+                    offset += framer_.frameInPlace(data + offset, end - offset,
+                                                   clock_.now());
+                    logCrcFailures(crcFailures);
+
+                    if (end == ranges[range].end)
+                    {
+                        if (offset < end)
+                            node_->log(log_level::DEBUG,
+                                       "AsyncManager dropped incomplete telegram "
+                                       "of " +
+                                           std::to_string(end - offset) +
+                                           " bytes at end of range.");
+                        break;
+                    }
+                }
+                // The next range starts with a telegram
+                framer_.reset();
+            }
+            boost::asio::post(strand_,
+                              [this]() { handleReadError("end of file"); });
+        }
+    }
+
+    template <typename IoType>
+    void AsyncManager<IoType>::readPackets()
+    {
+        if constexpr (std::is_same<PcapFileIo, IoType>::value)
+        {
+            if (!running_)
+                return;
+
+            PcapDecoder& decoder = ioInterface_.decoder();
+            // The stream of the Rx is framed as if it had been read from the
+            // socket, stamped with the capture time of the packet
+            PcapDecoder::PayloadSink sink = [this](const uint8_t* data,
+                                                   size_t size) {
+                std::memcpy(framer_.prepare(size), data, size);
+                framer_.commit(size, recvStamp_);
+            };
+
+            dataReceived();
+            uint64_t crcFailures = framer_.statistics().crcFailures;
+            size_t captured = 0;
+            int result = 1;
+            // The packet the framer paused at is buffered completely
+            while ((captured < MAPPED_SLICE_SIZE) && !framer_.paused())
+            {
+                pcap_pkthdr* header;
+                const u_char* data;
+                result = ioInterface_.next(header, data);
+                if (result != 1)
+                    break;
+                // Opened with nanosecond precision
+                recvStamp_ = static_cast<Timestamp>(header->ts.tv_sec) * 1000000000 +
+                             static_cast<Timestamp>(header->ts.tv_usec);
+                captured += header->caplen;
+                decoder.decode(data, header->caplen, sink);
+            }
+            if (result == 1)
+            {
+                logCrcFailures(crcFailures);
+                // Continued by resumeReading()
+                if (!framer_.paused())
+                    boost::asio::post(strand_, [this]() { readPackets(); });
+                return;
+            }
+
+            decoder.flush(sink);
+            logCrcFailures(crcFailures);
+            const PcapStatistics& stats = decoder.statistics();
+            if (!decoder.locked())
+                node_->log(log_level::WARN,
+                           "AsyncManager found no stream of the Rx in " +
+                               std::to_string(stats.packets) +
+                               " packets, check pcap.rx_ip and pcap.rx_port.");
+            else
+                node_->log(
+                    log_level::INFO,
+                    "AsyncManager decoded " + std::to_string(stats.packets) +
+                        " packets, " + std::to_string(stats.bytes) +
+                        " bytes of " + decoder.streamName() + ", " +
+                        std::to_string(stats.lostBytes) + " bytes missing.");
+            handleReadError((result == PCAP_ERROR_BREAK) ? "end of file"
+                                                         : ioInterface_.error());
+        }
+    }
+
+    template <typename IoType>
+    void AsyncManager<IoType>::commitChunk(size_t numBytes, Timestamp stamp)
+    {
+        dataReceived();
+        uint64_t crcFailures = framer_.statistics().crcFailures;
+        framer_.commit(numBytes, stamp);
+        logCrcFailures(crcFailures);
+    }
+
+    template <typename IoType>
+    void AsyncManager<IoType>::logCrcFailures(uint64_t crcFailures)
+    {
+        if (framer_.statistics().crcFailures != crcFailures)
+            node_->log(log_level::DEBUG,
+                       "AsyncManager crc failed for " +
+                           std::to_string(framer_.statistics().crcFailures -
+                                          crcFailures) +
+                           " SBF block(s).");
+    }
+
     template <typename IoType>
     void AsyncManager<IoType>::resync()
     {
-        telegram_.reset(new Telegram);
+        telegram_ = telegramPool_.acquire(3);
         readSync<0>();
     }
 
@@ -309,17 +851,18 @@ namespace io {
             *(ioInterface_.stream_),
             boost::asio::buffer(telegram_->message.data() + index, 1),
             [this](boost::system::error_code ec, std::size_t numBytes) {
-                Timestamp stamp = node_->getTime();
-
                 if (!ec)
                 {
                     if (numBytes == 1)
                     {
                         uint8_t& currByte = telegram_->message[index];
+                        if (index == 0)
+                            dataReceived();
 
                         if (currByte == SYNC_BYTE_1)
                         {
-                            telegram_->stamp = stamp;
+                            // Stamped once per telegram
+                            telegram_->stamp = clock_.now();
                             readSync<1>();
                         } else
                         {
@@ -456,6 +999,7 @@ namespace io {
                 {
                     node_->log(log_level::DEBUG,
                                "AsyncManager sync read error: " + ec.message());
+                    handleReadError(ec.message());
                 }
             });
     }
@@ -497,6 +1041,7 @@ namespace io {
                     node_->log(log_level::DEBUG,
                                "AsyncManager SBF header read error: " +
                                    ec.message());
+                    handleReadError(ec.message());
                 }
             });
     }
@@ -517,7 +1062,8 @@ namespace io {
                     {
                         if (crc::isValid(telegram_->message))
                         {
-                            telegramQueue_->push(telegram_);
+                            enqueueTelegram();
+                            return;
                         } else
                             node_->log(log_level::DEBUG,
                                        "AsyncManager crc failed for SBF  " +
@@ -536,6 +1082,7 @@ namespace io {
                 {
                     node_->log(log_level::DEBUG,
                                "AsyncManager SBF read error: " + ec.message());
+                    handleReadError(ec.message());
                 }
             });
     }
@@ -576,9 +1123,9 @@ namespace io {
                         {
                         case SYNC_BYTE_1:
                         {
-                            telegram_.reset(new Telegram);
+                            telegram_ = telegramPool_.acquire(3);
                             telegram_->message[0] = buf_[0];
-                            telegram_->stamp = node_->getTime();
+                            telegram_->stamp = clock_.now();
                             node_->log(
                                 log_level::DEBUG,
                                 "AsyncManager string read fault, sync 1 found.");
@@ -589,21 +1136,21 @@ namespace io {
                         {
                             if (telegram_->message[telegram_->message.size() - 2] ==
                                 CR)
-                                telegramQueue_->push(telegram_);
-                            else
-                                node_->log(
-                                    log_level::DEBUG,
-                                    "LF wo CR: " +
-                                        std::string(telegram_->message.begin(),
-                                                    telegram_->message.end()));
+                            {
+                                enqueueTelegram();
+                                break;
+                            }
+                            node_->log(log_level::DEBUG,
+                                       "LF wo CR: " +
+                                           std::string(telegram_->message.begin(),
+                                                       telegram_->message.end()));
                             resync();
                             break;
                         }
                         case CONNECTION_DESCRIPTOR_FOOTER:
                         {
                             telegram_->type = telegram_type::CONNECTION_DESCRIPTOR;
-                            telegramQueue_->push(telegram_);
-                            resync();
+                            enqueueTelegram();
                             break;
                         }
                         default:
@@ -624,6 +1171,7 @@ namespace io {
                 {
                     node_->log(log_level::DEBUG,
                                "AsyncManager string read error: " + ec.message());
+                    handleReadError(ec.message());
                 }
             });
     }
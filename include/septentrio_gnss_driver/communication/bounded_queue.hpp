@@ -0,0 +1,228 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#pragma once
+
+// C++
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @file bounded_queue.hpp
+ * @date 17/10/26
+ * @brief Lock-free bounded ring buffers
+ */
+
+namespace io {
+
+    //! Size of a cache line, used to keep producer and consumer indices apart
+    static const size_t CACHE_LINE_SIZE = 64;
+
+    //! Rounds up to the next power of two
+    inline size_t nextPowerOfTwo(size_t value)
+    {
+        size_t result = 1;
+        while (result < value)
+            result <<= 1;
+        return result;
+    }
+
+    /**
+     * @class SpscRing
+     * @brief Bounded lock-free ring buffer for one producer and one consumer
+     *
+     * Popped elements are moved out, so the ring does not keep references to them.
+     */
+    template <typename T>
+    class SpscRing
+    {
+    public:
+        /**
+         * @brief Constructor
+         * @param[in] capacity Minimum capacity, rounded up to a power of two
+         */
+        explicit SpscRing(size_t capacity) :
+            capacity_(nextPowerOfTwo(capacity)), mask_(capacity_ - 1),
+            buffer_(new T[capacity_])
+        {
+        }
+
+        //! Pushes an element, only to be called by the producer
+        [[nodiscard]] bool tryPush(T&& value)
+        {
+            size_t tail = tail_.load(std::memory_order_relaxed);
+            if ((tail - cachedHead_) == capacity_)
+            {
+                cachedHead_ = head_.load(std::memory_order_acquire);
+                if ((tail - cachedHead_) == capacity_)
+                    return false;
+            }
+            buffer_[tail & mask_] = std::move(value);
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        //! Pops an element, only to be called by the consumer
+        [[nodiscard]] bool tryPop(T& value)
+        {
+            size_t head = head_.load(std::memory_order_relaxed);
+            if (head == cachedTail_)
+            {
+                cachedTail_ = tail_.load(std::memory_order_acquire);
+                if (head == cachedTail_)
+                    return false;
+            }
+            value = std::move(buffer_[head & mask_]);
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        //! Number of elements, may be called from any thread
+        [[nodiscard]] size_t size() const
+        {
+            size_t head = head_.load(std::memory_order_acquire);
+            size_t tail = tail_.load(std::memory_order_acquire);
+            return (tail >= head) ? tail - head : 0;
+        }
+
+        [[nodiscard]] size_t capacity() const { return capacity_; }
+
+    private:
+        const size_t capacity_;
+        const size_t mask_;
+        std::unique_ptr<T[]> buffer_;
+        //! Consumer index and the consumer's copy of the producer index
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_{0};
+        size_t cachedTail_ = 0;
+        //! Producer index and the producer's copy of the consumer index
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_{0};
+        size_t cachedHead_ = 0;
+    };
+
+    /**
+     * @class MpmcRing
+     * @brief Bounded lock-free ring buffer for multiple producers and consumers
+     *
+     * Each cell carries a sequence number which tells producers and consumers
+     * whether the cell is free or occupied in the current lap (D. Vyukov's bounded
+     * MPMC queue). Popped elements are moved out.
+     */
+    template <typename T>
+    class MpmcRing
+    {
+    public:
+        /**
+         * @brief Constructor
+         * @param[in] capacity Minimum capacity, rounded up to a power of two
+         */
+        explicit MpmcRing(size_t capacity) :
+            capacity_(nextPowerOfTwo(capacity)), mask_(capacity_ - 1),
+            cells_(new Cell[capacity_])
+        {
+            for (size_t i = 0; i < capacity_; ++i)
+                cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] bool tryPush(T&& value)
+        {
+            Cell* cell;
+            size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                cell = &cells_[pos & mask_];
+                size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                intptr_t diff =
+                    static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+                if (diff == 0)
+                {
+                    if (enqueuePos_.compare_exchange_weak(
+                            pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                } else if (diff < 0)
+                    return false;
+                else
+                    pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+            cell->data = std::move(value);
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        [[nodiscard]] bool tryPop(T& value)
+        {
+            Cell* cell;
+            size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                cell = &cells_[pos & mask_];
+                size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(sequence) -
+                                static_cast<intptr_t>(pos + 1);
+                if (diff == 0)
+                {
+                    if (dequeuePos_.compare_exchange_weak(
+                            pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                } else if (diff < 0)
+                    return false;
+                else
+                    pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+            value = std::move(cell->data);
+            cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+            return true;
+        }
+
+        //! Approximate number of elements, may be called from any thread
+        [[nodiscard]] size_t size() const
+        {
+            size_t dequeuePos = dequeuePos_.load(std::memory_order_acquire);
+            size_t enqueuePos = enqueuePos_.load(std::memory_order_acquire);
+            return (enqueuePos >= dequeuePos) ? enqueuePos - dequeuePos : 0;
+        }
+
+        [[nodiscard]] size_t capacity() const { return capacity_; }
+
+    private:
+        struct Cell
+        {
+            std::atomic<size_t> sequence;
+            T data;
+        };
+
+        const size_t capacity_;
+        const size_t mask_;
+        std::unique_ptr<Cell[]> cells_;
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueuePos_{0};
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> dequeuePos_{0};
+    };
+} // namespace io
@@ -0,0 +1,153 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#pragma once
+
+// C++
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @file command_pipeline.hpp
+ * @date 17/10/26
+ * @brief Keeps several commands to the Rx in flight and correlates the responses
+ */
+
+namespace io {
+
+    //! Default number of commands sent to the Rx without waiting for responses
+    static const size_t DEFAULT_COMMAND_PIPELINE_DEPTH = 4;
+
+    /**
+     * @struct CommandFailure
+     * @brief Command the Rx rejected along with its response
+     */
+    struct CommandFailure
+    {
+        std::string command;
+        std::string response;
+    };
+
+    /**
+     * @class CommandPipeline
+     * @brief Window of commands which have been sent to the Rx but not answered yet
+     *
+     * A command is submitted right before it is sent and completed by the
+     * response of the Rx. It leaves the window with the prompt following the
+     * response, since the output lines of the command may still be on their way
+     * until then. submit() blocks while depth commands are in the window, so a
+     * depth of 1 sends one command per round trip. The Rx answers in order and
+     * echoes the command after "$R: ", thus a response completes the oldest
+     * unanswered command with the same text. Error responses only echo the full
+     * name of the command, they as well as responses without a matching command
+     * complete the oldest unanswered command.
+     */
+    class CommandPipeline
+    {
+    public:
+        explicit CommandPipeline(size_t depth = DEFAULT_COMMAND_PIPELINE_DEPTH);
+
+        //! Sets the number of commands that may be in flight, at least 1
+        void setDepth(size_t depth);
+
+        [[nodiscard]] size_t depth() const;
+
+        /**
+         * @brief Registers a command that is about to be sent
+         *
+         * Blocks while the window is full.
+         * @param[in] command Command as sent to the Rx
+         */
+        void submit(const std::string& command);
+
+        /**
+         * @brief Completes the command answered by a response
+         * @param[in] response Response of the Rx starting with "$R"
+         * @param[in] error Whether the Rx rejected the command
+         * @return The answered command, empty if no command was in flight
+         */
+        std::string complete(const std::string& response, bool error);
+
+        //! Removes the oldest answered command from the window at a prompt
+        void prompt();
+
+        /**
+         * @brief Fails a command that could not be sent, the Rx will not answer it
+         * @param[in] command Command as sent to the Rx
+         * @param[in] reason Description of the error, reported as its response
+         * @return Whether the command was in flight
+         */
+        bool fail(const std::string& command, const std::string& reason);
+
+        //! Blocks until all submitted commands are answered and prompted
+        void flush();
+
+        //! Gives up on all unanswered commands and releases waiting threads
+        void clear();
+
+        //! Returns the failed commands since the last call
+        [[nodiscard]] std::vector<CommandFailure> takeFailures();
+
+        //! Number of commands submitted so far
+        [[nodiscard]] uint64_t submitted() const;
+
+        /**
+         * @brief Extracts the command echoed by a response
+         * @param[in] response Response of the Rx, e.g. "$R: sso, all, none\r\n"
+         * @return Echoed text without leading and trailing white space
+         */
+        [[nodiscard]] static std::string echo(const std::string& response);
+
+        //! Strips the line ending and surrounding white space of a command
+        [[nodiscard]] static std::string normalize(const std::string& command);
+
+    private:
+        mutable std::mutex mutex_;
+        std::condition_variable answered_;
+        struct Command
+        {
+            //! Normalized command
+            std::string text;
+            bool answered = false;
+        };
+
+        //! Commands in the order they were sent
+        std::deque<Command> inFlight_;
+        size_t depth_;
+        //! Incremented by clear() to release waiting threads
+        uint64_t generation_ = 0;
+        uint64_t submitted_ = 0;
+        std::vector<CommandFailure> failures_;
+    };
+} // namespace io
@@ -67,6 +67,8 @@
 #include <sstream>
 // ROSaic includes
 #include <septentrio_gnss_driver/communication/async_manager.hpp>
+#include <septentrio_gnss_driver/communication/flight_recorder.hpp>
+#include <septentrio_gnss_driver/communication/rx_configuration.hpp>
 #include <septentrio_gnss_driver/communication/telegram_handler.hpp>
 
 /**
@@ -99,13 +101,23 @@ namespace io {
         /**
          * @brief Constructor of the class CommunicationCore
          * @param[in] node Pointer to node
+         * @param[in] ioPool I/O threads shared with other receivers, the owner has
+         * to stop them after close() and before destruction. If empty, the
+         * connections run on own threads created by connect().
          */
-        CommunicationCore(ROSaicNodeBase* node);
+        CommunicationCore(ROSaicNodeBase* node,
+                          std::shared_ptr<IoContextPool> ioPool = nullptr);
         /**
          * @brief Default destructor of the class CommunicationCore
          */
         ~CommunicationCore();
 
+        /**
+         * @brief Resets the Rx configuration and stops processing, called by the
+         * destructor if not called before
+         */
+        void close();
+
         /**
          * @brief Connects the data stream
          */
@@ -124,12 +136,30 @@ namespace io {
          */
         void sendVelocity(const std::string& velNmea);
 
+        /**
+         * @brief Publishes the statistics of the I/O layer as diagnostics
+         */
+        void publishIoDiagnostics();
+
+        /**
+         * @brief Dumps the recent telegrams of the flight recorder to a file
+         * @param[out] message Outcome of the request
+         * @return Whether a dump was scheduled
+         */
+        [[nodiscard]] bool dumpFlightRecorder(std::string& message);
+
     private:
         /**
          * @brief Resets Rx settings
          */
         void resetSettings();
 
+        /**
+         * @brief Sets up the telegram queue according to the settings, before any
+         * thread uses it
+         */
+        void configureQueue();
+
         /**
          * @brief Initializes the I/O handling
          * * @return Wether connection was successful
@@ -146,10 +176,52 @@ namespace io {
 
         /**
          * @brief Hands over to the send() method of manager_
+         *
+         * Blocks while io.command_pipeline_depth commands await a response.
          * @param cmd The command to hand over
          */
         void send(const std::string&);
 
+        /**
+         * @brief Waits until the Rx answered all commands sent and logs the ones
+         * it rejected or that could not be sent
+         * @return Number of failed commands
+         */
+        size_t flushCommands();
+
+        /**
+         * @brief Notes a stream set up with the given period in ms, keeps the
+         * shortest one as the expected data period
+         */
+        void expectDataPeriod(uint32_t period);
+
+        /**
+         * @brief Lets the connection carrying the data streams reconnect if no
+         * data arrives for reconnect.silence_periods expected data periods
+         */
+        void monitorSilence();
+
+        /**
+         * @brief Sends the recorded configuration commands, or only the ones that
+         * changed since the configuration was last applied to the Rx
+         * @return Number of rejected commands
+         */
+        size_t applyConfiguration();
+
+        /**
+         * @brief Identifies the Rx by the ReceiverSetup block
+         * @return Serial number, empty if the Rx did not respond
+         */
+        std::string rxSerialNumber();
+
+        /**
+         * @brief Reads the settings changed by a configuration back from the Rx
+         * @param[in] commands Commands of the configuration
+         * @return Lines output by the Rx
+         */
+        std::vector<std::string>
+        readBackConfiguration(const std::vector<std::string>& commands);
+
         //! Pointer to Node
         ROSaicNodeBase* node_;
         //! Settings
@@ -162,14 +234,31 @@ namespace io {
         std::thread processingThread_;
         //! Whether connecting was successful
         bool initializedIo_ = false;
+        //! Threads running the I/O of all connections
+        std::shared_ptr<IoContextPool> ioPool_;
+        //! Whether the I/O threads are stopped by close()
+        bool ownsIoPool_ = false;
+        //! Whether close() was called
+        bool closed_ = false;
+        //! Records the bytes received on the connections, outlives them
+        std::unique_ptr<RawRecorder> recorder_;
         //! Processes I/O stream data
         //! This declaration is deliberately stream-independent (Serial or TCP).
         std::unique_ptr<AsyncManagerBase> manager_;
 
         std::unique_ptr<AsyncManager<TcpIo>> tcpClient_;
         std::unique_ptr<UdpClient> udpClient_;
+        //! Keeps the recent telegrams, monitors the CRC failures of the connections
+        std::unique_ptr<FlightRecorder> flightRecorder_;
 
         bool nmeaActivated_ = false;
+        //! Shortest period in ms of the streams configured, 0 if none is periodic
+        uint32_t dataPeriod_ = 0;
+
+        //! Whether send() records configuration commands instead of sending them
+        bool recording_ = false;
+        //! Configuration commands recorded by send()
+        std::vector<std::string> recordedCommands_;
 
         //! Indicator for threads to run
         std::atomic<bool> running_;
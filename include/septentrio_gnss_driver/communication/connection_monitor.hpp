@@ -0,0 +1,181 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#pragma once
+
+// C++
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+/**
+ * @file connection_monitor.hpp
+ * @date 17/10/26
+ * @brief Backoff between reconnection attempts, detection and statistics of
+ * outages
+ */
+
+namespace io {
+
+    //! Lower bound of the time without data after which a connection is lost
+    static const uint32_t MIN_SILENCE_TIMEOUT_MS = 100;
+
+    /**
+     * @class ReconnectBackoff
+     * @brief Exponentially growing delays between reconnection attempts
+     *
+     * The delay doubles with each attempt up to a maximum. Each delay is randomly
+     * varied by up to the jitter fraction, so that several drivers do not retry in
+     * lockstep.
+     */
+    class ReconnectBackoff
+    {
+    public:
+        /**
+         * @param[in] initialDelay Delay before the first attempt in seconds
+         * @param[in] maxDelay Maximum delay in seconds
+         * @param[in] jitter Fraction of the delay by which it is varied, 0 to 1
+         */
+        ReconnectBackoff(double initialDelay, double maxDelay, double jitter);
+
+        //! Delay before the next attempt
+        [[nodiscard]] std::chrono::nanoseconds next();
+
+        //! Starts over with the initial delay
+        void reset();
+
+        //! Number of delays handed out since the last reset
+        [[nodiscard]] uint32_t attempts() const { return attempts_; }
+
+    private:
+        std::chrono::nanoseconds initial_;
+        std::chrono::nanoseconds max_;
+        std::chrono::nanoseconds current_;
+        double jitter_;
+        uint32_t attempts_ = 0;
+        std::minstd_rand random_;
+    };
+
+    /**
+     * @struct ConnectionStatistics
+     * @brief Outages of a connection, may be read from any thread
+     */
+    struct ConnectionStatistics
+    {
+        //! Number of detected connection losses
+        std::atomic<uint64_t> outages{0};
+        //! Number of reconnection attempts
+        std::atomic<uint64_t> reconnectAttempts{0};
+        //! Time from the last data to detecting the loss in nanoseconds
+        std::atomic<uint64_t> detectSumNs{0};
+        std::atomic<uint64_t> detectMaxNs{0};
+        //! Time from detecting the loss to data being received again
+        std::atomic<uint64_t> outageSumNs{0};
+        std::atomic<uint64_t> outageMaxNs{0};
+        //! Number of outages after which data was received again
+        std::atomic<uint64_t> resumed{0};
+        //! Time from reconnecting to data being received again
+        std::atomic<uint64_t> resumeSumNs{0};
+        std::atomic<uint64_t> resumeMaxNs{0};
+    };
+
+    /**
+     * @class ConnectionMonitor
+     * @brief Measures outages of a connection
+     *
+     * All methods but statistics() have to be called from the thread handling the
+     * connection.
+     */
+    class ConnectionMonitor
+    {
+    public:
+        /**
+         * @brief Marks the arrival of data
+         * @return Whether data resumed after an outage
+         */
+        bool dataReceived();
+
+        //! Marks the detection of a connection loss
+        void lost();
+
+        //! Marks an attempt to reconnect
+        void attempt();
+
+        //! Marks a successful reconnection
+        void reconnected();
+
+        //! Starts measuring the silence of the connection from now on
+        void watch();
+
+        /**
+         * @brief Time since data was received, the connection was reestablished
+         * or watch() was called, whichever is latest
+         */
+        [[nodiscard]] std::chrono::nanoseconds silence() const;
+
+        //! Duration of the last outage until data resumed in milliseconds
+        [[nodiscard]] uint64_t lastOutageMs() const
+        {
+            return lastOutageNs_ / 1000000;
+        }
+
+        [[nodiscard]] const ConnectionStatistics& statistics() const
+        {
+            return stats_;
+        }
+
+    private:
+        uint64_t lastDataNs_ = 0;
+        uint64_t lostNs_ = 0;
+        uint64_t reconnectedNs_ = 0;
+        uint64_t watchNs_ = 0;
+        uint64_t lastOutageNs_ = 0;
+        //! Whether the connection was lost and no data arrived since
+        bool down_ = false;
+        ConnectionStatistics stats_;
+    };
+
+    /**
+     * @brief Enables TCP keep-alive (SO_KEEPALIVE, TCP_KEEPIDLE, TCP_KEEPINTVL,
+     * TCP_KEEPCNT) and TCP_USER_TIMEOUT on a socket, so that the kernel fails
+     * reading from a connection whose peer vanished
+     * @param[in] fd Socket
+     * @param[in] idleS Idle time in seconds before the first probe
+     * @param[in] intervalS Interval in seconds between probes
+     * @param[in] count Number of unanswered probes after which the connection is
+     * lost
+     * @param[in] userTimeoutMs Time in milliseconds sent data may remain
+     * unacknowledged before the connection is lost
+     * @return Whether all options were set
+     */
+    [[nodiscard]] bool enableTcpKeepalive(int fd, uint32_t idleS, uint32_t intervalS,
+                                          uint32_t count, uint32_t userTimeoutMs);
+} // namespace io
@@ -0,0 +1,146 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#pragma once
+
+// C++
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <vector>
+
+// Linux
+#include <sys/socket.h>
+
+/**
+ * @file datagram_batch.hpp
+ * @date 17/10/26
+ * @brief Receives several datagrams per system call
+ */
+
+namespace io {
+
+    //! Default number of datagrams received per system call
+    static const size_t DEFAULT_UDP_BATCH_SIZE = 16;
+
+    /**
+     * @struct UdpStatistics
+     * @brief Counters of the UDP reception, may be read from any thread
+     */
+    struct UdpStatistics
+    {
+        //! Number of received datagrams
+        std::atomic<uint64_t> datagrams{0};
+        //! Number of system calls which returned datagrams
+        std::atomic<uint64_t> receiveCalls{0};
+        //! Datagrams dropped by the kernel because the socket buffer was full
+        std::atomic<uint64_t> kernelDrops{0};
+    };
+
+    /**
+     * @class DatagramBatch
+     * @brief Buffers for receiving a batch of datagrams with recvmmsg()
+     *
+     * Besides the payload, the sender address, the kernel receive timestamp
+     * (SO_TIMESTAMPNS) and the socket's drop counter (SO_RXQ_OVFL) of each datagram
+     * are retrieved if the options are enabled on the socket.
+     */
+    class DatagramBatch
+    {
+    public:
+        /**
+         * @brief Constructor
+         * @param[in] count Maximum number of datagrams per batch
+         * @param[in] datagramSize Maximum size of a datagram
+         */
+        DatagramBatch(size_t count, size_t datagramSize);
+
+        /**
+         * @brief Receives the datagrams which are available without blocking
+         * @param[in] fd Socket
+         * @return Number of datagrams, -1 on error with errno set
+         */
+        int receive(int fd);
+
+        [[nodiscard]] size_t capacity() const { return headers_.size(); }
+        [[nodiscard]] const uint8_t* data(size_t i) const
+        {
+            return &buffer_[i * datagramSize_];
+        }
+        [[nodiscard]] size_t size(size_t i) const { return headers_[i].msg_len; }
+        [[nodiscard]] const sockaddr_storage& sender(size_t i) const
+        {
+            return senders_[i];
+        }
+        [[nodiscard]] socklen_t senderLength(size_t i) const
+        {
+            return headers_[i].msg_hdr.msg_namelen;
+        }
+        /**
+         * @brief Kernel receive timestamp of a datagram
+         * @return Timestamp of CLOCK_REALTIME, zero if none was delivered
+         */
+        [[nodiscard]] const timespec& stamp(size_t i) const { return stamps_[i]; }
+        /**
+         * @brief Drop counter of the socket when the datagram was received
+         * @param[in] i Datagram
+         * @param[out] drops Number of datagrams dropped since the socket was opened
+         * @return Whether the counter was delivered
+         */
+        [[nodiscard]] bool drops(size_t i, uint32_t& drops) const;
+
+    private:
+        const size_t datagramSize_;
+        std::vector<uint8_t> buffer_;
+        std::vector<mmsghdr> headers_;
+        std::vector<iovec> iovecs_;
+        std::vector<sockaddr_storage> senders_;
+        std::vector<timespec> stamps_;
+        std::vector<uint32_t> drops_;
+        std::vector<bool> hasDrops_;
+        //! Control messages of the datagrams
+        std::vector<uint8_t> control_;
+    };
+
+    /**
+     * @brief Sets the size of a socket's receive buffer
+     * @param[in] fd Socket
+     * @param[in] size Requested size in bytes
+     * @return Size the kernel granted in bytes, 0 on error
+     */
+    [[nodiscard]] size_t setReceiveBufferSize(int fd, size_t size);
+
+    /**
+     * @brief Enables the drop counter (SO_RXQ_OVFL) on a socket
+     * @param[in] fd Socket
+     * @return Whether the option was set
+     */
+    [[nodiscard]] bool enableDropCounter(int fd);
+} // namespace io
@@ -0,0 +1,198 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#pragma once
+
+// C++
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ROSaic
+#include <septentrio_gnss_driver/communication/telegram.hpp>
+
+/**
+ * @file flight_recorder.hpp
+ * @date 17/10/26
+ * @brief Ring of the most recent telegrams, dumped to an SBF file on anomalies
+ */
+
+namespace io {
+
+    //! Interval at which the CRC failure rate is checked
+    static const std::chrono::milliseconds FLIGHT_RECORDER_CHECK_INTERVAL{1000};
+
+    /**
+     * @struct FlightRecorderStatistics
+     * @brief Statistics of a flight recorder, may be read from any thread
+     */
+    struct FlightRecorderStatistics
+    {
+        //! Number of triggers, including those merged into a pending dump
+        std::atomic<uint64_t> triggers{0};
+        std::atomic<uint64_t> dumps{0};
+        std::atomic<uint64_t> failedDumps{0};
+        //! Number of telegrams too large for the ring
+        std::atomic<uint64_t> skippedTelegrams{0};
+    };
+
+    /**
+     * @class FlightRecorder
+     * @brief Keeps the telegrams of the last seconds in memory and writes them to
+     * an SBF file when an anomaly is detected or a dump is requested
+     *
+     * The telegrams are copied by the processing thread into a preallocated ring
+     * of flight_recorder.size MB, overwriting the oldest ones. A dump holds the
+     * telegrams received within flight_recorder.duration seconds before it is
+     * written, which is flight_recorder.post_trigger seconds after the trigger so
+     * that the aftermath is included. Triggers arriving in the meantime are merged
+     * into the pending dump. Anomalies are detected on the transition into the
+     * anomalous state, i.e. a persisting anomaly triggers only once:
+     *  - crc_storm: at least flight_recorder.crc_storm CRC failures within a second
+     *  - pvt_mode_drop: PVT mode of PVTGeodetic or PVTCartesian worse than before,
+     *    e.g. RTK fixed to RTK float or standalone
+     *  - ins_error: Error field of INSNavGeod or INSNavCart becoming non-zero
+     */
+    class FlightRecorder
+    {
+    public:
+        //! Total number of CRC failures of all connections
+        typedef std::function<uint64_t()> CrcFailureCounter;
+
+        /**
+         * @brief Constructor, allocates the ring and starts the thread writing the
+         * dumps
+         * @param[in] node Pointer to node, the settings flight_recorder.* apply
+         */
+        explicit FlightRecorder(ROSaicNodeBase* node);
+
+        //! Writes a pending dump and stops the thread
+        ~FlightRecorder();
+
+        /**
+         * @brief Starts monitoring the CRC failures for the trigger crc_storm
+         * @param[in] crcFailures Counts the CRC failures, called by the thread
+         */
+        void monitorCrcFailures(CrcFailureCounter crcFailures);
+
+        /**
+         * @brief Copies a telegram into the ring and checks it for anomalies, only
+         * called by the processing thread
+         * @param[in] telegram Telegram with its receive timestamp
+         */
+        void add(const Telegram& telegram);
+
+        /**
+         * @brief Requests a dump, may be called from any thread
+         * @param[in] reason Reason of the dump, part of the file name
+         * @param[in] delay Time until the dump is written
+         * @return Whether a new dump was scheduled, false if the trigger was merged
+         * into a pending dump or the recorder is not running
+         */
+        bool trigger(const std::string& reason, std::chrono::nanoseconds delay);
+
+        //! Writes a pending dump and stops the thread, no dumps are scheduled
+        //! afterwards
+        void close();
+
+        [[nodiscard]] const FlightRecorderStatistics& statistics() const
+        {
+            return stats_;
+        }
+
+    private:
+        //! Location of a telegram in the ring
+        struct Entry
+        {
+            size_t offset;
+            size_t size;
+            Timestamp stamp;
+        };
+
+        void run();
+        //! Detects PVT mode drops and INS errors
+        void checkBlock(const std::vector<uint8_t>& message);
+        //! Copies the telegrams of the dump, called with the mutex locked
+        void snapshot();
+        //! Writes the copied telegrams to a file, only called by the thread
+        void writeDump(const std::string& reason);
+        //! Detects a CRC storm, only called by the thread
+        void checkCrcFailures();
+
+        //! Pointer to the node
+        ROSaicNodeBase* node_;
+        const Settings* settings_;
+        bool triggerCrcStorm_ = false;
+        bool triggerPvtModeDrop_ = false;
+        bool triggerInsError_ = false;
+
+        //! Guards the ring and the state of the pending dump
+        std::mutex mutex_;
+        std::condition_variable changed_;
+        std::vector<uint8_t> ring_;
+        //! Position in the ring the next telegram is written to
+        size_t writePos_ = 0;
+        //! Telegrams in the ring, a circular buffer starting with the oldest
+        std::vector<Entry> entries_;
+        size_t firstEntry_ = 0;
+        size_t entryCount_ = 0;
+
+        bool pending_ = false;
+        std::string pendingReason_;
+        std::chrono::steady_clock::time_point dumpAt_;
+        bool closing_ = false;
+        //! Telegrams of the dump being written, preallocated
+        std::vector<uint8_t> snapshot_;
+        size_t snapshotTelegrams_ = 0;
+        //! Number of dumps written, part of the file names
+        uint32_t dumpCount_ = 0;
+
+        //! Quality rank of the last PVT mode, only used by the processing thread
+        int pvtRank_ = -1;
+        //! Whether the last INS block reported an error, only used by the
+        //! processing thread
+        bool insError_ = false;
+        //! CRC failures at the last check, only used by the thread
+        uint64_t lastCrcFailures_ = 0;
+        bool crcCounted_ = false;
+        bool crcStorm_ = false;
+
+        //! Monitored by the thread, guarded by the mutex
+        CrcFailureCounter crcFailures_;
+        std::thread thread_;
+        FlightRecorderStatistics stats_;
+    };
+} // namespace io
@@ -31,11 +31,20 @@
 #pragma once
 
 // C++
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <mutex>
 #include <thread>
 
 // Linux
 #include <linux/input.h>
 #include <linux/serial.h>
+#include <poll.h>
 
 // Boost
 #include <boost/asio.hpp>
@@ -45,7 +54,18 @@
 
 // ROSaic
 #include <septentrio_gnss_driver/abstraction/typedefs.hpp>
-#include <septentrio_gnss_driver/communication/telegram.hpp>
+#include <septentrio_gnss_driver/communication/connection_monitor.hpp>
+#include <septentrio_gnss_driver/communication/datagram_batch.hpp>
+#include <septentrio_gnss_driver/communication/io_context_pool.hpp>
+#include <septentrio_gnss_driver/communication/io_diagnostics.hpp>
+#include <septentrio_gnss_driver/communication/mapped_file.hpp>
+#include <septentrio_gnss_driver/communication/pcap_decoder.hpp>
+#include <septentrio_gnss_driver/communication/receive_clock.hpp>
+#include <septentrio_gnss_driver/communication/sbf_index.hpp>
+#include <septentrio_gnss_driver/communication/sync_scanner.hpp>
+#include <septentrio_gnss_driver/communication/telegram_framer.hpp>
+#include <septentrio_gnss_driver/communication/telegram_pool.hpp>
+#include <septentrio_gnss_driver/communication/telegram_queue.hpp>
 
 //! Possible baudrates for the Rx
 const static std::array<uint32_t, 21> baudrates = {
@@ -55,199 +75,392 @@ const static std::array<uint32_t, 21> baudrates = {
 
 namespace io {
 
+    //! Baudrate of the COM ports of the Rx in factory state
+    static const uint32_t DEFAULT_SERIAL_BAUDRATE = 115200;
+    //! Time the Rx is given to respond when probing a serial connection
+    static const int SERIAL_PROBE_TIMEOUT_MS = 300;
+
+    //! Maximum number of UDP senders whose streams are reassembled
+    static const size_t MAX_UDP_SOURCES = 8;
+
     class UdpClient
     {
     public:
-        UdpClient(ROSaicNodeBase* node, int16_t port, TelegramQueue* telegramQueue) :
-            node_(node), running_(true), port_(port), telegramQueue_(telegramQueue)
+        /**
+         * @brief Class constructor, starts listening
+         * @param[in] node Pointer to node
+         * @param[in] port UDP port
+         * @param[in] telegramQueue Telegram queue
+         * @param[in] ioPool Runs the I/O, has to be stopped before destruction
+         * @param[in] recorder Records the received datagrams if set, has to
+         * outlive the I/O
+         */
+        UdpClient(ROSaicNodeBase* node, int16_t port, TelegramQueue* telegramQueue,
+                  IoContextPool* ioPool, RecordChannel* recorder = nullptr) :
+            node_(node), running_(true), port_(port), recorder_(recorder),
+            strand_(ioPool->makeStrand()),
+            batch_(std::max<uint32_t>(node->settings()->udp_batch_size, 1),
+                   MAX_UDP_PACKET_SIZE),
+            telegramQueue_(telegramQueue),
+            telegramPool_(node->settings()->telegram_pool_size), clock_(node),
+            reconnectTimer_(strand_),
+            backoff_(node->settings()->reconnect_delay_s,
+                     node->settings()->reconnect_max_delay_s,
+                     node->settings()->reconnect_jitter)
         {
-            connect();
-            watchdogThread_ =
-                std::thread(boost::bind(&UdpClient::runWatchdog, this));
+            boost::asio::post(strand_, [this]() {
+                if (!connect())
+                    scheduleReconnect();
+            });
         }
 
         ~UdpClient()
         {
             running_ = false;
+            node_->log(log_level::INFO, "UDP client stopped");
+        }
 
-            node_->log(log_level::INFO, "UDP client shutting down threads");
-            ioService_.stop();
-            ioThread_.join();
-            watchdogThread_.join();
-            node_->log(log_level::INFO, " UDP client threads stopped");
+        /**
+         * @brief Appends the I/O statistics to a diagnostic status
+         * @param[in] prefix Prefix of the keys
+         * @param[in,out] status Diagnostic status
+         */
+        void appendDiagnostics(const std::string& prefix,
+                               DiagnosticStatusMsg& status) const
+        {
+            addDiagnosticValues(status, prefix, stats_);
+            {
+                FramerStatistics total;
+                size_t senders = 0;
+                std::lock_guard<std::mutex> lock(sourcesMutex_);
+                for (const Source& source : sources_)
+                {
+                    if (!source.framer)
+                        continue;
+                    ++senders;
+                    const FramerStatistics& stats = source.framer->statistics();
+                    total.bytes += stats.bytes;
+                    total.telegrams += stats.telegrams;
+                    total.reassembled += stats.reassembled;
+                    total.crcFailures += stats.crcFailures;
+                    total.discardedBytes += stats.discardedBytes;
+                    total.droppedFrames += stats.droppedFrames;
+                }
+                addDiagnosticValue(status, prefix + "UDP senders", senders);
+                addDiagnosticValues(status, prefix, total);
+            }
+            addDiagnosticValues(status, prefix, monitor_.statistics());
+            addDiagnosticValues(status, prefix, telegramPool_.statistics());
+            if (node_->settings()->kernel_timestamps)
+                addDiagnosticValues(status, prefix, clock_.statistics());
+        }
+
+        //! Number of telegrams of all senders discarded due to a wrong CRC
+        [[nodiscard]] uint64_t crcFailures() const
+        {
+            uint64_t failures = 0;
+            std::lock_guard<std::mutex> lock(sourcesMutex_);
+            for (const Source& source : sources_)
+            {
+                if (source.framer)
+                    failures += source.framer->statistics().crcFailures;
+            }
+            return failures;
         }
 
     private:
-        void connect()
+        //! Opens the socket and starts receiving, runs on the I/O thread
+        [[nodiscard]] bool connect()
         {
-            socket_.reset(new boost::asio::ip::udp::socket(
-                ioService_,
-                boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), port_)));
+            try
+            {
+                socket_.reset(new boost::asio::ip::udp::socket(
+                    strand_, boost::asio::ip::udp::endpoint(
+                                 boost::asio::ip::udp::v4(), port_)));
+            } catch (const boost::system::system_error& err)
+            {
+                node_->log(log_level::ERROR, "UDP client could not listen on port " +
+                                                 std::to_string(port_) + ": " +
+                                                 err.what());
+                return false;
+            }
+            int fd = socket_->native_handle();
+            if (node_->settings()->kernel_timestamps && !enableKernelTimestamps(fd))
+                node_->log(log_level::WARN,
+                           "Kernel receive timestamps are not supported.");
+            socketDrops_ = 0;
+            if (!enableDropCounter(fd))
+                node_->log(log_level::WARN, "UDP client cannot count datagrams "
+                                            "dropped by the kernel.");
+            uint32_t bufferSize = node_->settings()->udp_receive_buffer_size;
+            if (bufferSize > 0)
+            {
+                size_t granted = setReceiveBufferSize(fd, bufferSize);
+                if (granted < bufferSize)
+                    node_->log(log_level::WARN,
+                               "UDP receive buffer of " + std::to_string(granted) +
+                                   " bytes instead of " +
+                                   std::to_string(bufferSize) +
+                                   ", raise net.core.rmem_max.");
+                else
+                    node_->log(log_level::DEBUG, "UDP receive buffer of " +
+                                                     std::to_string(granted) +
+                                                     " bytes.");
+            }
 
             asyncReceive();
 
-            ioThread_ = std::thread(boost::bind(&UdpClient::runIoService, this));
-
             node_->log(log_level::INFO,
                        "Listening on UDP port " + std::to_string(port_));
+            return true;
+        }
+
+        //! Reopens the socket after the next backoff delay
+        void scheduleReconnect()
+        {
+            reconnectTimer_.expires_after(backoff_.next());
+            reconnectTimer_.async_wait([this](const boost::system::error_code& ec) {
+                if (ec || !running_)
+                    return;
+
+                monitor_.attempt();
+                // Only opens and binds a socket, hence does not block the strand
+                if (connect())
+                    monitor_.reconnected();
+                else
+                    scheduleReconnect();
+            });
         }
 
         void asyncReceive()
 
         {
-            socket_->async_receive_from(
-                boost::asio::buffer(buffer_, MAX_UDP_PACKET_SIZE), eP_,
-                boost::bind(&UdpClient::handleReceive, this,
-                            boost::asio::placeholders::error,
-                            boost::asio::placeholders::bytes_transferred));
+            socket_->async_wait(boost::asio::ip::udp::socket::wait_read,
+                                boost::bind(&UdpClient::handleReceive, this,
+                                            boost::asio::placeholders::error));
         }
 
-        void handleReceive(const boost::system::error_code& error,
-                           size_t bytes_recvd)
+        void handleReceive(const boost::system::error_code& error)
         {
-            Timestamp stamp = node_->getTime();
-            size_t idx = 0;
-
-            if (!error && (bytes_recvd > 0))
+            if (!error)
             {
-                while ((bytes_recvd - idx) > 2)
+                // Drains the socket in batches, a batch which is not full
+                // means that the socket is empty
+                int count;
+                do
                 {
-                    std::shared_ptr<Telegram> telegram(new Telegram);
-                    telegram->stamp = stamp;
-                    /*node_->log(log_level::DEBUG,
-                               "Buffer: " + std::string(telegram->message.begin(),
-                                                        telegram->message.end()));*/
-                    if (buffer_[idx] == SYNC_BYTE_1)
+                    count = batch_.receive(socket_->native_handle());
+                    if (count < 0)
                     {
-                        if (buffer_[idx + 1] == SBF_SYNC_BYTE_2)
-                        {
-                            if ((bytes_recvd - idx) > SBF_HEADER_SIZE)
-                            {
-                                uint16_t length = parsing_utilities::parseUInt16(
-                                    &buffer_[idx + 6]);
-                                telegram->message.assign(&buffer_[idx],
-                                                         &buffer_[idx + length]);
-                                if (crc::isValid(telegram->message))
-                                {
-                                    telegram->type = telegram_type::SBF;
-                                    telegramQueue_->push(telegram);
-                                } else
-                                    node_->log(
-                                        log_level::DEBUG,
-                                        "AsyncManager crc failed for SBF  " +
-                                            std::to_string(parsing_utilities::getId(
-                                                telegram->message)) +
-                                            ".");
-
-                                idx += length;
-                            }
+                        if ((errno != EAGAIN) && (errno != EWOULDBLOCK) &&
+                            (errno != EINTR))
+                            node_->log(log_level::ERROR,
+                                       "UDP client receive error: " +
+                                           std::string(std::strerror(errno)));
+                        break;
+                    }
+                    ++stats_.receiveCalls;
+                    stats_.datagrams += count;
 
-                        } else if ((buffer_[idx + 1] == NMEA_SYNC_BYTE_2) &&
-                                   (buffer_[idx + 2] == NMEA_SYNC_BYTE_3))
-                        {
-                            size_t idx_end = findNmeaEnd(idx, bytes_recvd);
-                            telegram->message.assign(&buffer_[idx],
-                                                     &buffer_[idx_end + 1]);
-                            telegram->type = telegram_type::NMEA;
-                            telegramQueue_->push(telegram);
-                            idx = idx_end + 1;
-
-                        } else if ((buffer_[idx + 1] == NMEA_INS_SYNC_BYTE_2) &&
-                                   (buffer_[idx + 2] == NMEA_INS_SYNC_BYTE_3))
-                        {
-                            size_t idx_end = findNmeaEnd(idx, bytes_recvd);
-                            telegram->message.assign(&buffer_[idx],
-                                                     &buffer_[idx_end + 1]);
-                            telegram->type = telegram_type::NMEA_INS;
-                            telegramQueue_->push(telegram);
-                            idx = idx_end + 1;
-                        } else
-                        {
-                            node_->log(log_level::DEBUG,
-                                       "head: " +
-                                           std::string(std::string(
-                                               telegram->message.begin(),
-                                               telegram->message.begin() + 2)));
-                        }
-                    } else
+                    Timestamp stamp = clock_.now();
+                    if ((count > 0) && monitor_.dataReceived())
                     {
-                        node_->log(log_level::DEBUG, "UDP msg resync.");
-                        ++idx;
+                        backoff_.reset();
+                        node_->log(log_level::INFO,
+                                   "UDP client: data resumed after an outage of " +
+                                       std::to_string(monitor_.lastOutageMs()) +
+                                       " ms.");
                     }
-                }
+                    // Datagrams of a paused sender are buffered by its framer
+                    for (int i = 0; i < count; ++i)
+                        handleDatagram(i, stamp);
+                } while ((static_cast<size_t>(count) == batch_.capacity()) &&
+                         !paused());
+                // Continued by resume() once the telegram queue drained
+                if (paused())
+                    return;
+            } else if (error == boost::asio::error::operation_aborted)
+            {
+                return;
             } else
             {
-                node_->log(log_level::ERROR,
-                           "UDP client receive error: " + error.message());
+                if (!running_)
+                    return;
+                node_->log(log_level::ERROR, "UDP client receive error: " +
+                                                 error.message() +
+                                                 ". Reopening the socket.");
+                monitor_.lost();
+                boost::system::error_code ec;
+                socket_->close(ec);
+                scheduleReconnect();
+                return;
             }
 
             asyncReceive();
         }
 
-        void runIoService()
+        //! Whether the framer of a sender waits for the telegram queue to drain
+        [[nodiscard]] bool paused() const
+        {
+            for (const Source& source : sources_)
+            {
+                if (source.framer && source.framer->paused())
+                    return true;
+            }
+            return false;
+        }
+
+        /**
+         * @brief Continues receiving once no framer is paused anymore
+         * @param[in] framer Framer that paused
+         * @param[in] pause Pause which may end
+         */
+        void resume(TelegramFramer* framer, uint64_t pause)
         {
-            ioService_.run();
-            node_->log(log_level::INFO, "UDP client ioService terminated.");
+            if (running_ && framer->resume(pause) && !paused())
+                asyncReceive();
         }
 
-        void runWatchdog()
+        /**
+         * @brief Counts drops and splits a received datagram
+         * @param[in] i Datagram of the batch
+         * @param[in] stamp Time the batch was received
+         */
+        void handleDatagram(size_t i, Timestamp stamp)
         {
-            while (running_)
+            uint32_t drops;
+            if (batch_.drops(i, drops) && (drops != socketDrops_))
             {
-                std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+                uint32_t newDrops = drops - socketDrops_;
+                socketDrops_ = drops;
+                stats_.kernelDrops += newDrops;
+                node_->log(log_level::WARN,
+                           "UDP client: kernel dropped " + std::to_string(newDrops) +
+                               " datagram(s), consider increasing "
+                               "stream_device.udp.receive_buffer_size.");
+            }
 
-                if (running_ && ioService_.stopped())
-                {
-                    node_->log(log_level::ERROR,
-                               "UDP client connection lost. Trying to reconnect.");
-                    ioService_.reset();
-                    ioThread_.join();
-                    connect();
-                }
+            const timespec& kernelStamp = batch_.stamp(i);
+            if (kernelStamp.tv_sec != 0)
+            {
+                Timestamp kernel = clock_.fromKernel(kernelStamp);
+                clock_.recordKernelDelay(kernel, stamp);
+                stamp = kernel;
             }
+            framerOf(i).feed(batch_.data(i), batch_.size(i), stamp);
         }
 
-    private:
-        size_t findNmeaEnd(size_t idx, size_t bytes_recvd)
+        /**
+         * @brief Framer of the sender of a datagram
+         *
+         * Each sender has its own framer so that telegrams split across datagrams
+         * are reassembled. If more than MAX_UDP_SOURCES senders are active, the
+         * least recently used framer is taken over.
+         * @param[in] i Datagram of the batch
+         * @return Framer
+         */
+        TelegramFramer& framerOf(size_t i)
         {
-            size_t idx_end = idx + 2;
+            const sockaddr_storage& address = batch_.sender(i);
+            socklen_t addressLength = batch_.senderLength(i);
+            ++useCount_;
 
-            while (idx_end < bytes_recvd)
+            Source* lru = &sources_[0];
+            for (Source& source : sources_)
             {
-                if ((buffer_[idx_end] == LF) && (buffer_[idx_end - 1] == CR))
-                    break;
+                if (source.framer && (source.addressLength == addressLength) &&
+                    (std::memcmp(&source.address, &address, addressLength) == 0))
+                {
+                    source.lastUse = useCount_;
+                    return *source.framer;
+                }
+                if (source.lastUse < lru->lastUse)
+                    lru = &source;
+            }
 
-                ++idx_end;
+            if (lru->framer)
+            {
+                node_->log(log_level::DEBUG,
+                           "UDP client: more than " +
+                               std::to_string(MAX_UDP_SOURCES) +
+                               " senders, dropping the least recently used one.");
+                lru->framer->reset();
+            } else
+            {
+                std::lock_guard<std::mutex> lock(sourcesMutex_);
+                lru->framer =
+                    std::make_unique<TelegramFramer>(telegramQueue_, &telegramPool_);
+                lru->framer->setRecorder(recorder_);
+                TelegramFramer* framer = lru->framer.get();
+                lru->framer->setResumeHandler([this, framer](uint64_t pause) {
+                    boost::asio::post(strand_, [this, framer, pause]() {
+                        resume(framer, pause);
+                    });
+                });
             }
-            return idx_end;
+            lru->address = address;
+            lru->addressLength = addressLength;
+            lru->lastUse = useCount_;
+            return *lru->framer;
         }
+
+    private:
         //! Pointer to the node
         ROSaicNodeBase* node_;
         std::atomic<bool> running_;
         int16_t port_;
-        boost::asio::io_service ioService_;
-        std::thread ioThread_;
-        std::thread watchdogThread_;
-        boost::asio::ip::udp::endpoint eP_;
+        //! Records the datagrams of all senders if set
+        RecordChannel* recorder_;
+        //! Runs the handlers of the socket and the timer
+        IoExecutor strand_;
         std::unique_ptr<boost::asio::ip::udp::socket> socket_;
-        std::array<uint8_t, MAX_UDP_PACKET_SIZE> buffer_;
+        //! Buffers for receiving datagrams
+        DatagramBatch batch_;
+        //! Drop counter of the socket at the last datagram
+        uint32_t socketDrops_ = 0;
+        //! Stream of one sender
+        struct Source
+        {
+            sockaddr_storage address;
+            socklen_t addressLength = 0;
+            uint64_t lastUse = 0;
+            std::unique_ptr<TelegramFramer> framer;
+        };
+        std::array<Source, MAX_UDP_SOURCES> sources_;
+        uint64_t useCount_ = 0;
+        //! Guards creation of framers against reading their statistics
+        mutable std::mutex sourcesMutex_;
+        UdpStatistics stats_;
         TelegramQueue* telegramQueue_;
+        //! Pool of telegrams
+        TelegramPool telegramPool_;
+        //! Clock for arrival timestamps
+        ReceiveClock clock_;
+        boost::asio::steady_timer reconnectTimer_;
+        ReconnectBackoff backoff_;
+        ConnectionMonitor monitor_;
     };
 
     class TcpIo
     {
     public:
-        TcpIo(ROSaicNodeBase* node,
-              std::shared_ptr<boost::asio::io_service> ioService) :
-            node_(node),
-            ioService_(ioService)
+        TcpIo(ROSaicNodeBase* node, const IoExecutor& executor) :
+            node_(node), executor_(executor)
         {
             port_ = node_->settings()->device_tcp_port;
         }
 
-        ~TcpIo() { stream_->close(); }
+        ~TcpIo() { close(); }
 
-        void close() { stream_->close(); }
+        void close()
+        {
+            // The socket only exists after the first connection attempt
+            if (stream_)
+            {
+                boost::system::error_code ec;
+                stream_->close(ec);
+            }
+        }
 
         void setPort(const std::string& port) { port_ = port; }
 
@@ -257,7 +470,7 @@ namespace io {
 
             try
             {
-                boost::asio::ip::tcp::resolver resolver(*ioService_);
+                boost::asio::ip::tcp::resolver resolver(executor_);
                 boost::asio::ip::tcp::resolver::query query(
                     node_->settings()->device_tcp_ip, port_);
                 endpointIterator = resolver.resolve(query);
@@ -269,7 +482,7 @@ namespace io {
                 return false;
             }
 
-            stream_.reset(new boost::asio::ip::tcp::socket(*ioService_));
+            stream_.reset(new boost::asio::ip::tcp::socket(executor_));
 
             node_->log(log_level::INFO, "Connecting to tcp://" +
                                             node_->settings()->device_tcp_ip + ":" +
@@ -278,8 +491,7 @@ namespace io {
             try
             {
                 stream_->connect(*endpointIterator);
-
-                stream_->set_option(boost::asio::ip::tcp::no_delay(true));
+                configureStream();
 
                 node_->log(log_level::INFO,
                            "Connected to " + endpointIterator->host_name() + ":" +
@@ -295,9 +507,93 @@ namespace io {
             return true;
         }
 
+        /**
+         * @brief Resolves and connects without blocking the strand, e.g. while
+         * the SYN of an unreachable Rx times out
+         * @param[in] handler Called on the strand with whether the connection was
+         * established
+         */
+        void asyncConnect(std::function<void(bool)> handler)
+        {
+            resolver_.reset(new boost::asio::ip::tcp::resolver(executor_));
+            resolver_->async_resolve(
+                node_->settings()->device_tcp_ip, port_,
+                [this, handler](
+                    const boost::system::error_code& ec,
+                    const boost::asio::ip::tcp::resolver::results_type& endpoints) {
+                    if (ec)
+                    {
+                        node_->log(log_level::ERROR,
+                                   "Could not resolve " +
+                                       node_->settings()->device_tcp_ip +
+                                       " on port " + port_ + ": " + ec.message());
+                        handler(false);
+                        return;
+                    }
+
+                    stream_.reset(new boost::asio::ip::tcp::socket(executor_));
+                    node_->log(log_level::INFO,
+                               "Connecting to tcp://" +
+                                   node_->settings()->device_tcp_ip + ":" + port_ +
+                                   "...");
+                    boost::asio::async_connect(
+                        *stream_, endpoints,
+                        [this, handler](const boost::system::error_code& ec,
+                                        const boost::asio::ip::tcp::endpoint&
+                                            endpoint) {
+                            if (ec)
+                            {
+                                node_->log(log_level::ERROR,
+                                           "Could not connect to " +
+                                               node_->settings()->device_tcp_ip +
+                                               ": " + port_ + ": " + ec.message());
+                                handler(false);
+                                return;
+                            }
+                            try
+                            {
+                                configureStream();
+                            } catch (const boost::system::system_error& e)
+                            {
+                                node_->log(log_level::ERROR,
+                                           "Could not configure connection to " +
+                                               node_->settings()->device_tcp_ip +
+                                               ": " + e.what());
+                                handler(false);
+                                return;
+                            }
+                            node_->log(log_level::INFO,
+                                       "Connected to " +
+                                           endpoint.address().to_string() + ":" +
+                                           std::to_string(endpoint.port()) + ".");
+                            handler(true);
+                        });
+                });
+        }
+
     private:
+        //! Sets the socket options of an established connection
+        void configureStream()
+        {
+            stream_->set_option(boost::asio::ip::tcp::no_delay(true));
+            const Settings* settings = node_->settings();
+            if (settings->tcp_keepalive &&
+                !enableTcpKeepalive(stream_->native_handle(),
+                                    settings->tcp_keepalive_idle_s,
+                                    settings->tcp_keepalive_interval_s,
+                                    settings->tcp_keepalive_count,
+                                    settings->tcp_user_timeout_ms))
+                node_->log(log_level::WARN, "TCP keep-alive could not be enabled.");
+            if (node_->settings()->kernel_timestamps &&
+                !enableKernelTimestamps(stream_->native_handle()))
+                node_->log(log_level::WARN,
+                           "Kernel receive timestamps are not supported.");
+        }
+
         ROSaicNodeBase* node_;
-        std::shared_ptr<boost::asio::io_service> ioService_;
+        IoExecutor executor_;
+        //! Resolver of asynchronous connection attempts
+        std::unique_ptr<boost::asio::ip::tcp::resolver> resolver_;
 
         std::string port_;
 
@@ -308,19 +604,41 @@ namespace io {
     class SerialIo
     {
     public:
-        SerialIo(ROSaicNodeBase* node,
-                 std::shared_ptr<boost::asio::io_service> ioService) :
-            node_(node),
-            ioService_(ioService), flowcontrol_(node->settings()->hw_flow_control),
+        SerialIo(ROSaicNodeBase* node, const IoExecutor& executor) :
+            node_(node), executor_(executor),
+            flowcontrol_(node->settings()->hw_flow_control),
             baudrate_(node->settings()->baudrate)
         {
-            stream_.reset(new boost::asio::serial_port(*ioService_));
+            stream_.reset(new boost::asio::serial_port(executor_));
         }
 
-        ~SerialIo() { stream_->close(); }
+        ~SerialIo()
+        {
+            if (bringup_.joinable())
+                bringup_.join();
+            stream_->close();
+        }
 
         void close() { stream_->close(); }
 
+        /**
+         * @brief Brings the connection up on a thread of its own, since probing
+         * the Rx and walking the baudrate block for up to seconds
+         * @param[in] handler Posted to the strand with whether the connection was
+         * established, the stream must not be used by the strand until then
+         */
+        void asyncConnect(std::function<void(bool)> handler)
+        {
+            // The previous bring-up posted its result already
+            if (bringup_.joinable())
+                bringup_.join();
+            bringup_ = std::thread([this, handler]() {
+                bool connected = connect();
+                boost::asio::post(executor_,
+                                  [handler, connected]() { handler(connected); });
+            });
+        }
+
         [[nodiscard]] bool connect()
         {
             if (stream_->is_open())
@@ -328,30 +646,26 @@ namespace io {
                 stream_->close();
             }
 
-            bool opened = false;
+            auto start = std::chrono::steady_clock::now();
+            bool fastBringup = node_->settings()->serial_fast_bringup;
 
-            while (!opened)
+            // A failed open is retried by the caller with a backoff, e.g. while
+            // a USB device is being enumerated
+            try
             {
-                try
-                {
-                    node_->log(log_level::INFO,
-                               "Connecting serially to device " +
-                                   node_->settings()->device +
-                                   ", targeted baudrate: " +
-                                   std::to_string(node_->settings()->baudrate));
-                    stream_->open(node_->settings()->device);
-                    opened = true;
-                } catch (const boost::system::system_error& err)
-                {
-                    node_->log(log_level::ERROR, "Could not open serial port " +
-                                                     node_->settings()->device +
-                                                     ". Error: " + err.what() +
-                                                     ". Will retry every second.");
-
-                    using namespace std::chrono_literals;
-                    std::this_thread::sleep_for(1s);
-                }
+                node_->log(log_level::INFO,
+                           "Connecting serially to device " +
+                               node_->settings()->device + ", targeted baudrate: " +
+                               std::to_string(node_->settings()->baudrate));
+                stream_->open(node_->settings()->device);
+            } catch (const boost::system::system_error& err)
+            {
+                node_->log(log_level::ERROR, "Could not open serial port " +
+                                                 node_->settings()->device +
+                                                 ". Error: " + err.what() + ".");
+                return false;
             }
+            auto openedTime = std::chrono::steady_clock::now();
 
             // No Parity, 8bits data, 1 stop Bit
             stream_->set_option(boost::asio::serial_port_base::baud_rate(baudrate_));
@@ -378,8 +692,44 @@ namespace io {
             ioctl(fd, TIOCGSERIAL, &serialInfo);
             serialInfo.flags |= ASYNC_LOW_LATENCY;
             ioctl(fd, TIOCSSERIAL, &serialInfo);
+            auto configuredTime = std::chrono::steady_clock::now();
+
+            // With fast bring-up the target baudrate set above is verified by
+            // probing the Rx, only if it does not respond the baudrate is walked
+            bool probed = fastBringup && probe();
+            auto probedTime = std::chrono::steady_clock::now();
+            bool result = true;
+            if (probed)
+            {
+                ::tcflush(fd, TCIOFLUSH);
+            } else
+            {
+                if (fastBringup)
+                {
+                    node_->log(log_level::WARN,
+                               "No response from Rx at " +
+                                   std::to_string(baudrate_) +
+                                   " baud, gradually increasing the baudrate.");
+                    stream_->set_option(boost::asio::serial_port_base::baud_rate(
+                        DEFAULT_SERIAL_BAUDRATE));
+                }
+                result = setBaudrate();
+            }
+            auto endTime = std::chrono::steady_clock::now();
 
-            return setBaudrate();
+            auto ms = [](std::chrono::steady_clock::duration d) {
+                return std::to_string(
+                    std::chrono::duration_cast<std::chrono::milliseconds>(d)
+                        .count());
+            };
+            node_->log(log_level::INFO,
+                       "Serial bring-up took " + ms(endTime - start) +
+                           " ms (open: " + ms(openedTime - start) +
+                           " ms, configure: " + ms(configuredTime - openedTime) +
+                           " ms, probe: " + ms(probedTime - configuredTime) +
+                           " ms, baudrate walk: " + ms(endTime - probedTime) +
+                           " ms)");
+            return result;
         }
 
         [[nodiscard]] bool setBaudrate()
@@ -486,10 +836,86 @@ namespace io {
         }
 
     private:
+        /**
+         * @brief Checks whether the Rx responds at the current baudrate
+         *
+         * If the Rx is to be configured, the escape sequence is sent and its
+         * connection descriptor is awaited. Otherwise the Rx is expected to output
+         * data already and a sync sequence is awaited.
+         * @return Whether the Rx responded within SERIAL_PROBE_TIMEOUT_MS
+         */
+        [[nodiscard]] bool probe()
+        {
+            int fd = stream_->native_handle();
+            ::tcflush(fd, TCIFLUSH);
+            bool active = node_->settings()->configure_rx;
+            if (active)
+            {
+                static const std::string escape("\x0DSSSSSSSSSS\x0D\x0D");
+                boost::system::error_code ec;
+                boost::asio::write(*stream_, boost::asio::buffer(escape), ec);
+                if (ec)
+                    return false;
+            }
+
+            std::array<uint8_t, 1024> buffer;
+            size_t size = 0;
+            auto deadline = std::chrono::steady_clock::now() +
+                            std::chrono::milliseconds(SERIAL_PROBE_TIMEOUT_MS);
+            while (size < buffer.size())
+            {
+                auto remaining =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(
+                        deadline - std::chrono::steady_clock::now())
+                        .count();
+                if (remaining <= 0)
+                    break;
+                pollfd pfd = {fd, POLLIN, 0};
+                int ready = ::poll(&pfd, 1, static_cast<int>(remaining));
+                if ((ready < 0) && (errno == EINTR))
+                    continue;
+                if (ready <= 0)
+                    break;
+                ssize_t n = ::read(fd, buffer.data() + size, buffer.size() - size);
+                if (n <= 0)
+                    break;
+                size += n;
+
+                if (active ? containsConnectionDescriptor(buffer.data(), size)
+                           : (findSync(buffer.data(), size) + 1 < size))
+                    return true;
+            }
+            return false;
+        }
+
+        //! Whether a connection descriptor, e.g. "COM1>" or "USB2>", is contained
+        [[nodiscard]] static bool containsConnectionDescriptor(const uint8_t* data,
+                                                               size_t size)
+        {
+            for (size_t i = 0; i < size; ++i)
+            {
+                if (data[i] != CONNECTION_DESCRIPTOR_FOOTER)
+                    continue;
+                size_t begin = i;
+                while ((begin > 0) && std::isalnum(data[begin - 1]))
+                    --begin;
+                if ((i - begin >= 3) && (i - begin <= 5) &&
+                    ((data[begin] == CONNECTION_DESCRIPTOR_BYTE_I) ||
+                     (data[begin] == CONNECTION_DESCRIPTOR_BYTE_C) ||
+                     (data[begin] == CONNECTION_DESCRIPTOR_BYTE_U) ||
+                     (data[begin] == CONNECTION_DESCRIPTOR_BYTE_N) ||
+                     (data[begin] == CONNECTION_DESCRIPTOR_BYTE_D)))
+                    return true;
+            }
+            return false;
+        }
+
         ROSaicNodeBase* node_;
-        std::shared_ptr<boost::asio::io_service> ioService_;
+        IoExecutor executor_;
         std::string flowcontrol_;
         uint32_t baudrate_;
+        //! Thread of the last asynchronous bring-up
+        std::thread bringup_;
 
     public:
         std::unique_ptr<boost::asio::serial_port> stream_;
@@ -498,16 +924,19 @@ namespace io {
     class SbfFileIo
     {
     public:
-        SbfFileIo(ROSaicNodeBase* node,
-                  std::shared_ptr<boost::asio::io_service> ioService) :
-            node_(node),
-            ioService_(ioService)
+        SbfFileIo(ROSaicNodeBase* node, const IoExecutor& executor) :
+            node_(node), executor_(executor)
         {
         }
 
-        ~SbfFileIo() { stream_->close(); }
+        ~SbfFileIo() { close(); }
 
-        void close() { stream_->close(); }
+        void close()
+        {
+            file_.close();
+            if (stream_)
+                stream_->close();
+        }
 
         [[nodiscard]] bool connect()
         {
@@ -521,10 +950,32 @@ namespace io {
                 return false;
             }
 
+            if (node_->settings()->mmap_files)
+            {
+                std::string error;
+                if (file_.map(fd, error))
+                {
+                    ::close(fd);
+                    node_->log(log_level::DEBUG,
+                               "SBF file mapped, " + std::to_string(file_.size()) +
+                                   " bytes.");
+                    selectRanges();
+                    return true;
+                }
+                if (!error.empty())
+                    node_->log(log_level::WARN,
+                               "Mapping SBF file failed (" + error +
+                                   "), reading it instead.");
+            }
+            if (replayFilter().active())
+                node_->log(log_level::WARN,
+                           "replay.start, replay.end and replay.block_ids require "
+                           "a mapped SBF file, replaying all of it.");
+
             try
             {
                 stream_.reset(
-                    new boost::asio::posix::stream_descriptor(*ioService_));
+                    new boost::asio::posix::stream_descriptor(executor_));
                 stream_->assign(fd);
 
             } catch (std::runtime_error& e)
@@ -536,9 +987,64 @@ namespace io {
             return true;
         }
 
+        //! Whether the file is memory-mapped instead of read through stream_
+        [[nodiscard]] bool mapped() const { return file_.mapped(); }
+
+        //! Mapped content of the file
+        [[nodiscard]] const uint8_t* data() const { return file_.data(); }
+
+        //! Byte ranges of the mapped file to be replayed
+        [[nodiscard]] const std::vector<ByteRange>& ranges() const
+        {
+            return ranges_;
+        }
+
     private:
+        [[nodiscard]] SbfReplayFilter replayFilter() const
+        {
+            SbfReplayFilter filter;
+            filter.start = node_->settings()->replay_start;
+            filter.end = node_->settings()->replay_end;
+            filter.blockNumbers = node_->settings()->replay_block_ids;
+            return filter;
+        }
+
+        //! Selects the part of the file to be replayed using its index, which is
+        //! built and stored next to the file if missing
+        void selectRanges()
+        {
+            SbfReplayFilter filter = replayFilter();
+            std::vector<SbfIndexEntry> index;
+            if (filter.active())
+            {
+                std::string path = sbfIndexPath(node_->settings()->device);
+                std::string error;
+                if (!readSbfIndex(path, file_.size(), index, error))
+                {
+                    node_->log(log_level::INFO,
+                               "Indexing SBF file since " + error + ".");
+                    index = buildSbfIndex(file_.data(), file_.size());
+                    if (!writeSbfIndex(path, file_.size(), index, error))
+                        node_->log(log_level::WARN,
+                                   "Storing SBF index failed: " + error);
+                }
+            }
+            ranges_ = selectSbfRanges(index, file_.size(), filter);
+
+            size_t bytes = 0;
+            for (const auto& range : ranges_)
+                bytes += range.end - range.begin;
+            if (filter.active())
+                node_->log(log_level::INFO,
+                           "Replaying " + std::to_string(bytes) + " of " +
+                               std::to_string(file_.size()) + " bytes in " +
+                               std::to_string(ranges_.size()) + " range(s).");
+        }
+
         ROSaicNodeBase* node_;
-        std::shared_ptr<boost::asio::io_service> ioService_;
+        IoExecutor executor_;
+        MappedFile file_;
+        std::vector<ByteRange> ranges_;
 
     public:
         std::unique_ptr<boost::asio::posix::stream_descriptor> stream_;
@@ -547,55 +1053,91 @@ namespace io {
     class PcapFileIo
     {
     public:
-        PcapFileIo(ROSaicNodeBase* node,
-                   std::shared_ptr<boost::asio::io_service> ioService) :
-            node_(node),
-            ioService_(ioService)
+        PcapFileIo(ROSaicNodeBase* node, const IoExecutor& executor) :
+            node_(node), executor_(executor)
         {
         }
 
-        ~PcapFileIo()
-        {
-            pcap_close(pcap_);
-            stream_->close();
-        }
+        ~PcapFileIo() { close(); }
 
         void close()
         {
-            pcap_close(pcap_);
-            stream_->close();
+            if (pcap_)
+            {
+                pcap_close(pcap_);
+                pcap_ = nullptr;
+            }
         }
 
         [[nodiscard]] bool connect()
         {
-            try
-            {
-                node_->log(log_level::INFO, "Opening pcap file stream" +
-                                                node_->settings()->device + "...");
-
-                stream_.reset(
-                    new boost::asio::posix::stream_descriptor(*ioService_));
+            close();
+            node_->log(log_level::INFO, "Opening pcap file " +
+                                            node_->settings()->device + "...");
 
-                pcap_ = pcap_open_offline(node_->settings()->device.c_str(),
-                                          errBuff_.data());
-                stream_->assign(pcap_get_selectable_fd(pcap_));
+            uint32_t address;
+            if (!parseRxAddress(node_->settings()->pcap_rx_ip, address))
+            {
+                node_->log(log_level::ERROR,
+                           "Invalid pcap.rx_ip " + node_->settings()->pcap_rx_ip +
+                               ", expected an IPv4 address.");
+                return false;
+            }
 
-            } catch (std::runtime_error& e)
+            pcap_ = pcap_open_offline_with_tstamp_precision(
+                node_->settings()->device.c_str(), PCAP_TSTAMP_PRECISION_NANO,
+                errBuff_.data());
+            if (!pcap_)
             {
-                node_->log(log_level::ERROR, "assigning PCAP file failed due to " +
-                                                 static_cast<std::string>(e.what()));
+                node_->log(log_level::ERROR, "opening PCAP file failed due to " +
+                                                 std::string(errBuff_.data()));
+                return false;
+            }
+            uint16_t port = static_cast<uint16_t>(node_->settings()->pcap_rx_port);
+            if (!decoder_.reset(pcap_datalink(pcap_), address, port))
+            {
+                node_->log(log_level::ERROR,
+                           "PCAP link-layer header type " +
+                               std::to_string(pcap_datalink(pcap_)) +
+                               " is not supported.");
+                close();
                 return false;
             }
             return true;
         }
 
+        /**
+         * @brief Reads the next packet of the capture
+         * @param[out] header Capture time and length of the packet
+         * @param[out] data Captured bytes, valid until the next call
+         * @return 1 on success, PCAP_ERROR_BREAK at the end of the file,
+         * PCAP_ERROR on errors
+         */
+        [[nodiscard]] int next(pcap_pkthdr*& header, const u_char*& data)
+        {
+            return pcap_next_ex(pcap_, &header, &data);
+        }
+
+        //! Description of the last error
+        [[nodiscard]] std::string error() const { return pcap_geterr(pcap_); }
+
+        //! Decoder of the packets
+        [[nodiscard]] PcapDecoder& decoder() { return decoder_; }
+
+        [[nodiscard]] const PcapStatistics& statistics() const
+        {
+            return decoder_.statistics();
+        }
+
     private:
         ROSaicNodeBase* node_;
-        std::shared_ptr<boost::asio::io_service> ioService_;
-        std::array<char, 100> errBuff_;
-        pcap_t* pcap_;
+        IoExecutor executor_;
+        std::array<char, PCAP_ERRBUF_SIZE> errBuff_;
+        pcap_t* pcap_ = nullptr;
+        PcapDecoder decoder_;
 
     public:
+        //! Only to satisfy AsyncManager, nothing is written to a capture
         std::unique_ptr<boost::asio::posix::stream_descriptor> stream_;
     };
 } // namespace io
\ No newline at end of file
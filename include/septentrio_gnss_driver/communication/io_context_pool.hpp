@@ -0,0 +1,151 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#pragma once
+
+// C++
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Boost
+#include <boost/asio.hpp>
+
+// ROSaic
+#include <septentrio_gnss_driver/communication/settings.hpp>
+#include <septentrio_gnss_driver/communication/thread_scheduling.hpp>
+
+/**
+ * @file io_context_pool.hpp
+ * @date 17/10/26
+ * @brief Threads running the I/O of all connections
+ */
+
+namespace io {
+
+    //! Executor of a connection, runs its handlers one at a time
+    using IoExecutor = boost::asio::strand<boost::asio::io_service::executor_type>;
+
+    //! Interval at which the scheduling latency of the I/O threads is probed
+    static const int SCHEDULING_PROBE_INTERVAL_MS = 100;
+
+    /**
+     * @class IoContextPool
+     * @brief I/O service shared by all connections and the threads running it
+     *
+     * Each connection runs its handlers on its own strand, so the handlers of one
+     * connection never run concurrently while different connections may be served
+     * by different threads. Connections have to be destroyed after stop() was
+     * called. Timers measure how late the threads run their expired handlers,
+     * i.e. their scheduling latency. There is one timer per thread and each delay
+     * is recorded for the thread that ran the handler, so that a thread which is
+     * scheduled late stands out instead of vanishing in an average. A thread busy
+     * with a long handler runs no probe meanwhile.
+     */
+    class IoContextPool
+    {
+    public:
+        //! Starts the threads, at least one
+        explicit IoContextPool(size_t threads);
+
+        ~IoContextPool();
+
+        //! Creates the strand of a connection
+        [[nodiscard]] IoExecutor makeStrand();
+
+        /**
+         * @brief Names the threads and sets their CPU affinity and scheduling
+         * @param[in] settings Affinity and scheduling
+         * @param[out] error Description of the settings that failed
+         * @return Whether all settings were applied
+         */
+        [[nodiscard]] bool configure(const ThreadSettings& settings,
+                                     std::string& error);
+
+        //! Stops the I/O service and joins the threads
+        void stop();
+
+        //! Number of threads running the I/O service
+        [[nodiscard]] size_t threads() const { return threads_.size(); }
+
+        //! Name of a thread as set by configure() and shown by profilers
+        [[nodiscard]] static std::string threadName(size_t thread);
+
+        //! CPU time the threads consumed in seconds
+        [[nodiscard]] double cpuTime() const;
+
+        //! Scheduling latency of a thread, thread < threads()
+        [[nodiscard]] const SchedulingLatency& schedulingLatency(size_t thread) const
+        {
+            return *latencies_[thread];
+        }
+
+    private:
+        /**
+         * @brief Measures the delay of the next expiry of a probe timer
+         * @param[in] probe Index of the timer
+         */
+        void scheduleProbe(size_t probe);
+
+        boost::asio::io_service ioService_;
+        std::unique_ptr<boost::asio::io_service::work> work_;
+        std::vector<std::unique_ptr<boost::asio::steady_timer>> probeTimers_;
+        //! Scheduling latency per thread, each only recorded by its thread
+        std::vector<std::unique_ptr<SchedulingLatency>> latencies_;
+        std::vector<std::thread> threads_;
+        //! Guards the clocks, since the diagnostics read them while stopping
+        mutable std::mutex clocksMutex_;
+        //! CPU time clocks of the threads
+        std::vector<clockid_t> clocks_;
+        //! CPU time of the threads when they were stopped
+        double stoppedCpuTime_ = 0.0;
+    };
+
+    /**
+     * @brief Translates the thread parameters of the settings
+     * @param[in] settings Affinity and scheduling parameters
+     * @param[out] scheduling Affinity and scheduling, invalid parameters keep the
+     * defaults
+     * @param[out] error Description of the invalid parameters
+     * @return Whether all parameters are valid
+     */
+    [[nodiscard]] bool toThreadScheduling(const ThreadSettings& settings,
+                                          ThreadScheduling& scheduling,
+                                          std::string& error);
+
+    //! Number of threads of the process
+    [[nodiscard]] size_t processThreadCount();
+
+    //! CPU time the process consumed in seconds
+    [[nodiscard]] double processCpuTime();
+} // namespace io
@@ -0,0 +1,370 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#pragma once
+
+// C++
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <type_traits>
+
+// ROSaic
+#include <septentrio_gnss_driver/abstraction/typedefs.hpp>
+#include <septentrio_gnss_driver/communication/connection_monitor.hpp>
+#include <septentrio_gnss_driver/communication/datagram_batch.hpp>
+#include <septentrio_gnss_driver/communication/flight_recorder.hpp>
+#include <septentrio_gnss_driver/communication/io_context_pool.hpp>
+#include <septentrio_gnss_driver/communication/pcap_decoder.hpp>
+#include <septentrio_gnss_driver/communication/raw_recorder.hpp>
+#include <septentrio_gnss_driver/communication/receive_clock.hpp>
+#include <septentrio_gnss_driver/communication/telegram_framer.hpp>
+#include <septentrio_gnss_driver/communication/telegram_pool.hpp>
+#include <septentrio_gnss_driver/communication/telegram_queue.hpp>
+#include <septentrio_gnss_driver/communication/write_queue.hpp>
+
+/**
+ * @file io_diagnostics.hpp
+ * @date 17/10/26
+ * @brief Helpers to report statistics of the I/O layer as diagnostics
+ */
+
+namespace io {
+
+    /**
+     * @brief Appends a key value pair to a diagnostic status
+     * @param[in,out] status Diagnostic status
+     * @param[in] key Key
+     * @param[in] value Value, either arithmetic or a string
+     */
+    template <typename T>
+    void addDiagnosticValue(DiagnosticStatusMsg& status, const std::string& key,
+                            const T& value)
+    {
+        KeyValueMsg keyValue;
+        keyValue.key = key;
+        if constexpr (std::is_arithmetic_v<T>)
+            keyValue.value = std::to_string(value);
+        else
+            keyValue.value = value;
+        status.values.push_back(keyValue);
+    }
+
+    /**
+     * @brief Appends the statistics of a telegram pool to a diagnostic status
+     * @param[in,out] status Diagnostic status
+     * @param[in] prefix Prefix of the keys
+     * @param[in] stats Pool statistics
+     */
+    inline void addDiagnosticValues(DiagnosticStatusMsg& status,
+                                    const std::string& prefix,
+                                    const TelegramPoolStatistics& stats)
+    {
+        addDiagnosticValue(status, prefix + "pool hits", stats.hits.load());
+        addDiagnosticValue(status, prefix + "pool misses", stats.misses.load());
+        addDiagnosticValue(status, prefix + "pool high water mark",
+                           stats.highWaterMark.load());
+    }
+
+    /**
+     * @brief Appends the statistics of a framer to a diagnostic status
+     * @param[in,out] status Diagnostic status
+     * @param[in] prefix Prefix of the keys
+     * @param[in] stats Framer statistics
+     */
+    inline void addDiagnosticValues(DiagnosticStatusMsg& status,
+                                    const std::string& prefix,
+                                    const FramerStatistics& stats)
+    {
+        addDiagnosticValue(status, prefix + "bytes received", stats.bytes.load());
+        addDiagnosticValue(status, prefix + "telegrams", stats.telegrams.load());
+        addDiagnosticValue(status, prefix + "telegrams reassembled",
+                           stats.reassembled.load());
+        addDiagnosticValue(status, prefix + "CRC failures",
+                           stats.crcFailures.load());
+        addDiagnosticValue(status, prefix + "bytes discarded",
+                           stats.discardedBytes.load());
+        addDiagnosticValue(status, prefix + "telegrams dropped by framer",
+                           stats.droppedFrames.load());
+    }
+
+    /**
+     * @brief Appends the statistics of the UDP reception to a diagnostic status
+     * @param[in,out] status Diagnostic status
+     * @param[in] prefix Prefix of the keys
+     * @param[in] stats UDP statistics
+     */
+    inline void addDiagnosticValues(DiagnosticStatusMsg& status,
+                                    const std::string& prefix,
+                                    const UdpStatistics& stats)
+    {
+        uint64_t calls = stats.receiveCalls.load();
+        uint64_t datagrams = stats.datagrams.load();
+        addDiagnosticValue(status, prefix + "datagrams", datagrams);
+        addDiagnosticValue(status, prefix + "datagrams per receive call",
+                           calls ? static_cast<double>(datagrams) / calls : 0.0);
+        addDiagnosticValue(status, prefix + "datagrams dropped by kernel",
+                           stats.kernelDrops.load());
+    }
+
+    /**
+     * @brief Appends the statistics of decoding a capture to a diagnostic status
+     * @param[in,out] status Diagnostic status
+     * @param[in] prefix Prefix of the keys
+     * @param[in] stats Capture decoder statistics
+     */
+    inline void addDiagnosticValues(DiagnosticStatusMsg& status,
+                                    const std::string& prefix,
+                                    const PcapStatistics& stats)
+    {
+        addDiagnosticValue(status, prefix + "packets", stats.packets.load());
+        addDiagnosticValue(status, prefix + "packets skipped",
+                           stats.skippedPackets.load());
+        addDiagnosticValue(status, prefix + "IP fragments", stats.fragments.load());
+        addDiagnosticValue(status, prefix + "TCP segments out of order",
+                           stats.outOfOrderSegments.load());
+        addDiagnosticValue(status, prefix + "TCP bytes retransmitted",
+                           stats.duplicateBytes.load());
+        addDiagnosticValue(status, prefix + "TCP bytes missing",
+                           stats.lostBytes.load());
+        addDiagnosticValue(status, prefix + "TCP connections",
+                           stats.connections.load());
+    }
+
+    /**
+     * @brief Appends the statistics of recording the received bytes to a
+     * diagnostic status
+     * @param[in,out] status Diagnostic status
+     * @param[in] prefix Prefix of the keys
+     * @param[in] stats Recorder statistics
+     */
+    inline void addDiagnosticValues(DiagnosticStatusMsg& status,
+                                    const std::string& prefix,
+                                    const RecorderStatistics& stats)
+    {
+        uint64_t writes = stats.writes.load();
+        addDiagnosticValue(status, prefix + "bytes received", stats.bytes.load());
+        addDiagnosticValue(status, prefix + "bytes written",
+                           stats.bytesWritten.load());
+        addDiagnosticValue(status, prefix + "files", stats.files.load());
+        addDiagnosticValue(status, prefix + "chunks dropped",
+                           stats.droppedChunks.load());
+        addDiagnosticValue(status, prefix + "bytes dropped",
+                           stats.droppedBytes.load());
+        addDiagnosticValue(status, prefix + "buffers failed to write",
+                           stats.failedBuffers.load());
+        addDiagnosticValue(status, prefix + "write latency mean [ms]",
+                           writes ? stats.latencySumNs.load() / (1e6 * writes)
+                                  : 0.0);
+        addDiagnosticValue(status, prefix + "write latency max [ms]",
+                           stats.latencyMaxNs.load() / 1e6);
+    }
+
+    /**
+     * @brief Appends the statistics of the flight recorder to a diagnostic status
+     * @param[in,out] status Diagnostic status
+     * @param[in] prefix Prefix of the keys
+     * @param[in] stats Flight recorder statistics
+     */
+    inline void addDiagnosticValues(DiagnosticStatusMsg& status,
+                                    const std::string& prefix,
+                                    const FlightRecorderStatistics& stats)
+    {
+        addDiagnosticValue(status, prefix + "triggers", stats.triggers.load());
+        addDiagnosticValue(status, prefix + "dumps", stats.dumps.load());
+        addDiagnosticValue(status, prefix + "dumps failed",
+                           stats.failedDumps.load());
+        addDiagnosticValue(status, prefix + "telegrams skipped",
+                           stats.skippedTelegrams.load());
+    }
+
+    /**
+     * @brief Appends the delay of user space behind kernel receive timestamps to a
+     * diagnostic status
+     * @param[in,out] status Diagnostic status
+     * @param[in] prefix Prefix of the keys
+     * @param[in] stats Clock statistics
+     */
+    inline void addDiagnosticValues(DiagnosticStatusMsg& status,
+                                    const std::string& prefix,
+                                    const ReceiveClockStatistics& stats)
+    {
+        uint64_t count = stats.count.load();
+        double meanUs = count ? stats.delaySumNs.load() / (1000.0 * count) : 0.0;
+        double varianceUs2 =
+            count ? static_cast<double>(stats.delaySqSumUs2.load()) / count -
+                        meanUs * meanUs
+                  : 0.0;
+        addDiagnosticValue(status, prefix + "kernel timestamps", count);
+        addDiagnosticValue(status, prefix + "kernel to user space delay mean [us]",
+                           meanUs);
+        addDiagnosticValue(status, prefix + "kernel to user space jitter [us]",
+                           std::sqrt(std::max(varianceUs2, 0.0)));
+        addDiagnosticValue(status, prefix + "kernel to user space delay max [us]",
+                           stats.delayMaxNs.load() / 1000.0);
+    }
+
+    /**
+     * @brief Appends the outages of a connection to a diagnostic status
+     * @param[in,out] status Diagnostic status
+     * @param[in] prefix Prefix of the keys
+     * @param[in] stats Connection statistics
+     */
+    inline void addDiagnosticValues(DiagnosticStatusMsg& status,
+                                    const std::string& prefix,
+                                    const ConnectionStatistics& stats)
+    {
+        uint64_t outages = stats.outages.load();
+        uint64_t resumed = stats.resumed.load();
+        auto meanMs = [](uint64_t sumNs, uint64_t count) {
+            return count ? sumNs / (1e6 * count) : 0.0;
+        };
+        addDiagnosticValue(status, prefix + "outages", outages);
+        addDiagnosticValue(status, prefix + "reconnect attempts",
+                           stats.reconnectAttempts.load());
+        addDiagnosticValue(status, prefix + "time to detect outage mean [ms]",
+                           meanMs(stats.detectSumNs.load(), outages));
+        addDiagnosticValue(status, prefix + "time to detect outage max [ms]",
+                           stats.detectMaxNs.load() / 1e6);
+        addDiagnosticValue(status, prefix + "outage duration mean [ms]",
+                           meanMs(stats.outageSumNs.load(), resumed));
+        addDiagnosticValue(status, prefix + "outage duration max [ms]",
+                           stats.outageMaxNs.load() / 1e6);
+        addDiagnosticValue(status, prefix + "time to resume data mean [ms]",
+                           meanMs(stats.resumeSumNs.load(), resumed));
+        addDiagnosticValue(status, prefix + "time to resume data max [ms]",
+                           stats.resumeMaxNs.load() / 1e6);
+    }
+
+    /**
+     * @brief Appends the scheduling latency of a thread to a diagnostic status
+     * @param[in,out] status Diagnostic status
+     * @param[in] prefix Prefix of the keys, naming the thread
+     * @param[in] latency Scheduling latency
+     */
+    inline void addDiagnosticValues(DiagnosticStatusMsg& status,
+                                    const std::string& prefix,
+                                    const SchedulingLatency& latency)
+    {
+        uint64_t count = latency.count.load();
+        addDiagnosticValue(status, prefix + " scheduling latency mean [us]",
+                           count ? latency.sumNs.load() / (1000.0 * count) : 0.0);
+        addDiagnosticValue(status, prefix + " scheduling latency max [us]",
+                           latency.maxNs.load() / 1000.0);
+    }
+
+    /**
+     * @brief Appends thread count and CPU time of the I/O threads and of the
+     * process to a diagnostic status
+     * @param[in,out] status Diagnostic status
+     * @param[in] prefix Prefix of the keys
+     * @param[in] pool I/O context pool
+     */
+    inline void addDiagnosticValues(DiagnosticStatusMsg& status,
+                                    const std::string& prefix,
+                                    const IoContextPool& pool)
+    {
+        addDiagnosticValue(status, prefix + "I/O threads", pool.threads());
+        addDiagnosticValue(status, prefix + "I/O threads CPU time [s]",
+                           pool.cpuTime());
+        for (size_t i = 0; i < pool.threads(); ++i)
+            addDiagnosticValues(status, prefix + IoContextPool::threadName(i),
+                                pool.schedulingLatency(i));
+        addDiagnosticValue(status, prefix + "process threads",
+                           processThreadCount());
+        addDiagnosticValue(status, prefix + "process CPU time [s]",
+                           processCpuTime());
+    }
+
+    /**
+     * @brief Appends depth, batching and latency of a write queue to a diagnostic
+     * status
+     * @param[in,out] status Diagnostic status
+     * @param[in] prefix Prefix of the keys
+     * @param[in] queue Write queue
+     */
+    inline void addDiagnosticValues(DiagnosticStatusMsg& status,
+                                    const std::string& prefix,
+                                    const WriteQueue& queue)
+    {
+        const WriteStatistics& stats = queue.statistics();
+        uint64_t messages = stats.messages.load();
+        uint64_t writes = stats.writes.load();
+        addDiagnosticValue(status, prefix + "write queue depth", queue.depth());
+        addDiagnosticValue(status, prefix + "write queue max depth",
+                           stats.maxDepth.load());
+        addDiagnosticValue(status, prefix + "messages sent", messages);
+        addDiagnosticValue(status, prefix + "bytes sent", stats.bytes.load());
+        addDiagnosticValue(status, prefix + "messages per write",
+                           writes ? static_cast<double>(messages) / writes : 0.0);
+        addDiagnosticValue(status, prefix + "messages failed to send",
+                           stats.failures.load());
+        addDiagnosticValue(status, prefix + "write latency mean [ms]",
+                           messages ? stats.latencySumNs.load() / (1e6 * messages)
+                                    : 0.0);
+        addDiagnosticValue(status, prefix + "write latency max [ms]",
+                           stats.latencyMaxNs.load() / 1e6);
+    }
+
+    /**
+     * @brief Appends capacity and per-lane statistics of a telegram queue to a
+     * diagnostic status
+     * @param[in,out] status Diagnostic status
+     * @param[in] prefix Prefix of the keys
+     * @param[in] queue Telegram queue
+     */
+    inline void addDiagnosticValues(DiagnosticStatusMsg& status,
+                                    const std::string& prefix,
+                                    const TelegramQueue& queue)
+    {
+        addDiagnosticValue(status, prefix + "telegram queue capacity per lane",
+                           queue.capacity());
+        addDiagnosticValues(status, prefix + "processing thread",
+                            queue.wakeupLatency());
+        for (size_t i = 0; i < TELEGRAM_LANE_COUNT; ++i)
+        {
+            auto lane = static_cast<telegram_lane::TelegramLane>(i);
+            const TelegramQueueStatistics& stats = queue.statistics(lane);
+            const std::string key = prefix + laneName(lane) + " lane ";
+            uint64_t popped = stats.popped.load();
+            double meanLatency =
+                popped ? stats.latencySumNs.load() / (1000.0 * popped) : 0.0;
+            addDiagnosticValue(status, key + "telegrams queued",
+                               stats.pushed.load());
+            addDiagnosticValue(status, key + "telegrams dropped",
+                               stats.dropped.load());
+            addDiagnosticValue(status, key + "high water mark",
+                               stats.highWaterMark.load());
+            addDiagnosticValue(status, key + "mean latency [us]", meanLatency);
+            addDiagnosticValue(status, key + "max latency [us]",
+                               stats.latencyMaxNs.load() / 1000.0);
+        }
+    }
+} // namespace io
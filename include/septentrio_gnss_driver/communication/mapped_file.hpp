@@ -0,0 +1,89 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#pragma once
+
+// C++
+#include <cstdint>
+#include <string>
+
+/**
+ * @file mapped_file.hpp
+ * @date 17/10/26
+ * @brief Read-only memory mapping of a file
+ */
+
+namespace io {
+
+    /**
+     * @class MappedFile
+     * @brief Maps a regular file read-only for sequential access, unmapped on
+     * destruction
+     */
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+
+        ~MappedFile() { close(); }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /**
+         * @brief Maps a file
+         * @param[in] path Path of the file
+         * @param[out] error Description of the failure
+         * @return Whether the file was mapped
+         */
+        [[nodiscard]] bool open(const std::string& path, std::string& error);
+
+        /**
+         * @brief Maps an open file, the descriptor may be closed afterwards
+         * @param[in] fd File descriptor
+         * @param[out] error Description of the failure, empty if the file is no
+         * non-empty regular file and hence cannot be mapped
+         * @return Whether the file was mapped
+         */
+        [[nodiscard]] bool map(int fd, std::string& error);
+
+        void close();
+
+        [[nodiscard]] bool mapped() const { return data_ != nullptr; }
+
+        [[nodiscard]] const uint8_t* data() const { return data_; }
+
+        [[nodiscard]] size_t size() const { return size_; }
+
+    private:
+        const uint8_t* data_ = nullptr;
+        size_t size_ = 0;
+    };
+} // namespace io
@@ -143,7 +143,7 @@ namespace io {
          * @param[in] node Pointer to the node)
          */
         MessageHandler(ROSaicNodeBase* node) :
-            node_(node), settings_(node->settings()), unix_time_(0)
+            node_(node), settings_(node->settings())
         {
         }
 
@@ -166,6 +166,12 @@ namespace io {
          */
         void parseNmea(const std::shared_ptr<Telegram>& telegram);
 
+        //! Serial number of the Rx from the last ReceiverSetup block
+        [[nodiscard]] const std::string& rxSerialNumber() const
+        {
+            return last_receiversetup_.rx_serial_number;
+        }
+
     private:
         /**
          * @brief Header assembling
@@ -306,10 +312,6 @@ namespace io {
          */
         RfStatusMsg last_rf_status_;
 
-        //! When reading from an SBF file, the ROS publishing frequency is governed
-        //! by the time stamps found in the SBF blocks therein.
-        Timestamp unix_time_;
-
         //! Last reported PVT processing latency
         mutable uint64_t last_pvt_latency_ = 0;
 
@@ -394,8 +396,9 @@ namespace io {
         void assembleTimeReference(const std::shared_ptr<Telegram>& telegram);
 
         /**
-         * @brief Waits according to time when reading from file
-         * @param[in] time_obj wait until time
+         * @brief Waits until a message read from file is due according to the
+         * replay clock and publishes /clock if the replay time advanced
+         * @param[in] time_obj time stamp of the message
          */
         void wait(Timestamp time_obj);
 
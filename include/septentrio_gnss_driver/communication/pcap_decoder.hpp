@@ -0,0 +1,203 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#pragma once
+
+// C++
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @file pcap_decoder.hpp
+ * @date 17/10/26
+ * @brief Extracts the byte stream of the Rx from the packets of a capture
+ */
+
+namespace io {
+
+    //! Link-layer header types of captures as returned by pcap_datalink()
+    namespace link_type {
+        enum LinkType
+        {
+            NULL_LOOPBACK = 0,
+            ETHERNET = 1,
+            RAW = 12,
+            RAW_OPENBSD = 14,
+            LINKTYPE_RAW = 101,
+            LOOP = 108,
+            LINUX_SLL = 113,
+            IPV4 = 228,
+            LINUX_SLL2 = 276
+        };
+    }
+
+    //! Maximum number of bytes of out-of-order TCP segments that are buffered
+    //! before the missing data is considered lost
+    static const size_t MAX_PENDING_TCP_BYTES = 4194304;
+
+    /**
+     * @struct PcapStatistics
+     * @brief Counters of the capture decoder, may be read from any thread
+     */
+    struct PcapStatistics
+    {
+        //! Number of packets read from the capture
+        std::atomic<uint64_t> packets{0};
+        //! Number of packets not belonging to the stream of the Rx or not decodable
+        std::atomic<uint64_t> skippedPackets{0};
+        //! Number of IPv4 fragments, which are not reassembled
+        std::atomic<uint64_t> fragments{0};
+        //! Number of payload bytes of the stream of the Rx passed on
+        std::atomic<uint64_t> bytes{0};
+        //! Number of TCP segments that arrived before preceding data
+        std::atomic<uint64_t> outOfOrderSegments{0};
+        //! Number of retransmitted TCP bytes that were already passed on
+        std::atomic<uint64_t> duplicateBytes{0};
+        //! Number of TCP bytes missing from the capture
+        std::atomic<uint64_t> lostBytes{0};
+        //! Number of TCP connections of the Rx that were followed
+        std::atomic<uint64_t> connections{0};
+    };
+
+    /**
+     * @class PcapDecoder
+     * @brief Decodes the link-layer, IPv4, TCP and UDP headers of captured packets
+     * and passes on the payload the Rx sent
+     *
+     * The stream of the Rx is the first TCP connection or UDP flow whose source
+     * matches the given address and port and whose payload contains a sync
+     * sequence. TCP segments are reassembled in sequence order, retransmissions
+     * are dropped and out-of-order segments are buffered until the gap is filled.
+     * If the Rx opens a new connection from the same address and port, the decoder
+     * follows it. UDP payloads are passed on as they are.
+     */
+    class PcapDecoder
+    {
+    public:
+        //! Receives consecutive parts of the stream of the Rx
+        typedef std::function<void(const uint8_t* data, size_t size)> PayloadSink;
+
+        PcapDecoder();
+
+        /**
+         * @brief Starts decoding a capture
+         * @param[in] linkType Link-layer header type of the capture
+         * @param[in] address IPv4 address of the Rx in host byte order, 0 for any
+         * @param[in] port Port of the Rx, 0 for any
+         * @return Whether the link-layer header type is supported
+         */
+        [[nodiscard]] bool reset(int linkType, uint32_t address, uint16_t port);
+
+        /**
+         * @brief Decodes a captured packet
+         * @param[in] frame Captured bytes of the packet
+         * @param[in] size Number of captured bytes
+         * @param[in] sink Receives the payload that continues the stream, if any
+         */
+        void decode(const uint8_t* frame, size_t size, const PayloadSink& sink);
+
+        //! Passes on buffered out-of-order segments skipping the gaps, e.g. at the
+        //! end of the capture
+        void flush(const PayloadSink& sink);
+
+        //! Whether the stream of the Rx was found
+        [[nodiscard]] bool locked() const { return locked_; }
+
+        //! Description of the stream of the Rx, e.g. "TCP 10.0.0.2:28784 ->
+        //! 10.0.0.1:50000"
+        [[nodiscard]] std::string streamName() const;
+
+        [[nodiscard]] const PcapStatistics& statistics() const { return stats_; }
+
+    private:
+        struct Flow
+        {
+            uint8_t protocol = 0;
+            uint32_t srcAddress = 0;
+            uint32_t dstAddress = 0;
+            uint16_t srcPort = 0;
+            uint16_t dstPort = 0;
+
+            [[nodiscard]] bool operator==(const Flow& other) const;
+        };
+
+        /**
+         * @brief Finds the IPv4 header behind the link-layer header
+         * @param[in] frame Captured bytes of the packet
+         * @param[in] size Number of captured bytes
+         * @return Offset of the IPv4 header, size if there is none
+         */
+        [[nodiscard]] size_t ipv4Offset(const uint8_t* frame, size_t size) const;
+
+        //! Whether the source of the flow is the one configured for the Rx
+        [[nodiscard]] bool matchesRx(const Flow& flow) const;
+
+        //! Reassembles the payload of a TCP segment of the stream of the Rx
+        void decodeTcp(const uint8_t* segment, size_t size, const PayloadSink& sink);
+
+        //! Passes on data continuing the TCP stream
+        void deliver(const uint8_t* data, size_t size, const PayloadSink& sink);
+
+        //! Passes on buffered segments that continue the TCP stream
+        void drainPending(const PayloadSink& sink);
+
+        //! Continues the TCP stream with the earliest buffered segment
+        void skipGap(const PayloadSink& sink);
+
+        int linkType_ = link_type::ETHERNET;
+        uint32_t address_ = 0;
+        uint16_t port_ = 0;
+
+        //! Whether flow_ is the stream of the Rx
+        bool locked_ = false;
+        Flow flow_;
+        //! Whether nextSeq_ is known
+        bool synced_ = false;
+        //! TCP sequence number of the next byte of the stream
+        uint32_t nextSeq_ = 0;
+        //! Out-of-order TCP segments by sequence number
+        std::map<uint32_t, std::vector<uint8_t>> pending_;
+        size_t pendingBytes_ = 0;
+
+        PcapStatistics stats_;
+    };
+
+    /**
+     * @brief Parses the address of the Rx in a capture
+     * @param[in] ip IPv4 address in dotted decimal notation, empty for any
+     * @param[out] address Address in host byte order, 0 for any
+     * @return Whether the address is valid
+     */
+    [[nodiscard]] bool parseRxAddress(const std::string& ip, uint32_t& address);
+} // namespace io
@@ -0,0 +1,209 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#pragma once
+
+// C++
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ROSaic
+#include <septentrio_gnss_driver/abstraction/typedefs.hpp>
+
+/**
+ * @file raw_recorder.hpp
+ * @date 17/10/26
+ * @brief Records the bytes received on each connection into rotating files
+ */
+
+namespace io {
+
+    //! Alignment of buffers and writes to files opened with O_DIRECT
+    static const size_t RECORD_ALIGNMENT = 4096;
+    //! Partially filled buffers are written after this time
+    static const std::chrono::milliseconds RECORD_FLUSH_INTERVAL{1000};
+
+    //! Current UTC time as part of a file name, e.g. 20261017_120000
+    [[nodiscard]] std::string utcFileTime();
+
+    /**
+     * @struct RecorderStatistics
+     * @brief Statistics of a raw recorder, may be read from any thread
+     */
+    struct RecorderStatistics
+    {
+        //! Number of bytes received on the recorded connections
+        std::atomic<uint64_t> bytes{0};
+        //! Number of bytes written to files, after compression
+        std::atomic<uint64_t> bytesWritten{0};
+        //! Number of files opened
+        std::atomic<uint64_t> files{0};
+        //! Number of received chunks dropped since no buffer was free
+        std::atomic<uint64_t> droppedChunks{0};
+        std::atomic<uint64_t> droppedBytes{0};
+        //! Number of buffers that could not be written to a file
+        std::atomic<uint64_t> failedBuffers{0};
+        //! Duration of the writes to files in nanoseconds
+        std::atomic<uint64_t> writes{0};
+        std::atomic<uint64_t> latencySumNs{0};
+        std::atomic<uint64_t> latencyMaxNs{0};
+    };
+
+    class RawRecorder;
+
+    /**
+     * @class RecordChannel
+     * @brief Stream of one connection recorded into its own files
+     */
+    class RecordChannel
+    {
+    public:
+        ~RecordChannel();
+
+        /**
+         * @brief Copies received bytes into the buffer of the channel, never
+         * blocks on file I/O. If no buffer is free, the bytes are dropped.
+         * @param[in] data Pointer to the bytes
+         * @param[in] size Number of bytes
+         */
+        void record(const uint8_t* data, size_t size);
+
+    private:
+        friend class RawRecorder;
+
+        struct Buffer;
+        class File;
+
+        RecordChannel(RawRecorder* recorder, const std::string& name);
+
+        //! Writes a buffer to the current file, rotating it if due, only called
+        //! by the writer thread
+        void write(const Buffer& buffer);
+        //! Opens the next file, only called by the writer thread
+        [[nodiscard]] bool rotate();
+        //! Closes the current file, only called by the writer thread
+        void closeFile();
+
+        RawRecorder* recorder_;
+        //! Name of the connection, prefix of the file names
+        std::string name_;
+        //! Buffer being filled, guarded by the mutex of the recorder
+        std::unique_ptr<Buffer> current_;
+        //! Whether bytes are being dropped, guarded by the mutex of the recorder
+        bool dropping_ = false;
+        //! File being written
+        std::unique_ptr<File> file_;
+        //! Number of files opened for the channel
+        uint64_t sequence_ = 0;
+        //! Files kept, the oldest first
+        std::deque<std::string> paths_;
+        //! Whether opening or writing the file failed
+        bool failing_ = false;
+    };
+
+    /**
+     * @class RawRecorder
+     * @brief Records the bytes received on the connections to the Rx, e.g. as a
+     * black box to be replayed later
+     *
+     * The I/O threads copy the received bytes into buffers taken from a fixed
+     * pool, full buffers are written to files by a dedicated thread. Hence,
+     * reception never waits for file I/O, and if the writer falls behind so far
+     * that the pool runs empty, received bytes are dropped instead. The files of a
+     * channel are named <name>_<UTC date>_<UTC time>_<sequence>.sbf and rotated by
+     * size and age. Optionally, they are written with O_DIRECT to bypass the page
+     * cache, preallocated with fallocate() and compressed with zstd (.sbf.zst).
+     */
+    class RawRecorder
+    {
+    public:
+        /**
+         * @brief Constructor, creates the directory and starts the writer thread
+         * @param[in] node Pointer to node, the settings record.* apply
+         */
+        explicit RawRecorder(ROSaicNodeBase* node);
+
+        //! Writes the buffered bytes and stops the writer thread
+        ~RawRecorder();
+
+        /**
+         * @brief Adds a channel
+         * @param[in] name Name of the connection, prefix of its file names
+         * @return Channel, valid as long as the recorder
+         */
+        [[nodiscard]] RecordChannel* channel(const std::string& name);
+
+        /**
+         * @brief Writes the buffered bytes, closes the files and stops the writer
+         * thread. Bytes recorded afterwards are ignored.
+         */
+        void close();
+
+        //! Whether the directory could be created and the writer thread runs
+        [[nodiscard]] bool running() const { return writer_.joinable(); }
+
+        [[nodiscard]] const RecorderStatistics& statistics() const
+        {
+            return stats_;
+        }
+
+    private:
+        friend class RecordChannel;
+
+        void run();
+        //! Takes a free buffer, called with the mutex locked
+        [[nodiscard]] std::unique_ptr<RecordChannel::Buffer> takeBuffer();
+        //! Queues a buffer to be written, called with the mutex locked
+        void queue(std::unique_ptr<RecordChannel::Buffer> buffer);
+
+        //! Pointer to the node
+        ROSaicNodeBase* node_;
+        const Settings* settings_;
+        //! Size of the buffers, a multiple of RECORD_ALIGNMENT
+        size_t capacity_;
+        std::vector<std::unique_ptr<RecordChannel>> channels_;
+        //! Guards the buffers and the current buffers of the channels
+        std::mutex mutex_;
+        std::condition_variable queued_;
+        std::vector<std::unique_ptr<RecordChannel::Buffer>> free_;
+        std::deque<std::unique_ptr<RecordChannel::Buffer>> full_;
+        bool closing_ = false;
+        std::thread writer_;
+        RecorderStatistics stats_;
+    };
+} // namespace io
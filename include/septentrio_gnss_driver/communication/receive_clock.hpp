@@ -0,0 +1,150 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#pragma once
+
+// C++
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+
+// Linux
+#include <sys/socket.h>
+
+// ROSaic
+#include <septentrio_gnss_driver/abstraction/typedefs.hpp>
+
+/**
+ * @file receive_clock.hpp
+ * @date 17/10/26
+ * @brief Cheap arrival timestamps of received data
+ */
+
+namespace io {
+
+    //! Period after which the mapping to ROS time is calibrated again
+    static const int64_t CLOCK_CALIBRATION_PERIOD_NS = 1000000000;
+
+    /**
+     * @struct ReceiveClockStatistics
+     * @brief Delay between kernel receive timestamps and the moment user space
+     * handled the data, may be read from any thread
+     */
+    struct ReceiveClockStatistics
+    {
+        //! Number of kernel timestamps
+        std::atomic<uint64_t> count{0};
+        //! Sum of the delays in nanoseconds
+        std::atomic<uint64_t> delaySumNs{0};
+        //! Sum of the squared delays in square microseconds
+        std::atomic<uint64_t> delaySqSumUs2{0};
+        //! Maximum delay in nanoseconds
+        std::atomic<uint64_t> delayMaxNs{0};
+    };
+
+    /**
+     * @class ReceiveClock
+     * @brief Timestamps received data from the monotonic clock
+     *
+     * Calling rclcpp::Node::now() for every read is comparatively expensive. The
+     * clock reads CLOCK_MONOTONIC instead and adds an offset to ROS time, which is
+     * calibrated about once per second. Kernel receive timestamps (CLOCK_REALTIME)
+     * are mapped to ROS time the same way. With simulated time ROS time is used
+     * directly, since it does not advance with the monotonic clock.
+     */
+    class ReceiveClock
+    {
+    public:
+        explicit ReceiveClock(ROSaicNodeBase* node);
+
+        /**
+         * @brief Current time
+         * @return ROS time in nanoseconds
+         */
+        [[nodiscard]] Timestamp now();
+
+        /**
+         * @brief Maps a kernel receive timestamp to ROS time
+         * @param[in] realtime Timestamp of CLOCK_REALTIME
+         * @return ROS time in nanoseconds
+         */
+        [[nodiscard]] Timestamp fromKernel(const timespec& realtime);
+
+        /**
+         * @brief Adds the delay between a kernel timestamp and user space to the
+         * statistics
+         * @param[in] kernelStamp Kernel timestamp mapped to ROS time
+         * @param[in] userStamp Time user space handled the data
+         */
+        void recordKernelDelay(Timestamp kernelStamp, Timestamp userStamp);
+
+        //! Calibrates the offsets to ROS and system time
+        void calibrate();
+
+        [[nodiscard]] const ReceiveClockStatistics& statistics() const
+        {
+            return stats_;
+        }
+
+    private:
+        void calibrateIfDue(int64_t monotonic);
+
+        ROSaicNodeBase* node_;
+        //! ROS time minus monotonic time
+        std::atomic<int64_t> rosOffset_{0};
+        //! System time minus monotonic time
+        std::atomic<int64_t> realtimeOffset_{0};
+        //! Monotonic time of the last calibration
+        std::atomic<int64_t> lastCalibration_{0};
+        std::atomic<bool> simTime_{false};
+        ReceiveClockStatistics stats_;
+    };
+
+    /**
+     * @brief Enables kernel receive timestamps (SO_TIMESTAMPNS) on a socket
+     * @param[in] fd Socket
+     * @return Whether the option was set
+     */
+    [[nodiscard]] bool enableKernelTimestamps(int fd);
+
+    /**
+     * @brief Reads from a socket with recvmsg() without blocking and extracts the
+     * kernel receive timestamp
+     * @param[in] fd Socket
+     * @param[out] data Buffer
+     * @param[in] size Size of the buffer
+     * @param[out] from Address of the sender, may be nullptr
+     * @param[in,out] fromLen Size of from, may be nullptr
+     * @param[out] stamp Kernel timestamp, zero if none was delivered
+     * @return Result of recvmsg()
+     */
+    ssize_t receiveWithTimestamp(int fd, void* data, size_t size, sockaddr* from,
+                                 socklen_t* fromLen, timespec& stamp);
+} // namespace io
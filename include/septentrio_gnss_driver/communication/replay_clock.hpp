@@ -0,0 +1,112 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#pragma once
+
+// C++
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @file replay_clock.hpp
+ * @date 17/10/26
+ * @brief Paces the replay of logs according to the time stamps therein
+ */
+
+namespace io {
+
+    /**
+     * @class ReplayClock
+     * @brief Paces replayed messages at a multiple of the rate they were logged
+     *
+     * The wall time a message is due is computed from the time elapsed in the log
+     * since an anchor, so the pace does not drift if processing falls behind,
+     * instead later messages catch up. Pausing, resuming and changing the rate
+     * move the anchor to the current replay time. All methods may be called from
+     * any thread.
+     */
+    class ReplayClock
+    {
+    public:
+        /**
+         * @brief Constructor
+         * @param[in] rate Multiple of the logged rate, 0 for as fast as possible
+         */
+        explicit ReplayClock(double rate = 1.0);
+
+        void setRate(double rate);
+
+        /**
+         * @brief Waits until a message of the log is due, a message earlier than
+         * the replay time is due at once unless the replay is paused
+         * @param[in] time Log time of the message [ns]
+         * @return Whether the replay time advanced, i.e. time is later than the
+         * one of all previous messages
+         */
+        [[nodiscard]] bool waitUntil(uint64_t time);
+
+        //! Stops the replay before the next later message
+        void pause();
+
+        void resume();
+
+        //! Lets a paused replay advance by a number of distinct log times
+        void step(uint32_t steps = 1);
+
+        [[nodiscard]] bool paused() const;
+
+        //! Releases all waiting threads and stops pacing, e.g. on shutdown
+        void close();
+
+        //! Latest log time replayed [ns]
+        [[nodiscard]] uint64_t time() const;
+
+        //! Number of messages whose log time was earlier than the replay time
+        [[nodiscard]] uint64_t earlierMessages() const;
+
+    private:
+        //! Anchors the schedule at the current replay time, mutex_ must be held
+        void anchor();
+
+        mutable std::mutex mutex_;
+        std::condition_variable changed_;
+        double rate_;
+        bool paused_ = false;
+        bool closed_ = false;
+        uint32_t steps_ = 0;
+        uint64_t time_ = 0;
+        uint64_t earlierMessages_ = 0;
+        //! Log time that is due at anchorWall_
+        uint64_t anchorTime_ = 0;
+        std::chrono::steady_clock::time_point anchorWall_;
+    };
+} // namespace io
@@ -0,0 +1,137 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#pragma once
+
+// C++
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @file rx_configuration.hpp
+ * @date 17/10/26
+ * @brief Differential configuration of the Rx and cache of applied configurations
+ */
+
+namespace io {
+
+    /**
+     * @brief Identifies the setting a command changes
+     *
+     * The key consists of the command name and its first argument, e.g. "sso,
+     * Stream1" or "sao, Main", since a later command with the same key overrides
+     * the earlier one.
+     * @param[in] command Normalized command
+     * @return Key of the command
+     */
+    [[nodiscard]] std::string commandKey(const std::string& command);
+
+    /**
+     * @brief Derives the get commands reading back the settings changed by a
+     * configuration
+     *
+     * Each set command, e.g. "sao, Main, 0, 0, 0", is read back by the get command
+     * of the same name without arguments ("gao"), which outputs all instances of
+     * the setting. Commands which are no set commands are not read back.
+     * @param[in] commands Normalized commands of the configuration
+     * @return Get commands in the order of the first set command of each name
+     */
+    [[nodiscard]] std::vector<std::string>
+    readBackCommands(const std::vector<std::string>& commands);
+
+    //! FNV-1a hash over the normalized commands of a configuration
+    [[nodiscard]] uint64_t
+    configurationHash(const std::vector<std::string>& commands);
+
+    /**
+     * @brief Computes the commands that differ between two configurations
+     *
+     * A delta can only be applied if both configurations change the same settings
+     * in the same order. Otherwise settings of the applied configuration would be
+     * left over and the Rx has to be configured fully.
+     * @param[in] applied Commands applied to the Rx
+     * @param[in] required Commands required by the settings
+     * @param[out] delta Commands of the required configuration which differ
+     * @return Whether the delta suffices to reach the required configuration
+     */
+    [[nodiscard]] bool configurationDelta(const std::vector<std::string>& applied,
+                                          const std::vector<std::string>& required,
+                                          std::vector<std::string>& delta);
+
+    /**
+     * @struct RxConfiguration
+     * @brief Configuration applied to an Rx
+     */
+    struct RxConfiguration
+    {
+        //! Hash of the commands
+        uint64_t hash = 0;
+        //! Normalized commands in the order they were sent
+        std::vector<std::string> commands;
+        //! Output of the get commands read back from the Rx after applying
+        std::vector<std::string> readBack;
+    };
+
+    /**
+     * @class ConfigurationCache
+     * @brief Last configuration applied to each Rx, identified by serial number,
+     * persisted in a text file
+     */
+    class ConfigurationCache
+    {
+    public:
+        explicit ConfigurationCache(const std::string& fileName);
+
+        /**
+         * @brief Reads the cache file
+         * @return False if the file exists but cannot be parsed
+         */
+        [[nodiscard]] bool load();
+
+        /**
+         * @brief Writes the cache file, replacing it atomically
+         * @return Whether the file could be written
+         */
+        [[nodiscard]] bool save() const;
+
+        //! Returns the configuration applied to an Rx, nullptr if unknown
+        [[nodiscard]] const RxConfiguration* find(const std::string& serial) const;
+
+        void store(const std::string& serial, const RxConfiguration& configuration);
+
+        void erase(const std::string& serial);
+
+    private:
+        std::string fileName_;
+        std::map<std::string, RxConfiguration> configurations_;
+    };
+} // namespace io
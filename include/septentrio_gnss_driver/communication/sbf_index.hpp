@@ -0,0 +1,188 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#pragma once
+
+// C++
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @file sbf_index.hpp
+ * @date 17/10/26
+ * @brief Index of the SBF blocks of a log for seeking to a time range
+ */
+
+namespace io {
+
+    //! Suffix of the index stored next to an SBF log
+    static const std::string SBF_INDEX_SUFFIX = ".idx";
+    //! Identifies an index file and its format version
+    static const char SBF_INDEX_MAGIC[8] = {'S', 'B', 'F', 'I', 'D', 'X', '0', '1'};
+    //! Do-not-use values of the SBF time fields
+    static const uint32_t SBF_TOW_DO_NOT_USE = 4294967295u;
+    static const uint16_t SBF_WNC_DO_NOT_USE = 65535u;
+    //! Offset of TOW in an SBF block, WNc follows
+    static const size_t SBF_TIME_OFFSET = 8;
+
+    /**
+     * @struct SbfIndexEntry
+     * @brief Position and time of a valid SBF block in a log
+     */
+    struct SbfIndexEntry
+    {
+        uint64_t offset = 0;
+        //! Block ID including the revision
+        uint16_t id = 0;
+        uint16_t length = 0;
+        //! Time of week [ms]
+        uint32_t tow = SBF_TOW_DO_NOT_USE;
+        //! Week number
+        uint16_t wnc = SBF_WNC_DO_NOT_USE;
+
+        //! Block number without revision
+        [[nodiscard]] uint16_t number() const { return id & 0x1FFF; }
+
+        [[nodiscard]] bool hasTime() const
+        {
+            return (tow != SBF_TOW_DO_NOT_USE) && (wnc != SBF_WNC_DO_NOT_USE);
+        }
+
+        //! Seconds since the GPS epoch
+        [[nodiscard]] double gpsTime() const { return wnc * 604800.0 + tow * 1e-3; }
+    };
+
+    /**
+     * @struct SbfReplayFilter
+     * @brief Part of a log to be replayed
+     */
+    struct SbfReplayFilter
+    {
+        //! First GPS time [s since GPS epoch] to be replayed, 0 for the beginning
+        double start = 0.0;
+        //! Last GPS time [s since GPS epoch] to be replayed, 0 for the end
+        double end = 0.0;
+        //! Numbers of the blocks to be replayed, all blocks and NMEA sentences if
+        //! empty
+        std::vector<uint16_t> blockNumbers;
+
+        //! Whether anything else than the whole log is replayed
+        [[nodiscard]] bool active() const
+        {
+            return (start > 0.0) || (end > 0.0) || !blockNumbers.empty();
+        }
+    };
+
+    //! Byte range [begin, end) of a log
+    struct ByteRange
+    {
+        size_t begin;
+        size_t end;
+    };
+
+    /**
+     * @struct SbfSegment
+     * @brief Part of a log that is processed independently of the other parts
+     */
+    struct SbfSegment
+    {
+        //! Start of the data preceding the segment that is processed to restore
+        //! the state at its start, e.g. the leap seconds, without output
+        size_t warmup;
+        ByteRange range;
+    };
+
+    /**
+     * @brief Indexes all SBF blocks with a valid CRC
+     * @param[in] data Content of the log
+     * @param[in] size Size of the log
+     * @return Index entries in order of the offsets
+     */
+    [[nodiscard]] std::vector<SbfIndexEntry> buildSbfIndex(const uint8_t* data,
+                                                           size_t size);
+
+    //! Path of the index of a log
+    [[nodiscard]] std::string sbfIndexPath(const std::string& log);
+
+    /**
+     * @brief Stores an index
+     * @param[in] path Path of the index
+     * @param[in] logSize Size of the indexed log, identifies a stale index
+     * @param[in] index Index entries
+     * @param[out] error Description of the failure
+     * @return Whether the index was written
+     */
+    [[nodiscard]] bool writeSbfIndex(const std::string& path, uint64_t logSize,
+                                     const std::vector<SbfIndexEntry>& index,
+                                     std::string& error);
+
+    /**
+     * @brief Loads an index
+     * @param[in] path Path of the index
+     * @param[in] logSize Size of the log, the index must have been built for
+     * @param[out] index Index entries
+     * @param[out] error Description of the failure
+     * @return Whether a valid index matching the log was read
+     */
+    [[nodiscard]] bool readSbfIndex(const std::string& path, uint64_t logSize,
+                                    std::vector<SbfIndexEntry>& index,
+                                    std::string& error);
+
+    /**
+     * @brief Selects the byte ranges of a log to be replayed
+     *
+     * Without block numbers the time range is replayed contiguously, i.e.
+     * including blocks without time and NMEA sentences in between. Otherwise, only
+     * the selected blocks within the time range are replayed.
+     *
+     * @param[in] index Index of the log
+     * @param[in] size Size of the log
+     * @param[in] filter Part of the log to be replayed
+     * @return Ranges in order of the offsets, adjacent blocks are merged
+     */
+    [[nodiscard]] std::vector<ByteRange>
+    selectSbfRanges(const std::vector<SbfIndexEntry>& index, size_t size,
+                    const SbfReplayFilter& filter);
+
+    /**
+     * @brief Splits a log into segments of about equal size, each but the first
+     * starting with the first block of an epoch
+     * @param[in] index Index of the log
+     * @param[in] size Size of the log
+     * @param[in] count Number of segments
+     * @param[in] warmup Log time preceding a segment to be processed beforehand [s]
+     * @return Segments covering the log in order, fewer than count if the log has
+     * fewer epochs
+     */
+    [[nodiscard]] std::vector<SbfSegment>
+    splitSbfSegments(const std::vector<SbfIndexEntry>& index, size_t size,
+                     size_t count, double warmup);
+} // namespace io
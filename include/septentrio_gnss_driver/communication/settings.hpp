@@ -119,6 +119,16 @@ namespace device_type {
     };
 } // namespace device_type
 
+struct ThreadSettings
+{
+    //! CPUs the thread may run on, e.g. "2,3" or "2-3", empty for all
+    std::string cpus;
+    //! Scheduling policy: "other", "fifo" or "rr"
+    std::string policy = "other";
+    //! Real-time priority for "fifo" and "rr", 1 to 99
+    int32_t priority = 0;
+};
+
 //! Settings struct
 struct Settings
 {
@@ -138,6 +148,10 @@ struct Settings
     std::string udp_unicast_ip;
     //! UDP IP server id
     std::string udp_ip_server;
+    //! UDP socket receive buffer size in bytes, 0 for the system default
+    uint32_t udp_receive_buffer_size = 0;
+    //! Maximum number of datagrams received per system call
+    uint32_t udp_batch_size = 16;
     //! TCP port
     uint32_t tcp_port;
     //! TCP IP server id
@@ -148,15 +162,111 @@ struct Settings
     std::string login_user;
     //! Password for login
     std::string login_password;
-    //! Delay in seconds between reconnection attempts to the connection type
-    //! specified in the parameter connection_type
-    float reconnect_delay_s;
+    //! Delay in seconds before the first reconnection attempt to the connection
+    //! type specified in the parameter connection_type, doubled for each attempt
+    float reconnect_delay_s = 0.5f;
+    //! Maximum delay in seconds between reconnection attempts
+    float reconnect_max_delay_s = 10.0f;
+    //! Fraction by which the reconnection delays are randomly varied
+    float reconnect_jitter = 0.2f;
+    //! Whether TCP connections are monitored by kernel keep-alive instead of
+    //! writing a blank every second
+    bool tcp_keepalive = true;
+    //! Idle time in seconds of a TCP connection before keep-alive probes are sent
+    uint32_t tcp_keepalive_idle_s = 10;
+    //! Interval in seconds between TCP keep-alive probes
+    uint32_t tcp_keepalive_interval_s = 5;
+    //! Number of unanswered TCP keep-alive probes after which the connection is
+    //! lost
+    uint32_t tcp_keepalive_count = 3;
+    //! Time in milliseconds sent data may remain unacknowledged before the TCP
+    //! connection is lost
+    uint32_t tcp_user_timeout_ms = 30000;
+    //! Number of threads running the I/O of all connections
+    uint32_t io_threads = 1;
+    //! Affinity and scheduling of the I/O threads
+    ThreadSettings io_thread_settings;
+    //! Affinity and scheduling of the processing thread
+    ThreadSettings processing_thread_settings;
+    //! Number of expected data periods without data after which the data
+    //! connection is considered lost, 0 to disable
+    uint32_t silence_periods = 3;
     //! Baudrate
     uint32_t baudrate;
     //! HW flow control
     std::string hw_flow_control;
+    //! Whether to set the baudrate directly and only walk it if the Rx does not
+    //! respond
+    bool serial_fast_bringup = true;
     // Wether to configure Rx
     bool configure_rx;
+    //! File holding the configuration last applied to each Rx, empty to always
+    //! configure fully
+    std::string configuration_cache;
+    //! Whether to read the stream in chunks instead of byte by byte
+    bool bulk_read = true;
+    //! Whether SBF files are memory-mapped and framed in place
+    bool mmap_files = true;
+    //! First GPS time [s since GPS epoch] replayed from an SBF file, 0 for all
+    double replay_start = 0.0;
+    //! Last GPS time [s since GPS epoch] replayed from an SBF file, 0 for all
+    double replay_end = 0.0;
+    //! Numbers of the SBF blocks replayed from a file, empty for all
+    std::vector<uint16_t> replay_block_ids;
+    //! Multiple of the logged rate files are replayed at, 0 for unthrottled
+    double replay_rate = 1.0;
+    //! Whether the replay time is published on /clock
+    bool replay_publish_clock = false;
+    //! IPv4 address of the Rx whose stream is read from a capture, empty for any
+    std::string pcap_rx_ip;
+    //! Port of the Rx whose stream is read from a capture, 0 for any
+    uint32_t pcap_rx_port = 0;
+    //! Directory the bytes received on each connection are recorded to, empty to
+    //! disable recording
+    std::string record_directory;
+    //! Size [MB] after which a new recording file is started, 0 for no limit
+    uint32_t record_max_file_size = 1024;
+    //! Age [s] after which a new recording file is started, 0 for no limit
+    uint32_t record_max_file_duration = 3600;
+    //! Number of recording files kept per connection, 0 to keep all
+    uint32_t record_max_files = 0;
+    //! Size of the recording buffers in bytes
+    uint32_t record_buffer_size = 1048576;
+    //! Number of recording buffers shared by all connections
+    uint32_t record_buffer_count = 16;
+    //! Whether recording files are written with O_DIRECT
+    bool record_direct_io = false;
+    //! Whether the space of a recording file is allocated when opening it
+    bool record_preallocate = true;
+    //! zstd compression level of the recording files, 0 for uncompressed
+    int32_t record_compression_level = 0;
+    //! Directory the flight recorder dumps the recent telegrams to, empty to
+    //! disable the flight recorder
+    std::string flight_recorder_directory;
+    //! Size [MB] of the ring holding the recent telegrams
+    uint32_t flight_recorder_size = 16;
+    //! Time span [s] of the telegrams in a dump
+    double flight_recorder_duration = 30.0;
+    //! Time [s] a dump is written after the anomaly triggering it
+    double flight_recorder_post_trigger = 2.0;
+    //! Anomalies triggering a dump
+    std::vector<std::string> flight_recorder_triggers = {"crc_storm",
+                                                         "pvt_mode_drop",
+                                                         "ins_error"};
+    //! CRC failures per second considered a CRC storm
+    uint32_t flight_recorder_crc_storm = 10;
+    //! Number of recycled telegrams per connection
+    uint32_t telegram_pool_size = 128;
+    //! Number of telegrams the queue to the processing thread can hold
+    uint32_t queue_capacity = 4096;
+    //! What happens to telegrams if the queue is full
+    std::string queue_overflow_policy = "drop_oldest";
+    //! Number of polls before a thread waiting on the queue is parked
+    uint32_t queue_spin_count = 0;
+    //! Whether TCP and UDP data is stamped with kernel receive timestamps
+    bool kernel_timestamps = false;
+    //! Number of commands sent to the Rx without waiting for a response
+    uint32_t command_pipeline_depth = 4;
     //! Datum to be used
     std::string datum;
     //! Polling period for PVT-related SBF blocks
@@ -288,6 +398,8 @@ struct Settings
     bool publish_pose;
     //! Whether or not to publish the DiagnosticArrayMsg message
     bool publish_diagnostics;
+    //! Whether or not to publish the DiagnosticArrayMsg message with I/O statistics
+    bool publish_io_diagnostics;
     //! Whether or not to publish the ImuMsg message
     bool publish_imu;
     //! Whether or not to publish the LocalizationMsg message
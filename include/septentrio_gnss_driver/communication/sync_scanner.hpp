@@ -0,0 +1,75 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#pragma once
+
+// C++
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file sync_scanner.hpp
+ * @date 17/10/26
+ * @brief Search for the sync sequence of SBF blocks and ASCII telegrams
+ *
+ * A sync sequence is the sync byte '$' followed by '@' (SBF), 'G' (NMEA), 'I'
+ * (INS NMEA) or 'R' (response). The search is vectorized with SSE2 or AVX2 where
+ * available, the implementation is selected at runtime.
+ */
+
+namespace io {
+
+    /**
+     * @brief Finds the first sync sequence in a buffer
+     * @param[in] data Pointer to the buffer
+     * @param[in] size Size of the buffer
+     * @return Index of the sync byte of the first sync sequence. A sync byte in the
+     * last position is returned as well since its second byte is not known yet. If
+     * there is no sync sequence, size is returned.
+     */
+    [[nodiscard]] size_t findSync(const uint8_t* data, size_t size);
+
+    //! Scalar implementation of findSync()
+    [[nodiscard]] size_t findSyncScalar(const uint8_t* data, size_t size);
+
+#if defined(__x86_64__) || defined(__i386__)
+    //! SSE2 implementation of findSync()
+    [[nodiscard]] size_t findSyncSse2(const uint8_t* data, size_t size);
+
+    //! AVX2 implementation of findSync(), only to be called if hasAvx2() is true
+    [[nodiscard]] size_t findSyncAvx2(const uint8_t* data, size_t size);
+
+    //! Whether the CPU supports AVX2
+    [[nodiscard]] bool hasAvx2();
+#endif
+
+    //! Name of the implementation selected by findSync()
+    [[nodiscard]] const char* syncScannerName();
+} // namespace io
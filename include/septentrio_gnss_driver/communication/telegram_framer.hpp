@@ -0,0 +1,249 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#pragma once
+
+// C++
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// ROSaic
+#include <septentrio_gnss_driver/communication/raw_recorder.hpp>
+#include <septentrio_gnss_driver/communication/telegram_queue.hpp>
+#include <septentrio_gnss_driver/communication/telegram_pool.hpp>
+
+/**
+ * @file telegram_framer.hpp
+ * @date 17/10/26
+ * @brief Incremental framer that splits a received byte stream into telegrams
+ */
+
+namespace io {
+
+    //! Size of a single bulk read from the stream
+    static const size_t READ_CHUNK_SIZE = 65536;
+    //! Maximum length of an ASCII telegram (NMEA, response, descriptor) before the
+    //! data is considered to be noise
+    static const size_t MAX_STRING_SIZE = 65535;
+
+    /**
+     * @struct FramerStatistics
+     * @brief Counters of the framer, may be read from any thread
+     */
+    struct FramerStatistics
+    {
+        //! Number of bytes fed into the framer
+        std::atomic<uint64_t> bytes{0};
+        //! Number of telegrams handed over to the queue
+        std::atomic<uint64_t> telegrams{0};
+        //! Number of telegrams that spanned more than one chunk
+        std::atomic<uint64_t> reassembled{0};
+        //! Number of SBF blocks that failed the CRC check
+        std::atomic<uint64_t> crcFailures{0};
+        //! Number of bytes discarded while searching for the next telegram
+        std::atomic<uint64_t> discardedBytes{0};
+        //! Number of telegrams which started with a sync sequence but were invalid
+        //! or incomplete, e.g. due to CRC failures or lost data
+        std::atomic<uint64_t> droppedFrames{0};
+    };
+
+    /**
+     * @class TelegramFramer
+     * @brief Splits chunks of a byte stream into SBF, NMEA, response, error and
+     * connection descriptor telegrams
+     *
+     * The framer keeps the unconsumed tail of the stream in a contiguous buffer so
+     * that telegrams spanning several chunks are reassembled. The telegram stream
+     * is identical to the one obtained by reading the stream byte by byte. After
+     * corrupted input the framer skips ahead to the next valid sync sequence
+     * instead of interpreting noise as ASCII telegrams.
+     *
+     * With a resume handler the framer does not wait for space in the queue. It
+     * holds back a refused telegram and pauses: bytes committed meanwhile are
+     * buffered but not framed until the owner calls resume().
+     */
+    class TelegramFramer
+    {
+    public:
+        /**
+         * @brief Constructor
+         * @param[in] telegramQueue Queue complete telegrams are pushed to
+         * @param[in] telegramPool Pool telegrams are taken from
+         */
+        TelegramFramer(TelegramQueue* telegramQueue, TelegramPool* telegramPool);
+
+        //! Receives complete telegrams in stream order
+        typedef std::function<void(std::shared_ptr<Telegram>&& telegram)>
+            TelegramSink;
+
+        /**
+         * @brief Constructor handing telegrams to a callback instead of a queue,
+         * e.g. to process a log without an I/O thread
+         * @param[in] sink Called for every complete telegram
+         * @param[in] telegramPool Pool telegrams are taken from
+         */
+        TelegramFramer(TelegramSink sink, TelegramPool* telegramPool);
+
+        //! Withdraws from waiting for the queue to drain
+        ~TelegramFramer();
+
+        //! Called on the consumer thread with the pause that may end now
+        typedef std::function<void(uint64_t pause)> ResumeHandler;
+
+        /**
+         * @brief Lets the framer pause instead of waiting while the queue is full
+         * @param[in] handler Has to make the owner call resume() on its thread,
+         * nullptr to wait for space again
+         */
+        void setResumeHandler(ResumeHandler handler);
+
+        //! Whether a telegram is held back, reading has to stop until resume()
+        [[nodiscard]] bool paused() const { return paused_; }
+
+        /**
+         * @brief Hands over the held back telegram and frames the bytes buffered
+         * meanwhile
+         * @param[in] pause Pause passed to the resume handler
+         * @return Whether that pause ended, false if it is outdated, e.g. after a
+         * reset, or the framer paused again
+         */
+        bool resume(uint64_t pause);
+
+        /**
+         * @brief Provides writable space at the end of the buffer
+         * @param[in] size Number of bytes to be written
+         * @return Pointer to at least size writable bytes, valid until commit()
+         */
+        [[nodiscard]] uint8_t* prepare(size_t size);
+
+        /**
+         * @brief Frames the bytes previously written to the space obtained from
+         * prepare()
+         * @param[in] size Number of bytes written
+         * @param[in] stamp Receive timestamp of the chunk
+         */
+        void commit(size_t size, Timestamp stamp);
+
+        /**
+         * @brief Copies a chunk into the buffer and frames it
+         * @param[in] data Pointer to the chunk
+         * @param[in] size Size of the chunk
+         * @param[in] stamp Receive timestamp of the chunk
+         */
+        void feed(const uint8_t* data, size_t size, Timestamp stamp);
+
+        /**
+         * @brief Frames telegrams in place from memory that outlives the framer's
+         * use of it, e.g. a memory-mapped file, instead of copying it into the
+         * buffer first. The buffer has to be empty.
+         * @param[in] data Pointer to the bytes
+         * @param[in] size Number of bytes
+         * @param[in] stamp Timestamp of the telegrams
+         * @return Number of bytes consumed, the remaining bytes start an incomplete
+         * telegram or follow a pause and have to be passed again together with the
+         * following bytes
+         */
+        [[nodiscard]] size_t frameInPlace(const uint8_t* data, size_t size,
+                                          Timestamp stamp);
+
+        /**
+         * @brief Records the bytes passed to commit() and feed() before framing
+         * them
+         * @param[in] recorder Channel of the connection, nullptr to stop recording
+         */
+        void setRecorder(RecordChannel* recorder) { recorder_ = recorder; }
+
+        /**
+         * @brief Drops all buffered bytes, e.g. after a reconnect, a pending or
+         * held back telegram counts as dropped
+         */
+        void reset();
+
+        //! Number of buffered bytes that do not form a complete telegram yet
+        [[nodiscard]] size_t pending() const { return writePos_ - readPos_; }
+
+        //! Framer statistics
+        [[nodiscard]] const FramerStatistics& statistics() const { return stats_; }
+
+    private:
+        //! Result of an attempt to frame a telegram at the current position
+        enum class FrameResult
+        {
+            COMPLETE,
+            INCOMPLETE,
+            INVALID
+        };
+
+        void frame(Timestamp stamp);
+        FrameResult frameAt(const uint8_t* data, size_t size, Timestamp stamp,
+                            size_t& consumed);
+        FrameResult frameSbf(const uint8_t* data, size_t size, Timestamp stamp,
+                             size_t& consumed);
+        FrameResult frameString(const uint8_t* data, size_t size,
+                                telegram_type::TelegramType type, Timestamp stamp,
+                                size_t& consumed);
+        void emit(const uint8_t* data, size_t size, telegram_type::TelegramType type,
+                  Timestamp stamp);
+        //! Offers the held back telegram until it is queued or the framer pauses
+        void offerHeld();
+
+        //! TelegramQueue
+        TelegramQueue* telegramQueue_;
+        //! Replaces the queue if set
+        TelegramSink sink_;
+        //! TelegramPool
+        TelegramPool* telegramPool_;
+        //! Records the received bytes if set
+        RecordChannel* recorder_ = nullptr;
+        //! Buffer of the stream, bytes in [readPos_, writePos_) are unconsumed
+        std::vector<uint8_t> buffer_;
+        size_t readPos_ = 0;
+        size_t writePos_ = 0;
+        //! Bytes before this position were received with carriedStamp_
+        size_t carriedEnd_ = 0;
+        Timestamp carriedStamp_ = 0;
+        //! Resume position of the terminator search for ASCII telegrams
+        size_t scanOffset_ = 0;
+        //! Whether the framer is searching for a valid sync sequence
+        bool resyncing_ = false;
+        ResumeHandler resume_;
+        //! Telegram refused by the queue
+        std::shared_ptr<Telegram> held_;
+        bool paused_ = false;
+        //! Number of pauses so far, identifies the current one
+        uint64_t pauses_ = 0;
+        //! Timestamp of the bytes framed when pausing
+        Timestamp pausedStamp_ = 0;
+        //! Statistics
+        FramerStatistics stats_;
+    };
+} // namespace io
@@ -59,10 +59,14 @@
 #pragma once
 
 // C++ includes
+#include <chrono>
 #include <condition_variable>
+#include <string>
+#include <vector>
 
 // ROSaic includes
 #include <septentrio_gnss_driver/abstraction/typedefs.hpp>
+#include <septentrio_gnss_driver/communication/command_pipeline.hpp>
 #include <septentrio_gnss_driver/communication/message_handler.hpp>
 #include <septentrio_gnss_driver/communication/telegram.hpp>
 
@@ -115,13 +119,13 @@ namespace io {
         ~TelegramHandler()
         {
             cdSemaphore_.notify();
-            responseSemaphore_.notify();
+            commands_.clear();
         }
 
         void clearSemaphores()
         {
             cdSemaphore_.notify();
-            responseSemaphore_.notify();
+            commands_.clear();
         }
 
         /**
@@ -139,12 +143,32 @@ namespace io {
             return mainConnectionDescriptor_;
         }
 
-        //! Waits for response
-        void waitForResponse() { responseSemaphore_.wait(); }
+        //! Commands sent to the Rx which await a response
+        [[nodiscard]] CommandPipeline& commands() { return commands_; }
 
         //! Waits for capabilities
         void waitForCapabilities() { capabilitiesSemaphore_.wait(); }
 
+        /**
+         * @brief Waits for a ReceiverSetup block
+         * @param[in] timeout Maximum time to wait
+         * @return Serial number of the Rx, empty if no block arrived in time
+         */
+        [[nodiscard]] std::string
+        waitForRxSerialNumber(std::chrono::milliseconds timeout);
+
+        //! Starts collecting the lines the Rx outputs in response to get commands
+        void startCapture();
+
+        /**
+         * @brief Waits for the prompts ending the output of get commands
+         * @param[in] prompts Number of commands sent since startCapture()
+         * @param[in] timeout Maximum time to wait
+         * @return Lines output by the Rx without surrounding white space
+         */
+        [[nodiscard]] std::vector<std::string>
+        finishCapture(size_t prompts, std::chrono::milliseconds timeout);
+
     private:
         void handleSbf(const std::shared_ptr<Telegram>& telegram);
         void handleNmea(const std::shared_ptr<Telegram>& telegram);
@@ -158,9 +182,17 @@ namespace io {
         MessageHandler messageHandler_;
 
         Semaphore cdSemaphore_;
-        Semaphore responseSemaphore_;
+        CommandPipeline commands_;
         Semaphore capabilitiesSemaphore_;
         std::string mainConnectionDescriptor_ = std::string();
+
+        //! Guards the serial number and the captured output
+        std::mutex captureMutex_;
+        std::condition_variable captureCv_;
+        std::string rxSerialNumber_;
+        bool capturing_ = false;
+        size_t capturedPrompts_ = 0;
+        std::vector<std::string> capturedLines_;
     };
 
 } // namespace io
\ No newline at end of file
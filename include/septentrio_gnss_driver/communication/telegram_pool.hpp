@@ -0,0 +1,123 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#pragma once
+
+// C++
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// ROSaic
+#include <septentrio_gnss_driver/communication/telegram.hpp>
+
+/**
+ * @file telegram_pool.hpp
+ * @date 17/10/26
+ * @brief Pool of recycled telegrams
+ */
+
+namespace io {
+
+    //! Default number of telegrams in a pool
+    static const size_t DEFAULT_TELEGRAM_POOL_SIZE = 128;
+    //! Initial capacity of the message buffer of pooled telegrams, buffers grow up
+    //! to MAX_SBF_SIZE and keep their capacity when recycled
+    static const size_t TELEGRAM_RESERVE = 4096;
+
+    /**
+     * @struct TelegramPoolStatistics
+     * @brief Counters of the pool, may be read from any thread
+     */
+    struct TelegramPoolStatistics
+    {
+        //! Number of telegrams served from the pool
+        std::atomic<uint64_t> hits{0};
+        //! Number of telegrams allocated because the pool was exhausted
+        std::atomic<uint64_t> misses{0};
+        //! Maximum number of pooled telegrams in use at the same time
+        std::atomic<uint64_t> highWaterMark{0};
+    };
+
+    /**
+     * @class TelegramPool
+     * @brief Bounded pool of telegrams with pre-reserved message buffers
+     *
+     * The pool holds a reference to each of its telegrams. A telegram returns to
+     * the pool as soon as all other references, i.e. the ones of the queue and the
+     * processing thread, are dropped. Thus neither the control block nor the
+     * message buffer is allocated per telegram. If all telegrams are in use, a new
+     * one is allocated which is not returned to the pool.
+     *
+     * acquire() may only be called from one thread, the references may be dropped
+     * on any thread.
+     */
+    class TelegramPool
+    {
+    public:
+        /**
+         * @brief Constructor
+         * @param[in] size Number of telegrams in the pool, 0 disables pooling
+         */
+        TelegramPool(size_t size = DEFAULT_TELEGRAM_POOL_SIZE);
+
+        /**
+         * @brief Hands out a free telegram
+         * @param[in] messageSize Size of the message of the telegram
+         * @return Telegram with type EMPTY, stamp 0 and a message of messageSize
+         * bytes
+         */
+        [[nodiscard]] std::shared_ptr<Telegram> acquire(size_t messageSize = 0);
+
+        //! Number of telegrams in the pool
+        [[nodiscard]] size_t size() const { return slots_.size(); }
+
+        //! Pool statistics
+        [[nodiscard]] const TelegramPoolStatistics& statistics() const
+        {
+            return stats_;
+        }
+
+    private:
+        //! Counts the telegrams in use after one was handed out
+        void updateHighWaterMark();
+
+        //! Telegrams of the pool, a use count of one means the telegram is free
+        std::vector<std::shared_ptr<Telegram>> slots_;
+        //! Slot to start searching for a free telegram
+        size_t cursor_ = 0;
+        //! Number of telegrams in use when they were last counted
+        uint64_t inUseAtCount_ = 0;
+        //! Number of telegrams handed out since they were last counted
+        uint64_t acquiredSinceCount_ = 0;
+        //! Statistics
+        TelegramPoolStatistics stats_;
+    };
+} // namespace io
@@ -0,0 +1,305 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#pragma once
+
+// C++
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ROSaic
+#include <septentrio_gnss_driver/communication/bounded_queue.hpp>
+#include <septentrio_gnss_driver/communication/telegram.hpp>
+#include <septentrio_gnss_driver/communication/thread_scheduling.hpp>
+
+/**
+ * @file telegram_queue.hpp
+ * @date 17/10/26
+ * @brief Bounded queue handing telegrams from the I/O threads to the processing
+ * thread
+ */
+
+//! Default number of telegrams each lane of the queue can hold
+static const size_t DEFAULT_TELEGRAM_QUEUE_CAPACITY = 4096;
+
+namespace overflow_policy {
+    //! What happens to a telegram that is pushed into a full lane
+    enum OverflowPolicy
+    {
+        DROP_OLDEST, //!< Oldest queued telegram is discarded
+        DROP_NEWEST, //!< Pushed telegram is discarded
+        BLOCK        //!< Producer waits until there is space
+    };
+} // namespace overflow_policy
+
+namespace telegram_lane {
+    //! Lanes of the queue in order of priority
+    enum TelegramLane
+    {
+        CONTROL,  //!< Command responses and connection descriptors
+        REALTIME, //!< INS navigation, external sensor measurements and events
+        BULK      //!< All other SBF blocks, NMEA sentences and other text
+    };
+} // namespace telegram_lane
+
+//! Number of lanes of the telegram queue
+static const size_t TELEGRAM_LANE_COUNT = 3;
+
+/**
+ * @brief Converts the parameter value to an overflow policy
+ * @param[in] name "drop_oldest", "drop_newest" or "block"
+ * @param[out] policy Overflow policy
+ * @return Whether the name is valid
+ */
+[[nodiscard]] bool parseOverflowPolicy(const std::string& name,
+                                       overflow_policy::OverflowPolicy& policy);
+
+/**
+ * @brief Determines the lane of a telegram from its type and SBF block ID
+ * @param[in] telegram Telegram
+ * @return Lane
+ */
+[[nodiscard]] telegram_lane::TelegramLane classifyTelegram(const Telegram& telegram);
+
+//! Name of a lane as used in diagnostics
+[[nodiscard]] const char* laneName(telegram_lane::TelegramLane lane);
+
+/**
+ * @struct TelegramQueueStatistics
+ * @brief Counters of one lane, may be read from any thread
+ */
+struct TelegramQueueStatistics
+{
+    //! Number of telegrams pushed into the lane
+    std::atomic<uint64_t> pushed{0};
+    //! Number of telegrams taken out by the consumer
+    std::atomic<uint64_t> popped{0};
+    //! Number of telegrams discarded because the lane was full
+    std::atomic<uint64_t> dropped{0};
+    //! Maximum number of queued telegrams
+    std::atomic<uint64_t> highWaterMark{0};
+    //! Sum of the times telegrams spent in the lane in nanoseconds
+    std::atomic<uint64_t> latencySumNs{0};
+    //! Maximum time a telegram spent in the lane in nanoseconds
+    std::atomic<uint64_t> latencyMaxNs{0};
+};
+
+/**
+ * @class TelegramQueue
+ * @brief Bounded lock-free queue of telegrams with priority lanes
+ *
+ * Telegrams are sorted into a control, a real-time and a bulk lane, and the
+ * consumer always empties the lanes in this order. Hence, command responses are
+ * not stuck behind a backlog of SBF blocks while the Rx is configured, and INS
+ * solutions overtake queued measurement and status blocks. A telegram does not
+ * overtake the bulk telegrams it belongs with, though: a response or prompt waits
+ * for the output lines of commands pushed before it, and a real-time block waits
+ * for the bulk blocks of its own epoch. The consumer checks this against the
+ * position in the bulk lane recorded when the telegram was pushed.
+ *
+ * Each lane is a ring: an SPSC ring if a single connection pushes telegrams, an
+ * MPMC ring with several producers (e.g. main connection plus TCP and UDP clients)
+ * or with the drop-oldest policy, where the producer discards telegrams itself.
+ * The control lane never discards telegrams, since a lost response would stall
+ * sending commands. The consumer spins for a configurable number of iterations
+ * before it parks on a condition variable, producers only take the mutex if a
+ * thread is parked. Producers running on the shared I/O threads must not wait
+ * for space: they offer() telegrams instead, stop reading when a telegram is
+ * refused and continue once the consumer has drained the lane to half its
+ * capacity.
+ */
+class TelegramQueue
+{
+public:
+    typedef std::shared_ptr<Telegram> value_type;
+
+    TelegramQueue();
+
+    /**
+     * @brief Sets up the queue, must be called before any producer or consumer uses
+     * it
+     * @param[in] capacity Minimum number of telegrams per lane, rounded up to a
+     * power of two
+     * @param[in] policy What happens when the bulk lane is full
+     * @param[in] multiProducer Whether several threads push telegrams
+     * @param[in] spinCount Number of polls before a waiting thread is parked
+     * @param[in] realtime Whether the real-time lane is used, otherwise its
+     * telegrams keep the order of the log, e.g. when replaying a file
+     */
+    void configure(size_t capacity, overflow_policy::OverflowPolicy policy,
+                   bool multiProducer, uint32_t spinCount, bool realtime = true);
+
+    /**
+     * @brief Pushes a telegram into its lane according to the overflow policy
+     * @param[in] telegram Telegram, which is handed over even if it is discarded
+     * @return Whether the telegram was queued
+     */
+    bool push(value_type&& telegram) noexcept;
+
+    /**
+     * @brief Pushes a telegram like push(), but does not wait if its lane is full
+     * under the block policy
+     * @param[in,out] telegram Telegram, left in place if it was refused
+     * @return False if the telegram was refused, see resumeWhenDrained()
+     */
+    [[nodiscard]] bool offer(value_type& telegram) noexcept;
+
+    /**
+     * @brief Calls a handler once, on the consumer thread, when the lane of a
+     * refused telegram has drained to half its capacity or the queue is closed
+     * @param[in] telegram Telegram refused by offer()
+     * @param[in] producer Identifies the producer for cancel()
+     * @param[in] resume Handler, must not use the queue
+     * @return False if the lane has space already, the telegram is to be offered
+     * again right away and the handler is not called
+     */
+    [[nodiscard]] bool resumeWhenDrained(const Telegram& telegram,
+                                         const void* producer,
+                                         std::function<void()> resume);
+
+    //! Drops the handlers of a producer that have not been called yet
+    void cancel(const void* producer);
+
+    /**
+     * @brief Waits for and pops the next telegram of the highest priority lane
+     * @return False if the queue was closed and is empty
+     */
+    bool pop(value_type& telegram) noexcept;
+
+    /**
+     * @brief Wakes up all waiting threads, afterwards pushes fail and pop()
+     * returns false once the queue is drained
+     */
+    void close() noexcept;
+
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+    //! Number of telegrams in all lanes
+    [[nodiscard]] size_t size() const noexcept;
+    //! Capacity of each lane
+    [[nodiscard]] size_t capacity() const noexcept;
+    [[nodiscard]] overflow_policy::OverflowPolicy policy() const noexcept
+    {
+        return policy_;
+    }
+    [[nodiscard]] const TelegramQueueStatistics&
+    statistics(telegram_lane::TelegramLane lane) const noexcept
+    {
+        return lanes_[lane].stats;
+    }
+    //! Delays from notifying the parked consumer until it runs
+    [[nodiscard]] const io::SchedulingLatency& wakeupLatency() const noexcept
+    {
+        return wakeupLatency_;
+    }
+
+private:
+    //! Queued telegram with the time it was pushed
+    struct Entry
+    {
+        value_type telegram;
+        int64_t enqueuedNs = 0;
+        //! Whether the telegram must not overtake a telegram of the bulk lane
+        bool ordered = false;
+        //! Position in the bulk lane of that telegram, modulo 2^32
+        uint32_t after = 0;
+    };
+
+    struct Lane
+    {
+        std::unique_ptr<io::SpscRing<Entry>> spsc;
+        std::unique_ptr<io::MpmcRing<Entry>> mpmc;
+        overflow_policy::OverflowPolicy policy = overflow_policy::BLOCK;
+        TelegramQueueStatistics stats;
+        //! Number of telegrams handed to the consumer or dropped
+        std::atomic<uint64_t> dequeued{0};
+        //! Head taken out of the ring by the consumer, which has not yet been
+        //! handed over
+        Entry head;
+        std::atomic<bool> holding{false};
+
+        bool tryPush(Entry& entry) noexcept;
+        bool tryPop(Entry& entry) noexcept;
+        //! Takes the head out of the ring, only called by the consumer
+        bool peek() noexcept;
+        [[nodiscard]] size_t size() const noexcept;
+        [[nodiscard]] size_t capacity() const noexcept;
+    };
+
+    //! Producer waiting for a lane to drain
+    struct Resumer
+    {
+        telegram_lane::TelegramLane lane;
+        const void* producer;
+        std::function<void()> resume;
+    };
+
+    //! Pushes a telegram, waits for space only if wait is set
+    bool push(value_type& telegram, bool wait) noexcept;
+    //! Determines the lane of a pushed telegram
+    [[nodiscard]] telegram_lane::TelegramLane laneOf(const Telegram& telegram) const
+        noexcept;
+    //! Pops from the highest priority lane which is not empty
+    bool tryPop(value_type& telegram) noexcept;
+    //! Hands the head of a lane over to the consumer
+    void take(Lane& lane, value_type& telegram) noexcept;
+    //! Wakes up the parked consumer after a push
+    void notifyConsumer() noexcept;
+    //! Wakes up parked producers after a pop
+    void notifyProducers() noexcept;
+
+    Lane lanes_[TELEGRAM_LANE_COUNT];
+    overflow_policy::OverflowPolicy policy_ = overflow_policy::BLOCK;
+    uint32_t spinCount_ = 0;
+    bool realtime_ = true;
+    //! Position in the bulk lane of the last text that is neither a response nor
+    //! NMEA, 0 if none
+    std::atomic<uint32_t> lastText_{0};
+    //! TOW of the last SBF block in the bulk lane in the upper and its position in
+    //! the lower 32 bits, 0 if none
+    std::atomic<uint64_t> lastEpoch_{0};
+
+    std::atomic<bool> closed_{false};
+    std::atomic<bool> consumerWaiting_{false};
+    std::atomic<uint32_t> producersWaiting_{0};
+    std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+    //! Producers to be resumed, counted in producersWaiting_, guarded by mutex_
+    std::vector<Resumer> resumers_;
+    //! Time the parked consumer was notified, guarded by mutex_
+    int64_t notifiedNs_ = 0;
+    io::SchedulingLatency wakeupLatency_;
+};
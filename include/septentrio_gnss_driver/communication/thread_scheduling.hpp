@@ -0,0 +1,116 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#pragma once
+
+// C++
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Linux
+#include <pthread.h>
+#include <sched.h>
+
+/**
+ * @file thread_scheduling.hpp
+ * @date 17/10/26
+ * @brief Names, CPU affinity and real-time scheduling of the driver's threads
+ */
+
+namespace io {
+
+    /**
+     * @struct ThreadScheduling
+     * @brief CPU affinity and scheduling of a thread
+     */
+    struct ThreadScheduling
+    {
+        //! CPUs the thread may run on, empty for all
+        std::vector<int> cpus;
+        //! SCHED_OTHER, SCHED_FIFO or SCHED_RR
+        int policy = SCHED_OTHER;
+        //! Real-time priority for SCHED_FIFO and SCHED_RR, 1 to 99
+        int priority = 0;
+    };
+
+    /**
+     * @struct SchedulingLatency
+     * @brief Delays from waking up a thread until it runs, may be read from any
+     * thread
+     */
+    struct SchedulingLatency
+    {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sumNs{0};
+        std::atomic<uint64_t> maxNs{0};
+
+        //! Adds a delay, only to be called by one thread at a time
+        void record(uint64_t latencyNs)
+        {
+            ++count;
+            sumNs += latencyNs;
+            if (latencyNs > maxNs.load(std::memory_order_relaxed))
+                maxNs.store(latencyNs, std::memory_order_relaxed);
+        }
+    };
+
+    /**
+     * @brief Converts a list of CPUs as used by taskset, e.g. "0,2-3"
+     * @param[in] list List of CPUs
+     * @param[out] cpus Numbers of the CPUs
+     * @return Whether the list is valid
+     */
+    [[nodiscard]] bool parseCpuList(const std::string& list, std::vector<int>& cpus);
+
+    /**
+     * @brief Converts the parameter value to a scheduling policy
+     * @param[in] name "other", "fifo" or "rr"
+     * @param[out] policy SCHED_OTHER, SCHED_FIFO or SCHED_RR
+     * @return Whether the name is valid
+     */
+    [[nodiscard]] bool parseSchedulingPolicy(const std::string& name, int& policy);
+
+    /**
+     * @brief Names a thread and sets its CPU affinity and scheduling
+     *
+     * Real-time policies require CAP_SYS_NICE or a sufficient RLIMIT_RTPRIO. All
+     * settings are tried even if one fails.
+     * @param[in] thread Thread
+     * @param[in] name Name shown by profilers, at most 15 characters
+     * @param[in] scheduling Affinity and scheduling
+     * @param[out] error Description of the settings that failed
+     * @return Whether all settings were applied
+     */
+    [[nodiscard]] bool configureThread(pthread_t thread, const std::string& name,
+                                       const ThreadScheduling& scheduling,
+                                       std::string& error);
+} // namespace io
@@ -0,0 +1,140 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#pragma once
+
+// C++
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @file write_queue.hpp
+ * @date 17/10/26
+ * @brief Outbound queue of a connection with one write in flight at a time
+ */
+
+namespace write_priority {
+    //! Priorities of data sent to the Rx
+    enum WritePriority
+    {
+        REALTIME, //!< VSM velocities and corrections, sent first
+        COMMAND   //!< Configuration commands
+    };
+} // namespace write_priority
+
+namespace io {
+
+    //! Maximum number of queued messages gathered into a single write
+    static const size_t MAX_WRITE_GATHER = 16;
+
+    /**
+     * @struct WriteStatistics
+     * @brief Statistics of a write queue, may be read from any thread
+     */
+    struct WriteStatistics
+    {
+        //! Number of messages written
+        std::atomic<uint64_t> messages{0};
+        //! Number of writes, each gathering one or more messages
+        std::atomic<uint64_t> writes{0};
+        //! Number of messages whose write failed
+        std::atomic<uint64_t> failures{0};
+        std::atomic<uint64_t> bytes{0};
+        //! Maximum number of queued messages
+        std::atomic<uint64_t> maxDepth{0};
+        //! Time from queueing a message until it was written in nanoseconds
+        std::atomic<uint64_t> latencySumNs{0};
+        std::atomic<uint64_t> latencyMaxNs{0};
+    };
+
+    /**
+     * @class WriteQueue
+     * @brief Messages to be sent to the Rx, written one batch at a time
+     *
+     * Messages may be pushed from any thread. The thread performing the writes
+     * starts a write if push() returns true, writes the messages returned by
+     * gather() with a single scatter write and calls complete() once it finished.
+     * If complete() returns true, further messages have been queued in the
+     * meantime and the next batch has to be gathered and written. Messages of
+     * priority REALTIME are gathered before COMMAND messages, messages of the same
+     * priority are written in order.
+     */
+    class WriteQueue
+    {
+    public:
+        /**
+         * @brief Queues a message
+         * @param[in] message Message, moved into the queue
+         * @param[in] priority Priority of the message
+         * @return Whether no write is in flight and one has to be started
+         */
+        [[nodiscard]] bool push(std::string message,
+                                write_priority::WritePriority priority);
+
+        /**
+         * @brief Moves up to MAX_WRITE_GATHER queued messages into the batch to
+         * be written
+         * @return Messages of the batch, valid until complete() is called
+         */
+        [[nodiscard]] const std::vector<std::string>& gather();
+
+        /**
+         * @brief Finishes writing the batch
+         * @param[in] success Whether the batch was written
+         * @return Whether further messages are queued and have to be written
+         */
+        [[nodiscard]] bool complete(bool success);
+
+        //! Number of queued messages, not counting the batch being written
+        [[nodiscard]] size_t depth() const;
+
+        [[nodiscard]] const WriteStatistics& statistics() const { return stats_; }
+
+    private:
+        struct Entry
+        {
+            std::string message;
+            //! Time the message was queued in nanoseconds
+            uint64_t queuedNs;
+        };
+
+        mutable std::mutex mutex_;
+        std::deque<Entry> lanes_[2];
+        //! Batch being written
+        std::vector<std::string> batch_;
+        std::vector<uint64_t> batchQueuedNs_;
+        bool writing_ = false;
+        WriteStatistics stats_;
+    };
+} // namespace io
@@ -67,6 +67,9 @@
 // tf2 includes
 #include <tf2_ros/buffer.h>
 #include <tf2_ros/transform_listener.h>
+// ROS srv includes
+#include <std_srvs/srv/set_bool.hpp>
+#include <std_srvs/srv/trigger.hpp>
 // ROSaic includes
 #include <septentrio_gnss_driver/communication/communication_core.hpp>
 
@@ -87,6 +90,25 @@ namespace rosaic_node {
         //! fine. It loads the user-defined ROS parameters, subscribes to Rx
         //! messages, and publishes requested ROS messages...
         ROSaicNode(const rclcpp::NodeOptions& options);
+        /**
+         * @brief Constructor of a receiver of a multi-receiver node
+         * @param[in] options Node options, e.g. the namespace of the receiver
+         * @param[in] ioPool I/O threads shared by all receivers, have to be stopped
+         * after close() and before destruction
+         */
+        ROSaicNode(const rclcpp::NodeOptions& options,
+                   std::shared_ptr<io::IoContextPool> ioPool);
+        /**
+         * @brief Constructor of a node converting logs offline: The parameters are
+         * read, but the log is not opened and the messages are passed to the sink
+         * instead of being published
+         * @param[in] options Node options, e.g. the log as device parameter
+         * @param[in] sink Receives the messages
+         */
+        ROSaicNode(const rclcpp::NodeOptions& options, MessageSink sink);
+
+        //! Resets the Rx configuration and stops processing
+        void close();
 
     private:
         /**
@@ -124,8 +146,18 @@ namespace rosaic_node {
 
         void sendVelocity(const std::string& velNmea);
 
+        //! Provides the services to pause and step the replay of files
+        void registerReplayServices();
+
         //! Handles communication with the Rx
         io::CommunicationCore IO_;
+        //! Timer for publishing I/O diagnostics
+        rclcpp::TimerBase::SharedPtr ioDiagnosticsTimer_;
+        //! Services controlling the replay of files
+        rclcpp::Service<std_srvs::srv::SetBool>::SharedPtr pauseService_;
+        rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr stepService_;
+        //! Service dumping the flight recorder
+        rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr dumpService_;
         //! tf2 buffer and listener
         tf2_ros::Buffer tfBuffer_;
         std::unique_ptr<tf2_ros::TransformListener> tfListener_;
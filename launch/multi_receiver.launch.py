@@ -0,0 +1,30 @@
+import os
+import launch
+from launch_ros.actions import Node
+from launch.actions import DeclareLaunchArgument
+from launch.substitutions import LaunchConfiguration, TextSubstitution
+from ament_index_python.packages import get_package_share_directory
+
+os.environ['RCUTILS_CONSOLE_OUTPUT_FORMAT'] = '{time}: [{name}] [{severity}]\t{message}'
+
+# Start several receivers in one process:
+
+def generate_launch_description():
+
+    default_file_name = 'multi_receiver.yaml'
+    name_arg_file_name = "file_name"
+    arg_file_name = DeclareLaunchArgument(name_arg_file_name,
+                                          default_value=TextSubstitution(text=str(default_file_name)))
+    name_arg_file_path = 'path_to_config'
+    arg_file_path = DeclareLaunchArgument(name_arg_file_path,
+                                          default_value=[get_package_share_directory('septentrio_gnss_driver'), '/config/', LaunchConfiguration(name_arg_file_name)])
+
+    # No name is given, it would rename the node of each receiver as well
+    node = Node(
+            package='septentrio_gnss_driver',
+            executable='septentrio_gnss_driver_multi_receiver_node',
+            emulate_tty=True,
+            sigterm_timeout = '20',
+            parameters=[LaunchConfiguration(name_arg_file_path)])
+
+    return launch.LaunchDescription([arg_file_name, arg_file_path, node])
@@ -0,0 +1,174 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <septentrio_gnss_driver/communication/command_pipeline.hpp>
+
+// C++
+#include <algorithm>
+
+/**
+ * @file command_pipeline.cpp
+ * @date 17/10/26
+ * @brief Keeps several commands to the Rx in flight and correlates the responses
+ */
+
+namespace io {
+
+    CommandPipeline::CommandPipeline(size_t depth) :
+        depth_(std::max<size_t>(depth, 1))
+    {
+    }
+
+    void CommandPipeline::setDepth(size_t depth)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        depth_ = std::max<size_t>(depth, 1);
+        answered_.notify_all();
+    }
+
+    size_t CommandPipeline::depth() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return depth_;
+    }
+
+    void CommandPipeline::submit(const std::string& command)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        uint64_t generation = generation_;
+        answered_.wait(lock, [this, generation] {
+            return (inFlight_.size() < depth_) || (generation != generation_);
+        });
+        inFlight_.push_back({normalize(command), false});
+        ++submitted_;
+    }
+
+    std::string CommandPipeline::complete(const std::string& response, bool error)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto answered = std::find_if(inFlight_.begin(), inFlight_.end(),
+                                     [](const Command& c) { return !c.answered; });
+        if (answered == inFlight_.end())
+            return std::string();
+
+        if (!error)
+        {
+            std::string text = echo(response);
+            auto match = std::find_if(answered, inFlight_.end(),
+                                      [&text](const Command& c) {
+                                          return !c.answered && (c.text == text);
+                                      });
+            if (match != inFlight_.end())
+                answered = match;
+        }
+        answered->answered = true;
+        if (error)
+            failures_.push_back({answered->text, normalize(response)});
+        return answered->text;
+    }
+
+    void CommandPipeline::prompt()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto prompted = std::find_if(inFlight_.begin(), inFlight_.end(),
+                                     [](const Command& c) { return c.answered; });
+        // E.g. the prompt sent on connecting
+        if (prompted == inFlight_.end())
+            return;
+        inFlight_.erase(prompted);
+        answered_.notify_all();
+    }
+
+    bool CommandPipeline::fail(const std::string& command, const std::string& reason)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::string text = normalize(command);
+        auto failed = std::find_if(inFlight_.begin(), inFlight_.end(),
+                                   [&text](const Command& c) {
+                                       return !c.answered && (c.text == text);
+                                   });
+        // E.g. velocities or the alive check, which are no commands
+        if (failed == inFlight_.end())
+            return false;
+        failures_.push_back({failed->text, reason});
+        inFlight_.erase(failed);
+        answered_.notify_all();
+        return true;
+    }
+
+    void CommandPipeline::flush()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        uint64_t generation = generation_;
+        answered_.wait(lock, [this, generation] {
+            return inFlight_.empty() || (generation != generation_);
+        });
+    }
+
+    void CommandPipeline::clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        inFlight_.clear();
+        ++generation_;
+        answered_.notify_all();
+    }
+
+    std::vector<CommandFailure> CommandPipeline::takeFailures()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<CommandFailure> failures;
+        failures.swap(failures_);
+        return failures;
+    }
+
+    uint64_t CommandPipeline::submitted() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return submitted_;
+    }
+
+    std::string CommandPipeline::echo(const std::string& response)
+    {
+        // Skip "$R:", "$R!" or "$R?"
+        if (response.size() < 3)
+            return std::string();
+        return normalize(response.substr(3));
+    }
+
+    std::string CommandPipeline::normalize(const std::string& command)
+    {
+        const char* whiteSpace = " \t\r\n";
+        size_t begin = command.find_first_not_of(whiteSpace);
+        if (begin == std::string::npos)
+            return std::string();
+        size_t end = command.find_last_not_of(whiteSpace);
+        return command.substr(begin, end - begin + 1);
+    }
+} // namespace io
@@ -58,26 +58,40 @@ static const int8_t POSSTD_DEV_MAX = 100;
 
 namespace io {
 
-    CommunicationCore::CommunicationCore(ROSaicNodeBase* node) :
+    CommunicationCore::CommunicationCore(ROSaicNodeBase* node,
+                                         std::shared_ptr<IoContextPool> ioPool) :
         node_(node), settings_(node->settings()), telegramHandler_(node),
-        running_(true)
+        ioPool_(ioPool), running_(true)
     {
         running_ = true;
-
-        processingThread_ =
-            std::thread(std::bind(&CommunicationCore::processTelegrams, this));
     }
 
-    CommunicationCore::~CommunicationCore()
+    CommunicationCore::~CommunicationCore() { close(); }
+
+    void CommunicationCore::close()
     {
+        if (closed_)
+            return;
+        closed_ = true;
+
         telegramHandler_.clearSemaphores();
 
-        resetSettings();
+        if (manager_)
+            resetSettings();
 
         running_ = false;
-        std::shared_ptr<Telegram> telegram(new Telegram);
-        telegramQueue_.push(telegram);
-        processingThread_.join();
+        telegramQueue_.close();
+        // The processing thread may wait for a paused replay
+        node_->replayClock().close();
+        if (processingThread_.joinable())
+            processingThread_.join();
+        if (flightRecorder_)
+            flightRecorder_->close();
+        // The connections are destroyed after their handlers stopped running
+        if (ownsIoPool_)
+            ioPool_->stop();
+        if (recorder_)
+            recorder_->close();
     }
 
     void CommunicationCore::resetSettings()
@@ -85,6 +99,17 @@ namespace io {
         if (settings_->configure_rx && !settings_->read_from_sbf_log &&
             !settings_->read_from_pcap)
         {
+            // A cached configuration is kept, so that the next start finds it
+            // unchanged and does not have to reapply it
+            if (!settings_->configuration_cache.empty())
+            {
+                if (!settings_->login_user.empty() &&
+                    !settings_->login_password.empty())
+                    send("logout \x0D");
+                flushCommands();
+                return;
+            }
+
             resetMainConnection();
             send("sdio, " + mainConnectionPort_ + ", auto, none\x0D");
             // Turning off all current SBF/NMEA output
@@ -156,6 +181,7 @@ namespace io {
 
             if (!settings_->login_user.empty() && !settings_->login_password.empty())
                 send("logout \x0D");
+            flushCommands();
         }
     }
 
@@ -166,22 +192,63 @@ namespace io {
             log_level::DEBUG,
             "Started timer for calling connect() method until connection succeeds");
 
-        boost::asio::io_service io;
-        boost::posix_time::millisec wait_ms(
-            static_cast<uint32_t>(settings_->reconnect_delay_s * 1000));
-        if (initializeIo())
+        // Settings are only known now, hence the threads are not created earlier
+        if (!ioPool_)
+        {
+            ioPool_ = std::make_shared<IoContextPool>(settings_->io_threads);
+            ownsIoPool_ = true;
+            std::string error;
+            if (!ioPool_->configure(settings_->io_thread_settings, error))
+                node_->log(log_level::WARN, "I/O threads: " + error);
+        }
+        node_->log(log_level::DEBUG, "I/O of all connections runs on " +
+                                         std::to_string(ioPool_->threads()) +
+                                         " thread(s).");
+
+        configureQueue();
+        if (!settings_->flight_recorder_directory.empty())
+            flightRecorder_.reset(new FlightRecorder(node_));
+        processingThread_ =
+            std::thread(std::bind(&CommunicationCore::processTelegrams, this));
+        ThreadScheduling scheduling;
+        std::string error;
+        if (!toThreadScheduling(settings_->processing_thread_settings, scheduling,
+                                error))
+            node_->log(log_level::WARN, "Processing thread: " + error);
+        if (!configureThread(processingThread_.native_handle(), "septentrio_proc",
+                             scheduling, error))
+            node_->log(log_level::WARN, "Processing thread: " + error);
+
+        ReconnectBackoff backoff(settings_->reconnect_delay_s,
+                                 settings_->reconnect_max_delay_s,
+                                 settings_->reconnect_jitter);
+        bool initialized = initializeIo();
+        if (flightRecorder_)
+            flightRecorder_->monitorCrcFailures([this]() {
+                uint64_t failures = 0;
+                if (manager_)
+                    failures += manager_->crcFailures();
+                if (tcpClient_)
+                    failures += tcpClient_->crcFailures();
+                if (udpClient_)
+                    failures += udpClient_->crcFailures();
+                return failures;
+            });
+        if (initialized)
         {
             while (running_)
             {
-                boost::asio::deadline_timer t(io, wait_ms);
-
                 if (manager_->connect())
                 {
                     initializedIo_ = true;
                     break;
                 }
+                // Unreachable receivers of the multi-receiver driver give up on
+                // shutdown
+                if (!rclcpp::ok())
+                    return;
 
-                t.wait();
+                std::this_thread::sleep_for(backoff.next());
             }
         }
 
@@ -201,13 +268,46 @@ namespace io {
                    "Successully connected. Leaving connect() method");
     }
 
+    void CommunicationCore::configureQueue()
+    {
+        overflow_policy::OverflowPolicy policy = overflow_policy::DROP_OLDEST;
+        if (!parseOverflowPolicy(settings_->queue_overflow_policy, policy))
+            node_->log(log_level::WARN, "Unknown io.queue.overflow_policy " +
+                                            settings_->queue_overflow_policy +
+                                            ", dropping oldest telegrams.");
+        // Files are read faster than they are processed, no telegram shall be lost
+        // and the telegrams are paced in the order of the log
+        bool replay = settings_->read_from_sbf_log || settings_->read_from_pcap;
+        if (replay)
+            policy = overflow_policy::BLOCK;
+        // Main connection plus TCP and/or UDP client push into the queue
+        bool multiProducer =
+            ((settings_->tcp_port != 0) && !settings_->tcp_ip_server.empty()) ||
+            ((settings_->udp_port != 0) && !settings_->udp_ip_server.empty());
+        telegramQueue_.configure(settings_->queue_capacity, policy, multiProducer,
+                                 settings_->queue_spin_count, !replay);
+        node_->log(log_level::DEBUG,
+                   "Telegram queue capacity " +
+                       std::to_string(telegramQueue_.capacity()) +
+                       (multiProducer ? ", multiple producers"
+                                      : ", single producer"));
+    }
+
     [[nodiscard]] bool CommunicationCore::initializeIo()
     {
         bool client = false;
         node_->log(log_level::DEBUG, "Called initializeIo() method");
+        if (!settings_->record_directory.empty() && !settings_->read_from_sbf_log &&
+            !settings_->read_from_pcap)
+            recorder_.reset(new RawRecorder(node_));
+        auto recordChannel = [this](const std::string& name) {
+            return recorder_ ? recorder_->channel(name) : nullptr;
+        };
+
         if ((settings_->tcp_port != 0) && (!settings_->tcp_ip_server.empty()))
         {
-            tcpClient_.reset(new AsyncManager<TcpIo>(node_, &telegramQueue_));
+            tcpClient_.reset(new AsyncManager<TcpIo>(
+                node_, &telegramQueue_, ioPool_.get(), recordChannel("tcp")));
             tcpClient_->setPort(std::to_string(settings_->tcp_port));
             if (!settings_->configure_rx)
                 tcpClient_->connect();
@@ -215,8 +315,9 @@ namespace io {
         }
         if ((settings_->udp_port != 0) && (!settings_->udp_ip_server.empty()))
         {
-            udpClient_.reset(
-                new UdpClient(node_, settings_->udp_port, &telegramQueue_));
+            udpClient_.reset(new UdpClient(node_, settings_->udp_port,
+                                           &telegramQueue_, ioPool_.get(),
+                                           recordChannel("udp")));
             client = true;
         }
 
@@ -224,22 +325,26 @@ namespace io {
         {
         case device_type::TCP:
         {
-            manager_.reset(new AsyncManager<TcpIo>(node_, &telegramQueue_));
+            manager_.reset(new AsyncManager<TcpIo>(
+                node_, &telegramQueue_, ioPool_.get(), recordChannel("main")));
             break;
         }
         case device_type::SERIAL:
         {
-            manager_.reset(new AsyncManager<SerialIo>(node_, &telegramQueue_));
+            manager_.reset(new AsyncManager<SerialIo>(
+                node_, &telegramQueue_, ioPool_.get(), recordChannel("main")));
             break;
         }
         case device_type::SBF_FILE:
         {
-            manager_.reset(new AsyncManager<SbfFileIo>(node_, &telegramQueue_));
+            manager_.reset(
+                new AsyncManager<SbfFileIo>(node_, &telegramQueue_, ioPool_.get()));
             break;
         }
         case device_type::PCAP_FILE:
         {
-            manager_.reset(new AsyncManager<PcapFileIo>(node_, &telegramQueue_));
+            manager_.reset(
+                new AsyncManager<PcapFileIo>(node_, &telegramQueue_, ioPool_.get()));
             break;
         }
         default:
@@ -254,6 +359,14 @@ namespace io {
             break;
         }
         }
+        // The Rx never answers a command that could not be sent, which would
+        // block the pipeline for good
+        if (manager_)
+            manager_->setWriteFailureHandler(
+                [this](const std::string& message, const std::string& error) {
+                    telegramHandler_.commands().fail(message,
+                                                     "not sent (" + error + ")");
+                });
         return true;
     }
 
@@ -275,7 +388,12 @@ namespace io {
             return;
         }
 
+        auto start = std::chrono::steady_clock::now();
+        telegramHandler_.commands().setDepth(settings_->command_pipeline_depth);
+        uint64_t commandsBefore = telegramHandler_.commands().submitted();
+
         uint8_t stream = 1;
+        bool vsmInput = false;
         // Determining communication mode: TCP vs USB/Serial
         boost::smatch match;
         boost::regex_match(settings_->device, match,
@@ -290,6 +408,8 @@ namespace io {
             streamPort_ = settings_->tcp_ip_server;
             send("siss, " + streamPort_ + ", " +
                  std::to_string(settings_->tcp_port) + ", TCP, " + "\x0D");
+            // The IP server has to be set up before connecting to it
+            flushCommands();
             tcpClient_->connect();
         } else if ((settings_->udp_port != 0) && (!settings_->udp_ip_server.empty()))
         {
@@ -311,6 +431,8 @@ namespace io {
 
         std::string rest_interval = parsing_utilities::convertUserPeriodToRxCommand(
             settings_->polling_period_rest);
+        // Shortest period of the streams set up below, 0 if all are on change
+        dataPeriod_ = 0;
 
         // Credentials for login
         if (!settings_->login_user.empty() && !settings_->login_password.empty())
@@ -323,14 +445,21 @@ namespace io {
                      settings_->login_password + " \x0D");
         }
 
-        // Turning off all current SBF/NMEA output
-        send("sso, all, none, none, off \x0D");
-        send("sno, all, none, none, off \x0D");
-
         // Get Rx capabilities
         send("grc \x0D");
         telegramHandler_.waitForCapabilities();
 
+        // The configuration is recorded and compared to the one applied before
+        if (!settings_->configuration_cache.empty())
+        {
+            recordedCommands_.clear();
+            recording_ = true;
+        }
+
+        // Turning off all current SBF/NMEA output
+        send("sso, all, none, none, off \x0D");
+        send("sno, all, none, none, off \x0D");
+
         // Activate NTP server
         if (settings_->use_gnss_time)
             send("sntp, on \x0D");
@@ -749,6 +878,7 @@ namespace io {
                << "," << blocks.str() << ", " << rest_interval << "\x0D";
             send(ss.str());
             ++stream;
+            expectDataPeriod(settings_->polling_period_rest);
         }
 
         // send command to trigger emission of receiver setup
@@ -784,6 +914,8 @@ namespace io {
                << "," << blocks.str() << ", " << pvt_interval << "\x0D";
             send(ss.str());
             ++stream;
+            if (!blocks.str().empty())
+                expectDataPeriod(settings_->polling_period_pvt);
         }
 
         // Setting up SBF blocks with rx_period_pvt
@@ -903,6 +1035,8 @@ namespace io {
                << "," << blocks.str() << ", " << pvt_interval << "\x0D";
             send(ss.str());
             ++stream;
+            if (!blocks.str().empty())
+                expectDataPeriod(settings_->polling_period_pvt);
         }
 
         if (settings_->septentrio_receiver_type == "ins")
@@ -928,17 +1062,70 @@ namespace io {
                 std::string s;
                 s = "sdio, " + mainConnectionPort_ + ", NMEA, +NMEA +SBF\x0D";
                 send(s);
-                nmeaActivated_ = true;
+                vsmInput = true;
             }
         }
 
+        size_t failures = 0;
+        if (recording_)
+        {
+            recording_ = false;
+            failures += applyConfiguration();
+        }
+        failures += flushCommands();
+        // Velocities sent before the Rx accepts NMEA input would be answered as
+        // invalid commands
+        nmeaActivated_ = vsmInput;
+        uint64_t commands = telegramHandler_.commands().submitted() - commandsBefore;
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        node_->log(log_level::INFO,
+                   "Configured Rx with " + std::to_string(commands) +
+                       " commands in " + std::to_string(duration.count()) +
+                       " ms (pipeline depth " +
+                       std::to_string(telegramHandler_.commands().depth()) + ", " +
+                       std::to_string(failures) + " failed).");
+        monitorSilence();
+
         node_->log(log_level::DEBUG, "Leaving configureRx() method");
     }
 
+    void CommunicationCore::expectDataPeriod(uint32_t period)
+    {
+        // A period of 0 outputs on change only and sets no data rate
+        if ((period != 0) && ((dataPeriod_ == 0) || (period < dataPeriod_)))
+            dataPeriod_ = period;
+    }
+
+    void CommunicationCore::monitorSilence()
+    {
+        // Without a periodic stream there is no expected data rate
+        if ((settings_->silence_periods == 0) || (dataPeriod_ == 0))
+            return;
+
+        // The data streams are sent to the static TCP server or via UDP if set,
+        // UDP has no connection which could be reestablished
+        AsyncManagerBase* data = nullptr;
+        if (tcpClient_)
+            data = tcpClient_.get();
+        else if (!udpClient_)
+            data = manager_.get();
+        if (!data)
+            return;
+
+        std::chrono::milliseconds timeout(
+            std::max(settings_->silence_periods * dataPeriod_,
+                     MIN_SILENCE_TIMEOUT_MS));
+        data->monitorSilence(timeout);
+        node_->log(log_level::DEBUG, "Reconnecting if no data arrives for " +
+                                         std::to_string(timeout.count()) +
+                                         " ms.");
+    }
+
     void CommunicationCore::sendVelocity(const std::string& velNmea)
     {
         if (nmeaActivated_)
-            manager_.get()->send(velNmea);
+            manager_.get()->send(velNmea, write_priority::REALTIME);
     }
 
     std::string CommunicationCore::resetMainConnection()
@@ -947,32 +1134,188 @@ namespace io {
         // can send our real commands afterwards... has to be sent multiple times.
         std::string cmd("\x0DSSSSSSSSSS\x0D\x0D");
         telegramHandler_.resetWaitforMainCd();
-        manager_.get()->send(cmd);
+        manager_.get()->send(cmd, write_priority::COMMAND);
         std::ignore = telegramHandler_.getMainCd();
         telegramHandler_.resetWaitforMainCd();
-        manager_.get()->send(cmd);
+        manager_.get()->send(cmd, write_priority::COMMAND);
         std::ignore = telegramHandler_.getMainCd();
         telegramHandler_.resetWaitforMainCd();
-        manager_.get()->send(cmd);
+        manager_.get()->send(cmd, write_priority::COMMAND);
         return telegramHandler_.getMainCd();
     }
 
+    void CommunicationCore::publishIoDiagnostics()
+    {
+        DiagnosticStatusMsg status;
+        status.level = DiagnosticStatusMsg::OK;
+        status.name = "septentrio_driver: IO";
+        // Distinguishes the receivers of a multi-receiver node
+        if (std::string(node_->get_namespace()) != "/")
+            status.name += " " + std::string(node_->get_namespace());
+        status.message = "Statistics of the I/O layer";
+        status.hardware_id = settings_->device;
+
+        addDiagnosticValue(status, "telegram queue size", telegramQueue_.size());
+        addDiagnosticValues(status, "", telegramQueue_);
+        if (ioPool_)
+            addDiagnosticValues(status, "", *ioPool_);
+        if (manager_)
+            manager_->appendDiagnostics("main: ", status);
+        if (tcpClient_)
+            tcpClient_->appendDiagnostics("tcp: ", status);
+        if (udpClient_)
+            udpClient_->appendDiagnostics("udp: ", status);
+        if (recorder_)
+            addDiagnosticValues(status, "recorder: ", recorder_->statistics());
+        if (flightRecorder_)
+            addDiagnosticValues(status, "flight recorder: ",
+                                flightRecorder_->statistics());
+
+        DiagnosticArrayMsg msg;
+        msg.header.stamp = timestampToRos(node_->getTime());
+        msg.header.frame_id = settings_->frame_id;
+        msg.status.push_back(status);
+        node_->publishMessage<DiagnosticArrayMsg>("/diagnostics", msg);
+    }
+
     void CommunicationCore::processTelegrams()
     {
         while (running_)
         {
             std::shared_ptr<Telegram> telegram;
-            telegramQueue_.pop(telegram);
+            if (!telegramQueue_.pop(telegram))
+                break;
 
             if (telegram->type != telegram_type::EMPTY)
+            {
+                if (flightRecorder_)
+                    flightRecorder_->add(*telegram);
                 telegramHandler_.handleTelegram(telegram);
+            }
+        }
+    }
+
+    [[nodiscard]] bool CommunicationCore::dumpFlightRecorder(std::string& message)
+    {
+        if (!flightRecorder_)
+        {
+            message = "flight recorder is disabled";
+            return false;
+        }
+        if (!flightRecorder_->trigger("service", std::chrono::nanoseconds(0)))
+        {
+            message = "a dump is already pending";
+            return false;
         }
+        message = "dump scheduled in " + settings_->flight_recorder_directory;
+        return true;
     }
 
     void CommunicationCore::send(const std::string& cmd)
     {
-        manager_.get()->send(cmd);
-        telegramHandler_.waitForResponse();
+        if (recording_)
+        {
+            recordedCommands_.push_back(CommandPipeline::normalize(cmd));
+            return;
+        }
+        telegramHandler_.commands().submit(cmd);
+        manager_.get()->send(cmd, write_priority::COMMAND);
+    }
+
+    size_t CommunicationCore::flushCommands()
+    {
+        telegramHandler_.commands().flush();
+        std::vector<CommandFailure> failures =
+            telegramHandler_.commands().takeFailures();
+        for (const auto& failure : failures)
+            node_->log(log_level::ERROR, "Command \"" + failure.command +
+                                             "\" failed: " + failure.response);
+        return failures.size();
     }
 
-} // namespace io
\ No newline at end of file
+    size_t CommunicationCore::applyConfiguration()
+    {
+        ConfigurationCache cache(settings_->configuration_cache);
+        if (!cache.load())
+            node_->log(log_level::WARN, "Ignoring invalid configuration cache " +
+                                            settings_->configuration_cache);
+
+        RxConfiguration required;
+        required.commands = recordedCommands_;
+        required.hash = configurationHash(required.commands);
+        std::vector<std::string> commands = required.commands;
+
+        std::string serial = rxSerialNumber();
+        if (serial.empty())
+        {
+            node_->log(log_level::WARN, "Rx did not send its serial number, "
+                                        "configuration cache is unavailable.");
+            for (const auto& command : commands)
+                send(command + "\x0D");
+            return flushCommands();
+        }
+
+        const RxConfiguration* applied = cache.find(serial);
+        if (applied)
+        {
+            // A reboot or configuring the Rx by other means changes its settings
+            if (readBackConfiguration(applied->commands) != applied->readBack)
+                node_->log(log_level::INFO, "Settings of Rx " + serial +
+                                                " changed since it was configured.");
+            else if (applied->hash == required.hash)
+                commands.clear();
+            else if (!configurationDelta(applied->commands, required.commands,
+                                         commands))
+                commands = required.commands;
+        }
+        node_->log(log_level::INFO,
+                   "Sending " + std::to_string(commands.size()) + " of " +
+                       std::to_string(required.commands.size()) +
+                       " configuration commands to Rx " + serial + ".");
+
+        for (const auto& command : commands)
+            send(command + "\x0D");
+        size_t failures = flushCommands();
+
+        if (!commands.empty())
+        {
+            if (failures == 0)
+            {
+                required.readBack = readBackConfiguration(required.commands);
+                cache.store(serial, required);
+            } else
+                cache.erase(serial);
+            if (!cache.save())
+                node_->log(log_level::WARN, "Could not write configuration cache " +
+                                                settings_->configuration_cache);
+        }
+        return failures;
+    }
+
+    std::string CommunicationCore::rxSerialNumber()
+    {
+        // Known if the Rx has been streaming ReceiverSetup before
+        std::string serial =
+            telegramHandler_.waitForRxSerialNumber(std::chrono::milliseconds(0));
+        if (serial.empty())
+        {
+            send("esoc, " + mainConnectionPort_ + ", ReceiverSetup\x0D");
+            serial = telegramHandler_.waitForRxSerialNumber(
+                std::chrono::milliseconds(2000));
+        }
+        return serial;
+    }
+
+    std::vector<std::string> CommunicationCore::readBackConfiguration(
+        const std::vector<std::string>& commands)
+    {
+        std::vector<std::string> getters = readBackCommands(commands);
+        flushCommands();
+        telegramHandler_.startCapture();
+        for (const auto& getter : getters)
+            send(getter + "\x0D");
+        flushCommands();
+        return telegramHandler_.finishCapture(
+            getters.size(), std::chrono::milliseconds(1000 * (getters.size() + 1)));
+    }
+} // namespace io
@@ -0,0 +1,150 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <septentrio_gnss_driver/communication/connection_monitor.hpp>
+
+// C++
+#include <algorithm>
+
+// Linux
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+/**
+ * @file connection_monitor.cpp
+ * @date 17/10/26
+ * @brief Backoff between reconnection attempts, detection and statistics of
+ * outages
+ */
+
+namespace io {
+
+    namespace {
+        inline uint64_t steadyNs()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        }
+
+        inline void record(std::atomic<uint64_t>& sum, std::atomic<uint64_t>& max,
+                           uint64_t value)
+        {
+            sum += value;
+            if (value > max.load(std::memory_order_relaxed))
+                max.store(value, std::memory_order_relaxed);
+        }
+    } // namespace
+
+    ReconnectBackoff::ReconnectBackoff(double initialDelay, double maxDelay,
+                                       double jitter) :
+        initial_(static_cast<int64_t>(std::max(initialDelay, 0.0) * 1e9)),
+        max_(static_cast<int64_t>(std::max(maxDelay, initialDelay) * 1e9)),
+        current_(initial_), jitter_(std::clamp(jitter, 0.0, 1.0)),
+        random_(static_cast<uint32_t>(steadyNs()))
+    {
+    }
+
+    std::chrono::nanoseconds ReconnectBackoff::next()
+    {
+        std::uniform_real_distribution<double> variation(-jitter_, jitter_);
+        std::chrono::nanoseconds delay(static_cast<int64_t>(
+            static_cast<double>(current_.count()) * (1.0 + variation(random_))));
+        current_ = std::min(current_ * 2, max_);
+        ++attempts_;
+        return delay;
+    }
+
+    void ReconnectBackoff::reset()
+    {
+        current_ = initial_;
+        attempts_ = 0;
+    }
+
+    bool ConnectionMonitor::dataReceived()
+    {
+        lastDataNs_ = steadyNs();
+        if (!down_)
+            return false;
+
+        down_ = false;
+        lastOutageNs_ = lastDataNs_ - lostNs_;
+        ++stats_.resumed;
+        record(stats_.outageSumNs, stats_.outageMaxNs, lastOutageNs_);
+        if (reconnectedNs_ >= lostNs_)
+            record(stats_.resumeSumNs, stats_.resumeMaxNs,
+                   lastDataNs_ - reconnectedNs_);
+        return true;
+    }
+
+    void ConnectionMonitor::lost()
+    {
+        if (down_)
+            return;
+        down_ = true;
+        lostNs_ = steadyNs();
+        ++stats_.outages;
+        if (lastDataNs_ != 0)
+            record(stats_.detectSumNs, stats_.detectMaxNs, lostNs_ - lastDataNs_);
+    }
+
+    void ConnectionMonitor::attempt() { ++stats_.reconnectAttempts; }
+
+    void ConnectionMonitor::reconnected() { reconnectedNs_ = steadyNs(); }
+
+    void ConnectionMonitor::watch() { watchNs_ = steadyNs(); }
+
+    std::chrono::nanoseconds ConnectionMonitor::silence() const
+    {
+        uint64_t since = std::max({lastDataNs_, reconnectedNs_, watchNs_});
+        return std::chrono::nanoseconds(steadyNs() - since);
+    }
+
+    [[nodiscard]] bool enableTcpKeepalive(int fd, uint32_t idleS, uint32_t intervalS,
+                                          uint32_t count, uint32_t userTimeoutMs)
+    {
+        int enable = 1;
+        int idle = static_cast<int>(idleS);
+        int interval = static_cast<int>(intervalS);
+        int probes = static_cast<int>(count);
+        unsigned int userTimeout = userTimeoutMs;
+        return (setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &enable,
+                           sizeof(enable)) == 0) &&
+               (setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &idle, sizeof(idle)) ==
+                0) &&
+               (setsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &interval,
+                           sizeof(interval)) == 0) &&
+               (setsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT, &probes, sizeof(probes)) ==
+                0) &&
+               (setsockopt(fd, IPPROTO_TCP, TCP_USER_TIMEOUT, &userTimeout,
+                           sizeof(userTimeout)) == 0);
+    }
+} // namespace io
@@ -0,0 +1,132 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+// C++
+#include <cstring>
+
+// ROSaic
+#include <septentrio_gnss_driver/communication/datagram_batch.hpp>
+
+/**
+ * @file datagram_batch.cpp
+ * @date 17/10/26
+ * @brief Receives several datagrams per system call
+ */
+
+namespace io {
+
+    namespace {
+        //! Room for a timestamp and the drop counter
+        const size_t CONTROL_SIZE =
+            CMSG_SPACE(sizeof(timespec)) + CMSG_SPACE(sizeof(uint32_t));
+    } // namespace
+
+    DatagramBatch::DatagramBatch(size_t count, size_t datagramSize) :
+        datagramSize_(datagramSize), buffer_(count * datagramSize), headers_(count),
+        iovecs_(count), senders_(count), stamps_(count), drops_(count),
+        hasDrops_(count), control_(count * CONTROL_SIZE)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            iovecs_[i].iov_base = &buffer_[i * datagramSize_];
+            iovecs_[i].iov_len = datagramSize_;
+        }
+    }
+
+    int DatagramBatch::receive(int fd)
+    {
+        // recvmmsg() overwrites the lengths, so the headers are reset each time
+        for (size_t i = 0; i < headers_.size(); ++i)
+        {
+            msghdr& header = headers_[i].msg_hdr;
+            header.msg_name = &senders_[i];
+            header.msg_namelen = sizeof(sockaddr_storage);
+            header.msg_iov = &iovecs_[i];
+            header.msg_iovlen = 1;
+            header.msg_control = &control_[i * CONTROL_SIZE];
+            header.msg_controllen = CONTROL_SIZE;
+            header.msg_flags = 0;
+            headers_[i].msg_len = 0;
+        }
+
+        int count = recvmmsg(fd, headers_.data(), headers_.size(), MSG_DONTWAIT,
+                             nullptr);
+        for (int i = 0; i < count; ++i)
+        {
+            msghdr& header = headers_[i].msg_hdr;
+            stamps_[i] = timespec{0, 0};
+            hasDrops_[i] = false;
+            for (cmsghdr* cmsg = CMSG_FIRSTHDR(&header); cmsg != nullptr;
+                 cmsg = CMSG_NXTHDR(&header, cmsg))
+            {
+                if (cmsg->cmsg_level != SOL_SOCKET)
+                    continue;
+                if (cmsg->cmsg_type == SCM_TIMESTAMPNS)
+                {
+                    std::memcpy(&stamps_[i], CMSG_DATA(cmsg), sizeof(timespec));
+                } else if (cmsg->cmsg_type == SO_RXQ_OVFL)
+                {
+                    std::memcpy(&drops_[i], CMSG_DATA(cmsg), sizeof(uint32_t));
+                    hasDrops_[i] = true;
+                }
+            }
+        }
+        return count;
+    }
+
+    [[nodiscard]] bool DatagramBatch::drops(size_t i, uint32_t& drops) const
+    {
+        drops = drops_[i];
+        return hasDrops_[i];
+    }
+
+    [[nodiscard]] size_t setReceiveBufferSize(int fd, size_t size)
+    {
+        int requested = static_cast<int>(size);
+        // SO_RCVBUFFORCE ignores rmem_max but requires CAP_NET_ADMIN
+        if (setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &requested,
+                       sizeof(requested)) != 0)
+            setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &requested, sizeof(requested));
+
+        int granted = 0;
+        socklen_t length = sizeof(granted);
+        if (getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &granted, &length) != 0)
+            return 0;
+        // The kernel doubles the value for its bookkeeping overhead
+        return static_cast<size_t>(granted) / 2;
+    }
+
+    [[nodiscard]] bool enableDropCounter(int fd)
+    {
+        int enable = 1;
+        return setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable)) ==
+               0;
+    }
+} // namespace io
@@ -0,0 +1,332 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <septentrio_gnss_driver/communication/flight_recorder.hpp>
+#include <septentrio_gnss_driver/communication/raw_recorder.hpp>
+#include <septentrio_gnss_driver/parsers/parsing_utilities.hpp>
+
+/**
+ * @file flight_recorder.cpp
+ * @date 17/10/26
+ * @brief Ring of the most recent telegrams, dumped to an SBF file on anomalies
+ */
+
+namespace io {
+
+    namespace {
+        //! Average telegram size the number of entries of the ring is based on
+        const size_t AVERAGE_TELEGRAM_SIZE = 16;
+
+        /**
+         * @brief Ranks the quality of a PVT mode, higher is better
+         * @param[in] mode Type of PVT solution, the lower 4 bits of the Mode field
+         */
+        int pvtModeRank(uint8_t mode)
+        {
+            switch (mode)
+            {
+            case 0: // No PVT available
+                return 0;
+            case 1: // Stand-Alone PVT
+            case 3: // Fixed location
+                return 1;
+            case 6: // PPP
+                return 2;
+            case 2: // Differential PVT
+                return 3;
+            case 10: // SBAS aided PVT
+                return 4;
+            case 5: // RTK with float ambiguities
+            case 8: // Moving-base RTK with float ambiguities
+                return 5;
+            case 4: // RTK with fixed ambiguities
+            case 7: // Moving-base RTK with fixed ambiguities
+                return 6;
+            default:
+                return 1;
+            }
+        }
+
+        //! Delay of dumps after an anomaly
+        std::chrono::nanoseconds postTrigger(const Settings* settings)
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::duration<double>(
+                    settings->flight_recorder_post_trigger));
+        }
+    } // namespace
+
+    FlightRecorder::FlightRecorder(ROSaicNodeBase* node) :
+        node_(node), settings_(node->settings())
+    {
+        for (const auto& trigger : settings_->flight_recorder_triggers)
+        {
+            if (trigger == "crc_storm")
+                triggerCrcStorm_ = true;
+            else if (trigger == "pvt_mode_drop")
+                triggerPvtModeDrop_ = true;
+            else if (trigger == "ins_error")
+                triggerInsError_ = true;
+        }
+
+        size_t size = static_cast<size_t>(settings_->flight_recorder_size) * 1024 *
+                      1024;
+        ring_.resize(size);
+        snapshot_.resize(size);
+        entries_.resize(std::max<size_t>(1, size / AVERAGE_TELEGRAM_SIZE));
+
+        thread_ = std::thread(std::bind(&FlightRecorder::run, this));
+    }
+
+    FlightRecorder::~FlightRecorder() { close(); }
+
+    void FlightRecorder::monitorCrcFailures(CrcFailureCounter crcFailures)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        crcFailures_ = crcFailures;
+    }
+
+    void FlightRecorder::add(const Telegram& telegram)
+    {
+        const size_t size = telegram.message.size();
+        if ((telegram.type == telegram_type::EMPTY) || (size == 0))
+            return;
+        if (size > ring_.size())
+        {
+            ++stats_.skippedTelegrams;
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (writePos_ + size > ring_.size())
+            {
+                // Telegrams behind the write position are the oldest ones
+                while ((entryCount_ > 0) &&
+                       (entries_[firstEntry_].offset >= writePos_))
+                {
+                    firstEntry_ = (firstEntry_ + 1) % entries_.size();
+                    --entryCount_;
+                }
+                writePos_ = 0;
+            }
+            while ((entryCount_ > 0) &&
+                   ((entryCount_ == entries_.size()) ||
+                    ((entries_[firstEntry_].offset < writePos_ + size) &&
+                     (entries_[firstEntry_].offset + entries_[firstEntry_].size >
+                      writePos_))))
+            {
+                firstEntry_ = (firstEntry_ + 1) % entries_.size();
+                --entryCount_;
+            }
+
+            std::copy(telegram.message.begin(), telegram.message.end(),
+                      ring_.begin() + writePos_);
+            entries_[(firstEntry_ + entryCount_) % entries_.size()] = {
+                writePos_, size, telegram.stamp};
+            ++entryCount_;
+            writePos_ += size;
+        }
+
+        if ((telegram.type == telegram_type::SBF) &&
+            (telegram.message.size() > 15))
+            checkBlock(telegram.message);
+    }
+
+    bool FlightRecorder::trigger(const std::string& reason,
+                                 std::chrono::nanoseconds delay)
+    {
+        ++stats_.triggers;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closing_ || pending_)
+                return false;
+            pending_ = true;
+            pendingReason_ = reason;
+            dumpAt_ = std::chrono::steady_clock::now() + delay;
+        }
+        changed_.notify_one();
+        node_->log(log_level::INFO, "Flight recorder triggered by " + reason);
+        return true;
+    }
+
+    void FlightRecorder::close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closing_ = true;
+        }
+        changed_.notify_one();
+        if (thread_.joinable())
+            thread_.join();
+    }
+
+    void FlightRecorder::checkBlock(const std::vector<uint8_t>& message)
+    {
+        const uint16_t id = parsing_utilities::getId(message);
+        if ((id == 4006) || (id == 4007)) // PVTCartesian, PVTGeodetic
+        {
+            int rank = pvtModeRank(message[14] & 0x0F);
+            bool drop = (rank < pvtRank_);
+            pvtRank_ = rank;
+            if (drop && triggerPvtModeDrop_)
+                static_cast<void>(trigger("pvt_mode_drop", postTrigger(settings_)));
+        } else if ((id == 4225) || (id == 4226)) // INSNavCart, INSNavGeod
+        {
+            bool error = (message[15] != 0);
+            bool raised = error && !insError_;
+            insError_ = error;
+            if (raised && triggerInsError_)
+                static_cast<void>(trigger("ins_error", postTrigger(settings_)));
+        }
+    }
+
+    void FlightRecorder::run()
+    {
+        auto nextCheck =
+            std::chrono::steady_clock::now() + FLIGHT_RECORDER_CHECK_INTERVAL;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            auto now = std::chrono::steady_clock::now();
+            if (pending_ && (closing_ || (now >= dumpAt_)))
+            {
+                snapshot();
+                std::string reason = pendingReason_;
+                pending_ = false;
+                lock.unlock();
+                writeDump(reason);
+                lock.lock();
+                continue;
+            }
+            if (closing_)
+                break;
+            if (now >= nextCheck)
+            {
+                nextCheck = now + FLIGHT_RECORDER_CHECK_INTERVAL;
+                lock.unlock();
+                checkCrcFailures();
+                lock.lock();
+                continue;
+            }
+            changed_.wait_until(lock,
+                                pending_ ? std::min(dumpAt_, nextCheck) : nextCheck);
+        }
+    }
+
+    void FlightRecorder::checkCrcFailures()
+    {
+        CrcFailureCounter crcFailures;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            crcFailures = crcFailures_;
+        }
+        if (!crcFailures)
+            return;
+
+        uint64_t failures = crcFailures();
+        bool storm = crcCounted_ && (settings_->flight_recorder_crc_storm > 0) &&
+                     (failures - lastCrcFailures_ >=
+                      settings_->flight_recorder_crc_storm);
+        if (storm && !crcStorm_ && triggerCrcStorm_)
+            static_cast<void>(trigger("crc_storm", postTrigger(settings_)));
+        crcStorm_ = storm;
+        lastCrcFailures_ = failures;
+        crcCounted_ = true;
+    }
+
+    void FlightRecorder::snapshot()
+    {
+        snapshotTelegrams_ = 0;
+        snapshot_.clear();
+        if (entryCount_ == 0)
+            return;
+
+        const Timestamp newest =
+            entries_[(firstEntry_ + entryCount_ - 1) % entries_.size()].stamp;
+        const Timestamp duration = static_cast<Timestamp>(
+            settings_->flight_recorder_duration * 1000000000.0);
+        const Timestamp cutoff = (newest > duration) ? (newest - duration) : 0;
+        for (size_t i = 0; i < entryCount_; ++i)
+        {
+            const Entry& entry = entries_[(firstEntry_ + i) % entries_.size()];
+            if (entry.stamp < cutoff)
+                continue;
+            snapshot_.insert(snapshot_.end(), ring_.begin() + entry.offset,
+                             ring_.begin() + entry.offset + entry.size);
+            ++snapshotTelegrams_;
+        }
+    }
+
+    void FlightRecorder::writeDump(const std::string& reason)
+    {
+        if (snapshotTelegrams_ == 0)
+        {
+            node_->log(log_level::WARN,
+                       "Flight recorder: no telegrams to dump after " + reason);
+            return;
+        }
+
+        std::stringstream name;
+        name << "flight_" << utcFileTime() << "_" << std::setw(4)
+             << std::setfill('0') << dumpCount_++ << "_" << reason << ".sbf";
+        const std::filesystem::path path =
+            std::filesystem::path(settings_->flight_recorder_directory) /
+            name.str();
+
+        std::error_code error;
+        std::filesystem::create_directories(settings_->flight_recorder_directory,
+                                            error);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (file)
+            file.write(reinterpret_cast<const char*>(snapshot_.data()),
+                       snapshot_.size());
+        file.close();
+        if (!file)
+        {
+            ++stats_.failedDumps;
+            node_->log(log_level::ERROR,
+                       "Flight recorder: could not write " + path.string());
+            return;
+        }
+        ++stats_.dumps;
+        node_->log(log_level::INFO, "Flight recorder: dumped " +
+                                        std::to_string(snapshotTelegrams_) +
+                                        " telegrams after " + reason + " to " +
+                                        path.string());
+    }
+} // namespace io
@@ -0,0 +1,209 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <septentrio_gnss_driver/communication/io_context_pool.hpp>
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+// Linux
+#include <pthread.h>
+#include <sys/resource.h>
+
+/**
+ * @file io_context_pool.cpp
+ * @date 17/10/26
+ * @brief Threads running the I/O of all connections
+ */
+
+namespace io {
+
+    namespace {
+        inline double clockSeconds(clockid_t clock)
+        {
+            timespec time;
+            if (clock_gettime(clock, &time) != 0)
+                return 0.0;
+            return time.tv_sec + time.tv_nsec * 1e-9;
+        }
+
+        //! Index of the pool thread running the caller
+        thread_local size_t currentThread = 0;
+    } // namespace
+
+    IoContextPool::IoContextPool(size_t threads) :
+        work_(new boost::asio::io_service::work(ioService_))
+    {
+        threads = std::max<size_t>(threads, 1);
+        for (size_t i = 0; i < threads; ++i)
+        {
+            probeTimers_.emplace_back(new boost::asio::steady_timer(ioService_));
+            latencies_.emplace_back(new SchedulingLatency());
+            scheduleProbe(i);
+        }
+        for (size_t i = 0; i < threads; ++i)
+        {
+            threads_.emplace_back([this, i]() {
+                currentThread = i;
+                ioService_.run();
+            });
+            clockid_t clock;
+            if (pthread_getcpuclockid(threads_.back().native_handle(), &clock) ==
+                0)
+                clocks_.push_back(clock);
+        }
+    }
+
+    IoContextPool::~IoContextPool() { stop(); }
+
+    IoExecutor IoContextPool::makeStrand()
+    {
+        return boost::asio::make_strand(ioService_.get_executor());
+    }
+
+    bool IoContextPool::configure(const ThreadSettings& settings,
+                                  std::string& error)
+    {
+        // The valid parameters are applied anyway
+        ThreadScheduling scheduling;
+        bool valid = toThreadScheduling(settings, scheduling, error);
+        for (size_t i = 0; i < threads_.size(); ++i)
+        {
+            std::string threadError;
+            if (!configureThread(threads_[i].native_handle(), threadName(i),
+                                 scheduling, threadError) &&
+                error.empty())
+                error = threadError;
+        }
+        return valid && error.empty();
+    }
+
+    std::string IoContextPool::threadName(size_t thread)
+    {
+        return "septentrio_io" + std::to_string(thread);
+    }
+
+    void IoContextPool::scheduleProbe(size_t probe)
+    {
+        boost::asio::steady_timer& timer = *probeTimers_[probe];
+        timer.expires_after(std::chrono::milliseconds(SCHEDULING_PROBE_INTERVAL_MS));
+        timer.async_wait([this, probe](const boost::system::error_code& ec) {
+            if (ec)
+                return;
+            boost::asio::steady_timer& timer = *probeTimers_[probe];
+            auto delay = std::chrono::steady_clock::now() - timer.expiry();
+            // Recorded for the thread that was late, whichever probe it ran
+            latencies_[currentThread]->record(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(delay).count());
+            scheduleProbe(probe);
+        });
+    }
+
+    void IoContextPool::stop()
+    {
+        if (!work_)
+            return;
+
+        {
+            // The clocks are invalid once the threads exited
+            std::lock_guard<std::mutex> lock(clocksMutex_);
+            for (clockid_t clock : clocks_)
+                stoppedCpuTime_ += clockSeconds(clock);
+            clocks_.clear();
+        }
+        work_.reset();
+        ioService_.stop();
+        for (std::thread& thread : threads_)
+            thread.join();
+    }
+
+    double IoContextPool::cpuTime() const
+    {
+        std::lock_guard<std::mutex> lock(clocksMutex_);
+        double seconds = stoppedCpuTime_;
+        for (clockid_t clock : clocks_)
+            seconds += clockSeconds(clock);
+        return seconds;
+    }
+
+    bool toThreadScheduling(const ThreadSettings& settings,
+                            ThreadScheduling& scheduling, std::string& error)
+    {
+        error.clear();
+        scheduling = ThreadScheduling();
+        if (!parseCpuList(settings.cpus, scheduling.cpus))
+        {
+            scheduling.cpus.clear();
+            error = "invalid CPU list \"" + settings.cpus + "\"";
+        }
+        if (!parseSchedulingPolicy(settings.policy, scheduling.policy))
+        {
+            scheduling.policy = SCHED_OTHER;
+            if (!error.empty())
+                error += ", ";
+            error += "invalid scheduling policy \"" + settings.policy + "\"";
+        }
+        scheduling.priority = settings.priority;
+        return error.empty();
+    }
+
+    size_t processThreadCount()
+    {
+        // Field 20 of /proc/self/stat, the name in field 2 is in parentheses
+        // and may contain blanks
+        std::ifstream file("/proc/self/stat");
+        std::string stat((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+        size_t pos = stat.rfind(')');
+        if (pos == std::string::npos)
+            return 0;
+        std::istringstream fields(stat.substr(pos + 1));
+        std::string field;
+        for (int i = 3; (i < 20) && (fields >> field); ++i)
+            ;
+        size_t threads = 0;
+        fields >> threads;
+        return threads;
+    }
+
+    double processCpuTime()
+    {
+        rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0.0;
+        return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+               (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+    }
+} // namespace io
@@ -0,0 +1,99 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include <septentrio_gnss_driver/communication/mapped_file.hpp>
+
+/**
+ * @file mapped_file.cpp
+ * @date 17/10/26
+ * @brief Read-only memory mapping of a file
+ */
+
+namespace io {
+
+    [[nodiscard]] bool MappedFile::open(const std::string& path, std::string& error)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1)
+        {
+            error = "open " + path + " failed: " + std::strerror(errno);
+            return false;
+        }
+        bool mapped = map(fd, error);
+        ::close(fd);
+        if (!mapped && error.empty())
+            error = path + " is no non-empty regular file";
+        return mapped;
+    }
+
+    [[nodiscard]] bool MappedFile::map(int fd, std::string& error)
+    {
+        close();
+        error.clear();
+
+        struct stat status;
+        if (fstat(fd, &status) != 0)
+        {
+            error = std::string("fstat failed: ") + std::strerror(errno);
+            return false;
+        }
+        if (!S_ISREG(status.st_mode) || (status.st_size == 0))
+            return false;
+
+        void* data = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            error = std::string("mmap failed: ") + std::strerror(errno);
+            return false;
+        }
+        // The file is processed front to back, so aggressive read-ahead pays off
+        madvise(data, status.st_size, MADV_SEQUENTIAL);
+        data_ = static_cast<const uint8_t*>(data);
+        size_ = status.st_size;
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (!data_)
+            return;
+        munmap(const_cast<uint8_t*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+} // namespace io
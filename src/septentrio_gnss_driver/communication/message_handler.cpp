@@ -2737,17 +2737,25 @@ namespace io {
 
     void MessageHandler::wait(Timestamp time_obj)
     {
-        Timestamp unix_old = unix_time_;
-        unix_time_ = time_obj;
-        if ((unix_old != 0) && (unix_time_ > unix_old))
+        // When reading from a file, the ROS publishing frequency is governed by
+        // the time stamps found in the file
+        uint64_t earlierMessages = node_->replayClock().earlierMessages();
+        if (!node_->replayClock().waitUntil(time_obj))
         {
-            auto sleep_nsec = unix_time_ - unix_old;
-
-            std::stringstream ss;
-            ss << "Waiting for " << sleep_nsec / 1000000 << " milliseconds...";
-            node_->log(log_level::DEBUG, ss.str());
+            if (node_->replayClock().earlierMessages() > earlierMessages)
+                node_->log(log_level::DEBUG,
+                           "Replayed message at " + std::to_string(time_obj) +
+                               " ns is earlier than the replay time " +
+                               std::to_string(node_->replayClock().time()) +
+                               " ns.");
+            return;
+        }
 
-            std::this_thread::sleep_for(std::chrono::nanoseconds(sleep_nsec));
+        if (settings_->replay_publish_clock)
+        {
+            ClockMsg msg;
+            msg.clock = timestampToRos(time_obj);
+            node_->publishMessage<ClockMsg>("/clock", msg);
         }
     }
 
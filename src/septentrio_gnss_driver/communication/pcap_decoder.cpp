@@ -0,0 +1,405 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <arpa/inet.h>
+
+#include <algorithm>
+
+#include <septentrio_gnss_driver/communication/pcap_decoder.hpp>
+#include <septentrio_gnss_driver/communication/sync_scanner.hpp>
+
+/**
+ * @file pcap_decoder.cpp
+ * @date 17/10/26
+ * @brief Extracts the byte stream of the Rx from the packets of a capture
+ */
+
+namespace io {
+
+    namespace {
+        const uint16_t ETHERTYPE_IPV4 = 0x0800;
+        const uint16_t ETHERTYPE_VLAN = 0x8100;
+        const uint16_t ETHERTYPE_QINQ = 0x88A8;
+        const size_t ETHERNET_HEADER_SIZE = 14;
+        const size_t VLAN_TAG_SIZE = 4;
+        const size_t SLL_HEADER_SIZE = 16;
+        const size_t SLL2_HEADER_SIZE = 20;
+        const size_t LOOPBACK_HEADER_SIZE = 4;
+        const size_t IPV4_HEADER_SIZE = 20;
+        const size_t TCP_HEADER_SIZE = 20;
+        const size_t UDP_HEADER_SIZE = 8;
+        const uint8_t PROTOCOL_TCP = 6;
+        const uint8_t PROTOCOL_UDP = 17;
+        const uint8_t TCP_SYN = 0x02;
+
+        //! Reads a big-endian 16 bit value
+        uint16_t read16(const uint8_t* data)
+        {
+            return static_cast<uint16_t>((data[0] << 8) | data[1]);
+        }
+
+        //! Reads a big-endian 32 bit value
+        uint32_t read32(const uint8_t* data)
+        {
+            return (static_cast<uint32_t>(data[0]) << 24) |
+                   (static_cast<uint32_t>(data[1]) << 16) |
+                   (static_cast<uint32_t>(data[2]) << 8) |
+                   static_cast<uint32_t>(data[3]);
+        }
+
+        std::string endpoint(uint32_t address, uint16_t port)
+        {
+            return std::to_string(address >> 24) + "." +
+                   std::to_string((address >> 16) & 0xFF) + "." +
+                   std::to_string((address >> 8) & 0xFF) + "." +
+                   std::to_string(address & 0xFF) + ":" + std::to_string(port);
+        }
+
+        //! Whether a payload contains the sync sequence of a telegram
+        bool containsSync(const uint8_t* data, size_t size)
+        {
+            return findSync(data, size) + 1 < size;
+        }
+    } // namespace
+
+    bool PcapDecoder::Flow::operator==(const Flow& other) const
+    {
+        return (protocol == other.protocol) && (srcAddress == other.srcAddress) &&
+               (dstAddress == other.dstAddress) && (srcPort == other.srcPort) &&
+               (dstPort == other.dstPort);
+    }
+
+    PcapDecoder::PcapDecoder() {}
+
+    bool PcapDecoder::reset(int linkType, uint32_t address, uint16_t port)
+    {
+        linkType_ = linkType;
+        address_ = address;
+        port_ = port;
+        locked_ = false;
+        flow_ = Flow();
+        synced_ = false;
+        pending_.clear();
+        pendingBytes_ = 0;
+
+        switch (linkType)
+        {
+        case link_type::NULL_LOOPBACK:
+        case link_type::ETHERNET:
+        case link_type::RAW:
+        case link_type::RAW_OPENBSD:
+        case link_type::LINKTYPE_RAW:
+        case link_type::LOOP:
+        case link_type::LINUX_SLL:
+        case link_type::IPV4:
+        case link_type::LINUX_SLL2:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    size_t PcapDecoder::ipv4Offset(const uint8_t* frame, size_t size) const
+    {
+        size_t offset = 0;
+        switch (linkType_)
+        {
+        case link_type::ETHERNET:
+        {
+            if (size < ETHERNET_HEADER_SIZE)
+                return size;
+            offset = ETHERNET_HEADER_SIZE - 2;
+            uint16_t etherType = read16(frame + offset);
+            while (((etherType == ETHERTYPE_VLAN) ||
+                    (etherType == ETHERTYPE_QINQ)) &&
+                   (offset + VLAN_TAG_SIZE + 2 <= size))
+            {
+                offset += VLAN_TAG_SIZE;
+                etherType = read16(frame + offset);
+            }
+            if (etherType != ETHERTYPE_IPV4)
+                return size;
+            offset += 2;
+            break;
+        }
+        case link_type::LINUX_SLL:
+            if ((size < SLL_HEADER_SIZE) ||
+                (read16(frame + SLL_HEADER_SIZE - 2) != ETHERTYPE_IPV4))
+                return size;
+            offset = SLL_HEADER_SIZE;
+            break;
+        case link_type::LINUX_SLL2:
+            if ((size < SLL2_HEADER_SIZE) || (read16(frame) != ETHERTYPE_IPV4))
+                return size;
+            offset = SLL2_HEADER_SIZE;
+            break;
+        case link_type::NULL_LOOPBACK:
+        case link_type::LOOP:
+            // The address family is in host or network byte order, the IP version
+            // is checked instead
+            offset = LOOPBACK_HEADER_SIZE;
+            break;
+        default:
+            break;
+        }
+        if ((offset + IPV4_HEADER_SIZE > size) || ((frame[offset] >> 4) != 4))
+            return size;
+        return offset;
+    }
+
+    bool PcapDecoder::matchesRx(const Flow& flow) const
+    {
+        return ((address_ == 0) || (flow.srcAddress == address_)) &&
+               ((port_ == 0) || (flow.srcPort == port_));
+    }
+
+    void PcapDecoder::decode(const uint8_t* frame, size_t size,
+                             const PayloadSink& sink)
+    {
+        ++stats_.packets;
+
+        size_t offset = ipv4Offset(frame, size);
+        if (offset == size)
+        {
+            ++stats_.skippedPackets;
+            return;
+        }
+        const uint8_t* ip = frame + offset;
+        size_t headerSize = (ip[0] & 0x0F) * 4;
+        // Ethernet pads short frames, the IP header knows the actual size
+        size_t ipSize = std::min<size_t>(read16(ip + 2), size - offset);
+        if ((headerSize < IPV4_HEADER_SIZE) || (headerSize > ipSize))
+        {
+            ++stats_.skippedPackets;
+            return;
+        }
+        // More fragments flag or fragment offset
+        if ((read16(ip + 6) & 0x3FFF) != 0)
+        {
+            ++stats_.fragments;
+            ++stats_.skippedPackets;
+            return;
+        }
+
+        Flow flow;
+        flow.protocol = ip[9];
+        flow.srcAddress = read32(ip + 12);
+        flow.dstAddress = read32(ip + 16);
+        const uint8_t* transport = ip + headerSize;
+        size_t transportSize = ipSize - headerSize;
+        size_t payloadOffset;
+        if ((flow.protocol == PROTOCOL_TCP) && (transportSize >= TCP_HEADER_SIZE))
+            payloadOffset = (transport[12] >> 4) * 4;
+        else if ((flow.protocol == PROTOCOL_UDP) &&
+                 (transportSize >= UDP_HEADER_SIZE))
+            payloadOffset = UDP_HEADER_SIZE;
+        else
+        {
+            ++stats_.skippedPackets;
+            return;
+        }
+        if (payloadOffset > transportSize)
+        {
+            ++stats_.skippedPackets;
+            return;
+        }
+        flow.srcPort = read16(transport);
+        flow.dstPort = read16(transport + 2);
+
+        if (!locked_ || !(flow == flow_))
+        {
+            bool newConnection = locked_ && (flow.protocol == PROTOCOL_TCP) &&
+                                 (flow.protocol == flow_.protocol) &&
+                                 (transport[13] & TCP_SYN) && matchesRx(flow);
+            bool first = !locked_ && matchesRx(flow) &&
+                         containsSync(transport + payloadOffset,
+                                      transportSize - payloadOffset);
+            if (!newConnection && !first)
+            {
+                ++stats_.skippedPackets;
+                return;
+            }
+            locked_ = true;
+            flow_ = flow;
+            synced_ = false;
+            // Data of the previous connection is not continued by the new one
+            pending_.clear();
+            pendingBytes_ = 0;
+            if (flow.protocol == PROTOCOL_TCP)
+                ++stats_.connections;
+        }
+
+        if (flow.protocol == PROTOCOL_TCP)
+            decodeTcp(transport, transportSize, sink);
+        else if (transportSize > payloadOffset)
+        {
+            stats_.bytes += transportSize - payloadOffset;
+            sink(transport + payloadOffset, transportSize - payloadOffset);
+        }
+    }
+
+    void PcapDecoder::decodeTcp(const uint8_t* segment, size_t size,
+                                const PayloadSink& sink)
+    {
+        uint32_t seq = read32(segment + 4);
+        size_t payloadOffset = (segment[12] >> 4) * 4;
+        const uint8_t* payload = segment + payloadOffset;
+        size_t payloadSize = size - payloadOffset;
+
+        if (segment[13] & TCP_SYN)
+        {
+            // The SYN occupies one sequence number
+            synced_ = true;
+            nextSeq_ = seq + 1;
+            pending_.clear();
+            pendingBytes_ = 0;
+            return;
+        }
+        if (payloadSize == 0)
+            return;
+        if (!synced_)
+        {
+            // The capture started after the connection was established
+            synced_ = true;
+            nextSeq_ = seq;
+        }
+
+        int32_t ahead = static_cast<int32_t>(seq - nextSeq_);
+        if (ahead <= 0)
+        {
+            size_t behind = static_cast<size_t>(-static_cast<int64_t>(ahead));
+            if (behind >= payloadSize)
+            {
+                stats_.duplicateBytes += payloadSize;
+                return;
+            }
+            stats_.duplicateBytes += behind;
+            deliver(payload + behind, payloadSize - behind, sink);
+            drainPending(sink);
+            return;
+        }
+
+        ++stats_.outOfOrderSegments;
+        auto& buffered = pending_[seq];
+        if (buffered.size() < payloadSize)
+        {
+            pendingBytes_ += payloadSize - buffered.size();
+            buffered.assign(payload, payload + payloadSize);
+        }
+        while (pendingBytes_ > MAX_PENDING_TCP_BYTES)
+            skipGap(sink);
+    }
+
+    void PcapDecoder::deliver(const uint8_t* data, size_t size,
+                              const PayloadSink& sink)
+    {
+        nextSeq_ += static_cast<uint32_t>(size);
+        stats_.bytes += size;
+        sink(data, size);
+    }
+
+    void PcapDecoder::drainPending(const PayloadSink& sink)
+    {
+        bool progress = true;
+        while (progress && !pending_.empty())
+        {
+            progress = false;
+            // Sequence numbers wrap around, so the order of the map is not the
+            // order of the stream
+            for (auto it = pending_.begin(); it != pending_.end();)
+            {
+                int32_t ahead = static_cast<int32_t>(it->first - nextSeq_);
+                if (ahead > 0)
+                {
+                    ++it;
+                    continue;
+                }
+                size_t behind = static_cast<size_t>(-static_cast<int64_t>(ahead));
+                const std::vector<uint8_t>& segment = it->second;
+                if (behind < segment.size())
+                {
+                    stats_.duplicateBytes += behind;
+                    deliver(segment.data() + behind, segment.size() - behind, sink);
+                    progress = true;
+                } else
+                    stats_.duplicateBytes += segment.size();
+                pendingBytes_ -= segment.size();
+                it = pending_.erase(it);
+            }
+        }
+    }
+
+    void PcapDecoder::skipGap(const PayloadSink& sink)
+    {
+        auto earliest = pending_.end();
+        uint32_t gap = 0;
+        for (auto it = pending_.begin(); it != pending_.end(); ++it)
+        {
+            uint32_t ahead = it->first - nextSeq_;
+            if ((earliest == pending_.end()) || (ahead < gap))
+            {
+                earliest = it;
+                gap = ahead;
+            }
+        }
+        if (earliest == pending_.end())
+            return;
+        stats_.lostBytes += gap;
+        nextSeq_ = earliest->first;
+        drainPending(sink);
+    }
+
+    void PcapDecoder::flush(const PayloadSink& sink)
+    {
+        while (!pending_.empty())
+            skipGap(sink);
+    }
+
+    std::string PcapDecoder::streamName() const
+    {
+        if (!locked_)
+            return "none";
+        return std::string(flow_.protocol == PROTOCOL_TCP ? "TCP " : "UDP ") +
+               endpoint(flow_.srcAddress, flow_.srcPort) + " -> " +
+               endpoint(flow_.dstAddress, flow_.dstPort);
+    }
+
+    bool parseRxAddress(const std::string& ip, uint32_t& address)
+    {
+        address = 0;
+        if (ip.empty())
+            return true;
+        in_addr parsed;
+        if (inet_pton(AF_INET, ip.c_str(), &parsed) != 1)
+            return false;
+        address = ntohl(parsed.s_addr);
+        return true;
+    }
+} // namespace io
@@ -0,0 +1,615 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include <septentrio_gnss_driver/communication/raw_recorder.hpp>
+#include <septentrio_gnss_driver/communication/thread_scheduling.hpp>
+
+/**
+ * @file raw_recorder.cpp
+ * @date 17/10/26
+ * @brief Records the bytes received on each connection into rotating files
+ */
+
+namespace io {
+
+    namespace {
+        inline uint64_t steadyNs()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        }
+
+        inline size_t alignUp(size_t size)
+        {
+            return (size + RECORD_ALIGNMENT - 1) / RECORD_ALIGNMENT *
+                   RECORD_ALIGNMENT;
+        }
+    } // namespace
+
+    [[nodiscard]] std::string utcFileTime()
+    {
+        std::time_t now = std::time(nullptr);
+        std::tm utc;
+        gmtime_r(&now, &utc);
+        char buffer[16];
+        std::strftime(buffer, sizeof(buffer), "%Y%m%d_%H%M%S", &utc);
+        return buffer;
+    }
+
+    struct RecordChannel::Buffer
+    {
+        //! Capacity has to be a multiple of RECORD_ALIGNMENT
+        explicit Buffer(size_t capacity) :
+            data(static_cast<uint8_t*>(
+                std::aligned_alloc(RECORD_ALIGNMENT, capacity))),
+            capacity(capacity)
+        {
+        }
+
+        ~Buffer() { std::free(data); }
+
+        uint8_t* data;
+        size_t capacity;
+        size_t size = 0;
+        //! Channel the bytes were received on
+        RecordChannel* channel = nullptr;
+    };
+
+    /**
+     * @class RecordChannel::File
+     * @brief File being recorded to, only used by the writer thread
+     */
+    class RecordChannel::File
+    {
+    public:
+        /**
+         * @brief Constructor
+         * @param[in] stats Statistics the writes are accounted for in
+         * @param[in] capacity Size of the buffer staging aligned writes
+         */
+        File(RecorderStatistics& stats, size_t capacity) :
+            stats_(stats), capacity_(capacity)
+        {
+        }
+
+        ~File()
+        {
+            std::string error;
+            static_cast<void>(close(error));
+        }
+
+        /**
+         * @brief Creates the file
+         * @param[in] path Path of the file
+         * @param[in] settings Settings record.*
+         * @param[out] error Description of the failure
+         * @return Whether the file was created
+         */
+        [[nodiscard]] bool open(const std::string& path, const Settings& settings,
+                                std::string& error)
+        {
+            direct_ = settings.record_direct_io;
+            int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+            if (direct_)
+                flags |= O_DIRECT;
+            fd_ = ::open(path.c_str(), flags, 0644);
+            if (fd_ == -1)
+            {
+                error = "open " + path + " failed: " + std::strerror(errno);
+                if (direct_ && (errno == EINVAL))
+                    error += ", the file system does not support record.direct_io";
+                return false;
+            }
+            openedNs_ = steadyNs();
+
+            // Keeps the file contiguous, the space not written is released by
+            // close()
+            uint64_t maxSize = static_cast<uint64_t>(settings.record_max_file_size) *
+                               1000000;
+            preallocated_ =
+                settings.record_preallocate && (maxSize > 0) &&
+                (fallocate(fd_, FALLOC_FL_KEEP_SIZE, 0, maxSize) == 0);
+
+            if (direct_)
+                staging_.reset(new Buffer(capacity_));
+#ifdef HAVE_ZSTD
+            if (settings.record_compression_level > 0)
+            {
+                cctx_ = ZSTD_createCCtx();
+                ZSTD_CCtx_setParameter(cctx_, ZSTD_c_compressionLevel,
+                                       settings.record_compression_level);
+                compressed_.resize(ZSTD_CStreamOutSize());
+            }
+#endif
+            return true;
+        }
+
+        /**
+         * @brief Appends bytes to the file
+         * @param[in] data Pointer to the bytes
+         * @param[in] size Number of bytes
+         * @param[out] error Description of the failure
+         * @return Whether the bytes were written or staged
+         */
+        [[nodiscard]] bool write(const uint8_t* data, size_t size,
+                                 std::string& error)
+        {
+#ifdef HAVE_ZSTD
+            if (cctx_)
+                return compress(data, size, ZSTD_e_continue, error);
+#endif
+            return append(data, size, error);
+        }
+
+        /**
+         * @brief Completes the compressed block so that the file can be
+         * decompressed up to the bytes written so far
+         * @param[out] error Description of the failure
+         * @return Whether flushing succeeded
+         */
+        [[nodiscard]] bool flush(std::string& error)
+        {
+#ifdef HAVE_ZSTD
+            if (cctx_)
+                return compress(nullptr, 0, ZSTD_e_flush, error);
+#endif
+            static_cast<void>(error);
+            return true;
+        }
+
+        /**
+         * @brief Writes the staged bytes and closes the file
+         * @param[out] error Description of the failure
+         * @return Whether all bytes were written
+         */
+        [[nodiscard]] bool close(std::string& error)
+        {
+            if (fd_ == -1)
+                return true;
+
+            bool ok = true;
+#ifdef HAVE_ZSTD
+            if (cctx_)
+            {
+                ok = compress(nullptr, 0, ZSTD_e_end, error);
+                ZSTD_freeCCtx(cctx_);
+                cctx_ = nullptr;
+            }
+#endif
+            // O_DIRECT writes whole blocks, the padding is truncated
+            if (ok && direct_ && (staged_ > 0))
+            {
+                size_t padded = alignUp(staged_);
+                std::memset(staging_->data + staged_, 0, padded - staged_);
+                ok = writeOut(staging_->data, padded, error);
+                staged_ = 0;
+            }
+            if ((direct_ || preallocated_) && (ftruncate(fd_, size_) != 0) && ok)
+            {
+                error = std::string("truncating failed: ") + std::strerror(errno);
+                ok = false;
+            }
+            ::close(fd_);
+            fd_ = -1;
+            return ok;
+        }
+
+        //! Number of bytes written to the file
+        [[nodiscard]] uint64_t size() const { return size_; }
+
+        //! Time since the file was opened in nanoseconds
+        [[nodiscard]] uint64_t ageNs() const { return steadyNs() - openedNs_; }
+
+    private:
+#ifdef HAVE_ZSTD
+        [[nodiscard]] bool compress(const uint8_t* data, size_t size,
+                                    ZSTD_EndDirective mode, std::string& error)
+        {
+            ZSTD_inBuffer input = {data, size, 0};
+            bool finished;
+            do
+            {
+                ZSTD_outBuffer output = {compressed_.data(), compressed_.size(), 0};
+                size_t remaining =
+                    ZSTD_compressStream2(cctx_, &output, &input, mode);
+                if (ZSTD_isError(remaining))
+                {
+                    error = std::string("compression failed: ") +
+                            ZSTD_getErrorName(remaining);
+                    return false;
+                }
+                if (!append(compressed_.data(), output.pos, error))
+                    return false;
+                finished = (mode == ZSTD_e_continue) ? (input.pos == input.size)
+                                                     : (remaining == 0);
+            } while (!finished);
+            return true;
+        }
+#endif
+
+        //! Writes bytes, with O_DIRECT in whole aligned blocks
+        [[nodiscard]] bool append(const uint8_t* data, size_t size,
+                                  std::string& error)
+        {
+            size_ += size;
+            stats_.bytesWritten += size;
+            if (!direct_)
+                return writeOut(data, size, error);
+
+            // Full aligned buffers are written as they are
+            if ((staged_ == 0) && (size % RECORD_ALIGNMENT == 0) &&
+                (reinterpret_cast<uintptr_t>(data) % RECORD_ALIGNMENT == 0))
+                return writeOut(data, size, error);
+
+            while (size > 0)
+            {
+                size_t count = std::min(size, capacity_ - staged_);
+                std::memcpy(staging_->data + staged_, data, count);
+                staged_ += count;
+                data += count;
+                size -= count;
+                if (staged_ == capacity_)
+                {
+                    staged_ = 0;
+                    if (!writeOut(staging_->data, capacity_, error))
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        [[nodiscard]] bool writeOut(const uint8_t* data, size_t size,
+                                    std::string& error)
+        {
+            uint64_t start = steadyNs();
+            while (size > 0)
+            {
+                ssize_t written = ::write(fd_, data, size);
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    error = std::string("write failed: ") + std::strerror(errno);
+                    return false;
+                }
+                data += written;
+                size -= written;
+            }
+            uint64_t latency = steadyNs() - start;
+            ++stats_.writes;
+            stats_.latencySumNs += latency;
+            if (latency > stats_.latencyMaxNs.load(std::memory_order_relaxed))
+                stats_.latencyMaxNs.store(latency, std::memory_order_relaxed);
+            return true;
+        }
+
+        RecorderStatistics& stats_;
+        size_t capacity_;
+        int fd_ = -1;
+        bool direct_ = false;
+        bool preallocated_ = false;
+        //! Number of bytes written to the file, without padding
+        uint64_t size_ = 0;
+        uint64_t openedNs_ = 0;
+        //! Aligned bytes not written yet with O_DIRECT
+        std::unique_ptr<Buffer> staging_;
+        size_t staged_ = 0;
+#ifdef HAVE_ZSTD
+        ZSTD_CCtx* cctx_ = nullptr;
+        std::vector<uint8_t> compressed_;
+#endif
+    };
+
+    RecordChannel::RecordChannel(RawRecorder* recorder, const std::string& name) :
+        recorder_(recorder), name_(name)
+    {
+    }
+
+    RecordChannel::~RecordChannel() {}
+
+    void RecordChannel::record(const uint8_t* data, size_t size)
+    {
+        RawRecorder& recorder = *recorder_;
+        recorder.stats_.bytes += size;
+
+        std::unique_lock<std::mutex> lock(recorder.mutex_);
+        if (recorder.closing_)
+            return;
+        while (size > 0)
+        {
+            if (!current_)
+            {
+                current_ = recorder.takeBuffer();
+                if (!current_)
+                {
+                    ++recorder.stats_.droppedChunks;
+                    recorder.stats_.droppedBytes += size;
+                    bool warn = !dropping_;
+                    dropping_ = true;
+                    lock.unlock();
+                    if (warn)
+                        recorder.node_->log(
+                            log_level::WARN,
+                            "Raw recorder is behind, dropping bytes of " + name_ +
+                                ", consider increasing record.buffer_count.");
+                    return;
+                }
+                current_->channel = this;
+                dropping_ = false;
+            }
+
+            size_t count = std::min(size, current_->capacity - current_->size);
+            std::memcpy(current_->data + current_->size, data, count);
+            current_->size += count;
+            data += count;
+            size -= count;
+            if (current_->size == current_->capacity)
+                recorder.queue(std::move(current_));
+        }
+    }
+
+    void RecordChannel::write(const Buffer& buffer)
+    {
+        const Settings& settings = *recorder_->settings_;
+        RecorderStatistics& stats = recorder_->stats_;
+
+        uint64_t maxSize = static_cast<uint64_t>(settings.record_max_file_size) *
+                           1000000;
+        uint64_t maxAgeNs =
+            static_cast<uint64_t>(settings.record_max_file_duration) * 1000000000;
+        if (file_ && (((maxSize > 0) && (file_->size() >= maxSize)) ||
+                      ((maxAgeNs > 0) && (file_->ageNs() >= maxAgeNs))))
+            closeFile();
+        if (!file_ && !rotate())
+        {
+            ++stats.failedBuffers;
+            return;
+        }
+
+        std::string error;
+        // Buffers written before they are full are flushed by a timer, their
+        // bytes shall be readable from the file
+        if (!file_->write(buffer.data, buffer.size, error) ||
+            ((buffer.size < buffer.capacity) && !file_->flush(error)))
+        {
+            ++stats.failedBuffers;
+            if (!failing_)
+                recorder_->node_->log(log_level::ERROR,
+                                      "Raw recorder of " + name_ + ": " + error);
+            failing_ = true;
+            // The next buffer starts a new file
+            closeFile();
+            return;
+        }
+        failing_ = false;
+    }
+
+    [[nodiscard]] bool RecordChannel::rotate()
+    {
+        const Settings& settings = *recorder_->settings_;
+
+        std::ostringstream name;
+        name << name_ << "_" << utcFileTime() << "_" << std::setw(4)
+             << std::setfill('0') << sequence_ << ".sbf";
+#ifdef HAVE_ZSTD
+        if (settings.record_compression_level > 0)
+            name << ".zst";
+#endif
+        std::string path =
+            (std::filesystem::path(settings.record_directory) / name.str()).string();
+
+        std::string error;
+        file_.reset(new File(recorder_->stats_, recorder_->capacity_));
+        if (!file_->open(path, settings, error))
+        {
+            if (!failing_)
+                recorder_->node_->log(log_level::ERROR,
+                                      "Raw recorder of " + name_ + ": " + error);
+            failing_ = true;
+            file_.reset();
+            return false;
+        }
+        ++sequence_;
+        ++recorder_->stats_.files;
+        recorder_->node_->log(log_level::DEBUG,
+                              "Raw recorder writes " + name_ + " to " + path);
+
+        paths_.push_back(path);
+        if (settings.record_max_files > 0)
+        {
+            while (paths_.size() > settings.record_max_files)
+            {
+                std::remove(paths_.front().c_str());
+                paths_.pop_front();
+            }
+        }
+        return true;
+    }
+
+    void RecordChannel::closeFile()
+    {
+        if (!file_)
+            return;
+        std::string error;
+        if (!file_->close(error))
+        {
+            ++recorder_->stats_.failedBuffers;
+            recorder_->node_->log(log_level::ERROR,
+                                  "Raw recorder of " + name_ + ": " + error);
+        }
+        file_.reset();
+    }
+
+    RawRecorder::RawRecorder(ROSaicNodeBase* node) :
+        node_(node), settings_(node->settings()),
+        capacity_(alignUp(std::max<size_t>(settings_->record_buffer_size, 1)))
+    {
+        size_t count = std::max<uint32_t>(settings_->record_buffer_count, 2);
+        for (size_t i = 0; i < count; ++i)
+            free_.emplace_back(new RecordChannel::Buffer(capacity_));
+
+        std::error_code ec;
+        std::filesystem::create_directories(settings_->record_directory, ec);
+        if (ec)
+        {
+            node_->log(log_level::ERROR, "Raw recorder cannot create directory " +
+                                             settings_->record_directory + ": " +
+                                             ec.message());
+            closing_ = true;
+            return;
+        }
+#ifndef HAVE_ZSTD
+        if (settings_->record_compression_level > 0)
+            node_->log(log_level::WARN, "Raw recorder was built without zstd, "
+                                        "recording uncompressed.");
+#endif
+
+        writer_ = std::thread(&RawRecorder::run, this);
+        std::string error;
+        if (!configureThread(writer_.native_handle(), "septentrio_rec",
+                             ThreadScheduling(), error))
+            node_->log(log_level::WARN, "Raw recorder thread: " + error);
+        node_->log(log_level::INFO,
+                   "Recording the received bytes to " +
+                       settings_->record_directory + " with " +
+                       std::to_string(count) + " buffers of " +
+                       std::to_string(capacity_) + " bytes.");
+    }
+
+    RawRecorder::~RawRecorder() { close(); }
+
+    [[nodiscard]] RecordChannel* RawRecorder::channel(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        channels_.emplace_back(new RecordChannel(this, name));
+        return channels_.back().get();
+    }
+
+    void RawRecorder::close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closing_ = true;
+        }
+        queued_.notify_one();
+        if (!writer_.joinable())
+            return;
+        writer_.join();
+
+        node_->log(log_level::INFO,
+                   "Raw recorder wrote " + std::to_string(stats_.bytesWritten) +
+                       " bytes to " + std::to_string(stats_.files) + " file(s), " +
+                       std::to_string(stats_.droppedBytes) + " bytes dropped.");
+    }
+
+    void RawRecorder::run()
+    {
+        std::vector<std::unique_ptr<RecordChannel::Buffer>> batch;
+        auto nextFlush = std::chrono::steady_clock::now() + RECORD_FLUSH_INTERVAL;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            queued_.wait_until(lock, nextFlush,
+                               [this]() { return !full_.empty() || closing_; });
+
+            // With O_DIRECT, partially filled buffers would have to be padded and
+            // are only written when closing
+            bool closing = closing_;
+            bool flush = std::chrono::steady_clock::now() >= nextFlush;
+            if (flush)
+                nextFlush = std::chrono::steady_clock::now() + RECORD_FLUSH_INTERVAL;
+            if (closing || (flush && !settings_->record_direct_io))
+            {
+                for (auto& channel : channels_)
+                {
+                    if (channel->current_ && (channel->current_->size > 0))
+                        full_.push_back(std::move(channel->current_));
+                }
+            }
+
+            batch.insert(batch.end(), std::make_move_iterator(full_.begin()),
+                         std::make_move_iterator(full_.end()));
+            full_.clear();
+            lock.unlock();
+
+            for (const auto& buffer : batch)
+                buffer->channel->write(*buffer);
+
+            lock.lock();
+            for (auto& buffer : batch)
+            {
+                buffer->size = 0;
+                buffer->channel = nullptr;
+                free_.push_back(std::move(buffer));
+            }
+            batch.clear();
+            if (closing)
+                break;
+        }
+        lock.unlock();
+
+        for (auto& channel : channels_)
+            channel->closeFile();
+    }
+
+    [[nodiscard]] std::unique_ptr<RecordChannel::Buffer> RawRecorder::takeBuffer()
+    {
+        if (free_.empty())
+            return nullptr;
+        std::unique_ptr<RecordChannel::Buffer> buffer = std::move(free_.back());
+        free_.pop_back();
+        return buffer;
+    }
+
+    void RawRecorder::queue(std::unique_ptr<RecordChannel::Buffer> buffer)
+    {
+        full_.push_back(std::move(buffer));
+        queued_.notify_one();
+    }
+} // namespace io
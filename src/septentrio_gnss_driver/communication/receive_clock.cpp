@@ -0,0 +1,183 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+// C++
+#include <climits>
+#include <cstring>
+
+// ROSaic
+#include <septentrio_gnss_driver/communication/receive_clock.hpp>
+
+/**
+ * @file receive_clock.cpp
+ * @date 17/10/26
+ * @brief Cheap arrival timestamps of received data
+ */
+
+namespace io {
+
+    namespace {
+        inline int64_t toNs(const timespec& ts)
+        {
+            return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+        }
+
+        inline int64_t clockNs(clockid_t clock)
+        {
+            timespec ts;
+            clock_gettime(clock, &ts);
+            return toNs(ts);
+        }
+
+        inline void updateMax(std::atomic<uint64_t>& max, uint64_t value)
+        {
+            uint64_t current = max.load(std::memory_order_relaxed);
+            while ((value > current) &&
+                   !max.compare_exchange_weak(current, value,
+                                              std::memory_order_relaxed))
+            {
+            }
+        }
+
+        //! Offset of a clock to the monotonic clock, taken from the sample read
+        //! in the shortest interval of a few
+        template <typename Clock>
+        int64_t offsetToMonotonic(Clock clock)
+        {
+            int64_t bestOffset = 0;
+            int64_t bestInterval = INT64_MAX;
+            for (int i = 0; i < 3; ++i)
+            {
+                int64_t before = clockNs(CLOCK_MONOTONIC);
+                int64_t time = clock();
+                int64_t after = clockNs(CLOCK_MONOTONIC);
+                if ((after - before) < bestInterval)
+                {
+                    bestInterval = after - before;
+                    bestOffset = time - (before + (after - before) / 2);
+                }
+            }
+            return bestOffset;
+        }
+    } // namespace
+
+    ReceiveClock::ReceiveClock(ROSaicNodeBase* node) : node_(node) { calibrate(); }
+
+    [[nodiscard]] Timestamp ReceiveClock::now()
+    {
+        int64_t monotonic = clockNs(CLOCK_MONOTONIC);
+        calibrateIfDue(monotonic);
+        if (simTime_.load(std::memory_order_relaxed))
+            return node_->getTime();
+        return static_cast<Timestamp>(monotonic +
+                                      rosOffset_.load(std::memory_order_relaxed));
+    }
+
+    [[nodiscard]] Timestamp ReceiveClock::fromKernel(const timespec& realtime)
+    {
+        int64_t monotonic = clockNs(CLOCK_MONOTONIC);
+        calibrateIfDue(monotonic);
+        if (simTime_.load(std::memory_order_relaxed))
+            return node_->getTime();
+        return static_cast<Timestamp>(
+            toNs(realtime) - realtimeOffset_.load(std::memory_order_relaxed) +
+            rosOffset_.load(std::memory_order_relaxed));
+    }
+
+    void ReceiveClock::recordKernelDelay(Timestamp kernelStamp, Timestamp userStamp)
+    {
+        uint64_t delayNs = (userStamp > kernelStamp) ? userStamp - kernelStamp : 0;
+        uint64_t delayUs = delayNs / 1000;
+        ++stats_.count;
+        stats_.delaySumNs += delayNs;
+        stats_.delaySqSumUs2 += delayUs * delayUs;
+        updateMax(stats_.delayMaxNs, delayNs);
+    }
+
+    void ReceiveClock::calibrate()
+    {
+        simTime_ = node_->usesSimTime();
+        rosOffset_ = offsetToMonotonic([this]() {
+            return static_cast<int64_t>(node_->getTime());
+        });
+        realtimeOffset_ =
+            offsetToMonotonic([]() { return clockNs(CLOCK_REALTIME); });
+        lastCalibration_ = clockNs(CLOCK_MONOTONIC);
+    }
+
+    void ReceiveClock::calibrateIfDue(int64_t monotonic)
+    {
+        int64_t last = lastCalibration_.load(std::memory_order_relaxed);
+        // Only one thread calibrates if several share the clock
+        if (((monotonic - last) > CLOCK_CALIBRATION_PERIOD_NS) &&
+            lastCalibration_.compare_exchange_strong(last, monotonic))
+            calibrate();
+    }
+
+    [[nodiscard]] bool enableKernelTimestamps(int fd)
+    {
+        int enable = 1;
+        return setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &enable,
+                          sizeof(enable)) == 0;
+    }
+
+    ssize_t receiveWithTimestamp(int fd, void* data, size_t size, sockaddr* from,
+                                 socklen_t* fromLen, timespec& stamp)
+    {
+        iovec iov;
+        iov.iov_base = data;
+        iov.iov_len = size;
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(timespec))];
+
+        msghdr msg{};
+        msg.msg_name = from;
+        msg.msg_namelen = fromLen ? *fromLen : 0;
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        stamp.tv_sec = 0;
+        stamp.tv_nsec = 0;
+        ssize_t result = recvmsg(fd, &msg, MSG_DONTWAIT);
+        if (result < 0)
+            return result;
+        if (fromLen)
+            *fromLen = msg.msg_namelen;
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr;
+             cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if ((cmsg->cmsg_level == SOL_SOCKET) &&
+                (cmsg->cmsg_type == SCM_TIMESTAMPNS))
+                std::memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+        }
+        return result;
+    }
+} // namespace io
@@ -0,0 +1,155 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <septentrio_gnss_driver/communication/replay_clock.hpp>
+
+/**
+ * @file replay_clock.cpp
+ * @date 17/10/26
+ * @brief Paces the replay of logs according to the time stamps therein
+ */
+
+namespace io {
+
+    ReplayClock::ReplayClock(double rate) :
+        rate_(rate), anchorWall_(std::chrono::steady_clock::now())
+    {
+    }
+
+    void ReplayClock::setRate(double rate)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rate_ = rate;
+        anchor();
+        changed_.notify_all();
+    }
+
+    [[nodiscard]] bool ReplayClock::waitUntil(uint64_t time)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // Messages of the same epoch are not delayed
+        if (time == time_)
+            return false;
+        // Telegrams are processed in the order of the log, hence an earlier time
+        // stems from the log itself. It is already due, but still held by a pause
+        // and does not move the replay time back.
+        bool earlier = (time < time_);
+        if (earlier)
+            ++earlierMessages_;
+
+        // The first message starts the schedule
+        bool first = (time_ == 0);
+        while (!closed_ && !first)
+        {
+            if (paused_)
+            {
+                if (steps_ > 0)
+                {
+                    --steps_;
+                    break;
+                }
+                changed_.wait(lock);
+                continue;
+            }
+            if ((rate_ <= 0.0) || earlier)
+                break;
+
+            auto due = anchorWall_ + std::chrono::duration_cast<
+                                         std::chrono::steady_clock::duration>(
+                                         std::chrono::duration<double, std::nano>(
+                                             (time - anchorTime_) / rate_));
+            if (std::chrono::steady_clock::now() >= due)
+                break;
+            // Pausing or a new rate changes the due time
+            changed_.wait_until(lock, due);
+        }
+
+        if (earlier)
+            return false;
+        time_ = time;
+        if (first || paused_ || (rate_ <= 0.0))
+            anchor();
+        return true;
+    }
+
+    void ReplayClock::pause()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        paused_ = true;
+        steps_ = 0;
+        changed_.notify_all();
+    }
+
+    void ReplayClock::resume()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        paused_ = false;
+        anchor();
+        changed_.notify_all();
+    }
+
+    void ReplayClock::step(uint32_t steps)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        steps_ += steps;
+        changed_.notify_all();
+    }
+
+    [[nodiscard]] bool ReplayClock::paused() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return paused_;
+    }
+
+    void ReplayClock::close()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        changed_.notify_all();
+    }
+
+    [[nodiscard]] uint64_t ReplayClock::time() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return time_;
+    }
+
+    [[nodiscard]] uint64_t ReplayClock::earlierMessages() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return earlierMessages_;
+    }
+
+    void ReplayClock::anchor()
+    {
+        anchorTime_ = time_;
+        anchorWall_ = std::chrono::steady_clock::now();
+    }
+} // namespace io
@@ -0,0 +1,190 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <septentrio_gnss_driver/communication/rx_configuration.hpp>
+
+// C++
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+/**
+ * @file rx_configuration.cpp
+ * @date 17/10/26
+ * @brief Differential configuration of the Rx and cache of applied configurations
+ */
+
+namespace io {
+
+    std::string commandKey(const std::string& command)
+    {
+        size_t name = command.find(',');
+        if (name == std::string::npos)
+            return command;
+        size_t argument = command.find(',', name + 1);
+        return command.substr(0, argument);
+    }
+
+    std::vector<std::string> readBackCommands(const std::vector<std::string>& commands)
+    {
+        std::vector<std::string> getters;
+        for (const auto& command : commands)
+        {
+            std::string name = command.substr(0, command.find(','));
+            if ((name.size() < 2) || (name[0] != 's'))
+                continue;
+            std::string getter = "g" + name.substr(1);
+            if (std::find(getters.begin(), getters.end(), getter) == getters.end())
+                getters.push_back(getter);
+        }
+        return getters;
+    }
+
+    uint64_t configurationHash(const std::vector<std::string>& commands)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (const auto& command : commands)
+        {
+            // The line ending separates the commands
+            for (char c : command + '\r')
+            {
+                hash ^= static_cast<uint8_t>(c);
+                hash *= 1099511628211ull;
+            }
+        }
+        return hash;
+    }
+
+    bool configurationDelta(const std::vector<std::string>& applied,
+                            const std::vector<std::string>& required,
+                            std::vector<std::string>& delta)
+    {
+        delta.clear();
+        if (applied.size() != required.size())
+            return false;
+        for (size_t i = 0; i < required.size(); ++i)
+        {
+            if (commandKey(applied[i]) != commandKey(required[i]))
+                return false;
+            if (applied[i] != required[i])
+                delta.push_back(required[i]);
+        }
+        return true;
+    }
+
+    ConfigurationCache::ConfigurationCache(const std::string& fileName) :
+        fileName_(fileName)
+    {
+    }
+
+    bool ConfigurationCache::load()
+    {
+        configurations_.clear();
+        std::ifstream file(fileName_);
+        if (!file)
+            return true;
+
+        // Each Rx starts with "rx <serial> <hash>", followed by its commands
+        // ("c <command>") and read back lines ("r <line>")
+        RxConfiguration* configuration = nullptr;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (line.empty() || (line[0] == '#'))
+                continue;
+            if (line.compare(0, 3, "rx ") == 0)
+            {
+                size_t hashPos = line.rfind(' ');
+                if (hashPos <= 3)
+                    return false;
+                std::string serial = line.substr(3, hashPos - 3);
+                configuration = &configurations_[serial];
+                try
+                {
+                    configuration->hash =
+                        std::stoull(line.substr(hashPos + 1), nullptr, 16);
+                } catch (const std::exception&)
+                {
+                    return false;
+                }
+            } else if ((configuration != nullptr) && (line.size() >= 2) &&
+                       (line[1] == ' ') && (line[0] == 'c'))
+                configuration->commands.push_back(line.substr(2));
+            else if ((configuration != nullptr) && (line.size() >= 2) &&
+                     (line[1] == ' ') && (line[0] == 'r'))
+                configuration->readBack.push_back(line.substr(2));
+            else
+                return false;
+        }
+        return true;
+    }
+
+    bool ConfigurationCache::save() const
+    {
+        std::string tmpName = fileName_ + ".tmp";
+        {
+            std::ofstream file(tmpName, std::ios::trunc);
+            if (!file)
+                return false;
+            file << "# Configurations applied by septentrio_gnss_driver\n";
+            for (const auto& entry : configurations_)
+            {
+                std::stringstream hash;
+                hash << std::hex << entry.second.hash;
+                file << "rx " << entry.first << " " << hash.str() << "\n";
+                for (const auto& command : entry.second.commands)
+                    file << "c " << command << "\n";
+                for (const auto& line : entry.second.readBack)
+                    file << "r " << line << "\n";
+            }
+            if (!file.flush())
+                return false;
+        }
+        return std::rename(tmpName.c_str(), fileName_.c_str()) == 0;
+    }
+
+    const RxConfiguration* ConfigurationCache::find(const std::string& serial) const
+    {
+        auto it = configurations_.find(serial);
+        return (it != configurations_.end()) ? &it->second : nullptr;
+    }
+
+    void ConfigurationCache::store(const std::string& serial,
+                                   const RxConfiguration& configuration)
+    {
+        configurations_[serial] = configuration;
+    }
+
+    void ConfigurationCache::erase(const std::string& serial)
+    {
+        configurations_.erase(serial);
+    }
+} // namespace io
@@ -0,0 +1,313 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include <septentrio_gnss_driver/communication/sbf_index.hpp>
+#include <septentrio_gnss_driver/communication/sync_scanner.hpp>
+#include <septentrio_gnss_driver/communication/telegram.hpp>
+#include <septentrio_gnss_driver/crc/crc.hpp>
+#include <septentrio_gnss_driver/parsers/parsing_utilities.hpp>
+
+/**
+ * @file sbf_index.cpp
+ * @date 17/10/26
+ * @brief Index of the SBF blocks of a log for seeking to a time range
+ */
+
+namespace io {
+
+    namespace {
+        //! Size of an entry in the index file
+        const size_t ENTRY_SIZE = 18;
+
+        template <typename T>
+        void put(std::vector<uint8_t>& buffer, T value)
+        {
+            for (size_t i = 0; i < sizeof(T); ++i)
+                buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+
+        template <typename T>
+        T get(const uint8_t* data)
+        {
+            T value = 0;
+            for (size_t i = 0; i < sizeof(T); ++i)
+                value |= static_cast<T>(data[i]) << (8 * i);
+            return value;
+        }
+
+        [[nodiscard]] bool inTimeRange(const SbfIndexEntry& entry,
+                                       const SbfReplayFilter& filter)
+        {
+            if (!entry.hasTime())
+                return false;
+            double time = entry.gpsTime();
+            return ((filter.start <= 0.0) || (time >= filter.start)) &&
+                   ((filter.end <= 0.0) || (time <= filter.end));
+        }
+    } // namespace
+
+    [[nodiscard]] std::vector<SbfIndexEntry> buildSbfIndex(const uint8_t* data,
+                                                           size_t size)
+    {
+        std::vector<SbfIndexEntry> index;
+        size_t pos = 0;
+        while (pos < size)
+        {
+            pos += findSync(data + pos, size - pos);
+            if ((pos + SBF_HEADER_SIZE) > size)
+                break;
+
+            const uint8_t* block = data + pos;
+            uint16_t length = parsing_utilities::parseUInt16(block + 6);
+            if ((block[1] != SBF_SYNC_BYTE_2) || (length < SBF_HEADER_SIZE) ||
+                ((length % 4) != 0) || ((pos + length) > size) ||
+                (crc::compute16CCITT(block + 4, length - 4) !=
+                 parsing_utilities::parseUInt16(block + 2)))
+            {
+                ++pos;
+                continue;
+            }
+
+            SbfIndexEntry entry;
+            entry.offset = pos;
+            entry.id = parsing_utilities::parseUInt16(block + 4);
+            entry.length = length;
+            if (length >= (SBF_TIME_OFFSET + 6))
+            {
+                entry.tow = parsing_utilities::parseUInt32(block + SBF_TIME_OFFSET);
+                entry.wnc =
+                    parsing_utilities::parseUInt16(block + SBF_TIME_OFFSET + 4);
+            }
+            index.push_back(entry);
+            pos += length;
+        }
+        return index;
+    }
+
+    [[nodiscard]] std::string sbfIndexPath(const std::string& log)
+    {
+        return log + SBF_INDEX_SUFFIX;
+    }
+
+    [[nodiscard]] bool writeSbfIndex(const std::string& path, uint64_t logSize,
+                                     const std::vector<SbfIndexEntry>& index,
+                                     std::string& error)
+    {
+        std::vector<uint8_t> buffer(SBF_INDEX_MAGIC,
+                                    SBF_INDEX_MAGIC + sizeof(SBF_INDEX_MAGIC));
+        buffer.reserve(sizeof(SBF_INDEX_MAGIC) + 16 + index.size() * ENTRY_SIZE);
+        put<uint64_t>(buffer, logSize);
+        put<uint64_t>(buffer, index.size());
+        for (const auto& entry : index)
+        {
+            put<uint64_t>(buffer, entry.offset);
+            put<uint16_t>(buffer, entry.id);
+            put<uint16_t>(buffer, entry.length);
+            put<uint32_t>(buffer, entry.tow);
+            put<uint16_t>(buffer, entry.wnc);
+        }
+
+        // Written under a temporary name so that readers never see a partial index
+        std::string tmpPath = path + ".tmp";
+        {
+            std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+            if (!file)
+            {
+                error = "writing " + tmpPath + " failed";
+                return false;
+            }
+        }
+        if (std::rename(tmpPath.c_str(), path.c_str()) != 0)
+        {
+            error = "renaming " + tmpPath + " failed: " + std::strerror(errno);
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool readSbfIndex(const std::string& path, uint64_t logSize,
+                                    std::vector<SbfIndexEntry>& index,
+                                    std::string& error)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            error = path + " not found";
+            return false;
+        }
+        std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(file)),
+                                    std::istreambuf_iterator<char>());
+
+        size_t headerSize = sizeof(SBF_INDEX_MAGIC) + 16;
+        if ((buffer.size() < headerSize) ||
+            (std::memcmp(buffer.data(), SBF_INDEX_MAGIC, sizeof(SBF_INDEX_MAGIC)) !=
+             0))
+        {
+            error = path + " is no SBF index";
+            return false;
+        }
+        const uint8_t* data = buffer.data() + sizeof(SBF_INDEX_MAGIC);
+        if (get<uint64_t>(data) != logSize)
+        {
+            error = path + " was built for a different log";
+            return false;
+        }
+        uint64_t count = get<uint64_t>(data + 8);
+        if ((buffer.size() - headerSize) != (count * ENTRY_SIZE))
+        {
+            error = path + " is truncated";
+            return false;
+        }
+
+        index.resize(count);
+        data += 16;
+        for (auto& entry : index)
+        {
+            entry.offset = get<uint64_t>(data);
+            entry.id = get<uint16_t>(data + 8);
+            entry.length = get<uint16_t>(data + 10);
+            entry.tow = get<uint32_t>(data + 12);
+            entry.wnc = get<uint16_t>(data + 16);
+            data += ENTRY_SIZE;
+            if ((entry.offset + entry.length) > logSize)
+            {
+                error = path + " does not match the log";
+                index.clear();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    [[nodiscard]] std::vector<ByteRange>
+    selectSbfRanges(const std::vector<SbfIndexEntry>& index, size_t size,
+                    const SbfReplayFilter& filter)
+    {
+        std::vector<ByteRange> ranges;
+        if (!filter.active())
+        {
+            ranges.push_back({0, size});
+            return ranges;
+        }
+
+        // Blocks of the time range, blocks without time in between included
+        auto first = std::find_if(
+            index.begin(), index.end(),
+            [&filter](const SbfIndexEntry& entry) {
+                return (filter.start <= 0.0) || inTimeRange(entry, filter);
+            });
+        auto last = std::find_if(
+            index.rbegin(), std::make_reverse_iterator(first),
+            [&filter](const SbfIndexEntry& entry) {
+                return (filter.end <= 0.0) || inTimeRange(entry, filter);
+            });
+        if ((first == index.end()) || (last.base() == first))
+            return ranges;
+
+        if (filter.blockNumbers.empty())
+        {
+            size_t begin = (filter.start <= 0.0) ? 0 : first->offset;
+            size_t end =
+                (filter.end <= 0.0) ? size : (last->offset + last->length);
+            ranges.push_back({begin, end});
+            return ranges;
+        }
+
+        for (auto it = first; it != last.base(); ++it)
+        {
+            if (std::find(filter.blockNumbers.begin(), filter.blockNumbers.end(),
+                          it->number()) == filter.blockNumbers.end())
+                continue;
+            if (!ranges.empty() && (ranges.back().end == it->offset))
+                ranges.back().end += it->length;
+            else
+                ranges.push_back({it->offset, it->offset + it->length});
+        }
+        return ranges;
+    }
+
+    std::vector<SbfSegment>
+    splitSbfSegments(const std::vector<SbfIndexEntry>& index, size_t size,
+                     size_t count, double warmup)
+    {
+        std::vector<SbfSegment> segments;
+        if (size == 0)
+            return segments;
+
+        SbfSegment current = {0, {0, size}};
+        auto it = index.begin();
+        double lastTime = -1.0;
+        for (size_t k = 1; k < count; ++k)
+        {
+            size_t goal = k * size / count;
+            // Epochs are not split, a segment starts with a block whose time
+            // differs from the one of the preceding blocks
+            for (; it != index.end(); ++it)
+            {
+                bool epochStart = it->hasTime() && (lastTime >= 0.0) &&
+                                  (it->gpsTime() != lastTime);
+                if (it->hasTime())
+                    lastTime = it->gpsTime();
+                if (epochStart && (it->offset >= goal) &&
+                    (it->offset > current.range.begin))
+                    break;
+            }
+            if (it == index.end())
+                break;
+
+            current.range.end = it->offset;
+            segments.push_back(current);
+
+            size_t warmupStart = it->offset;
+            for (auto prev = it; prev != index.begin();)
+            {
+                --prev;
+                if (!prev->hasTime())
+                    continue;
+                if (prev->gpsTime() < lastTime - warmup)
+                    break;
+                warmupStart = prev->offset;
+            }
+            current = {warmupStart, {it->offset, size}};
+            ++it;
+        }
+        segments.push_back(current);
+        return segments;
+    }
+} // namespace io
@@ -0,0 +1,167 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include <septentrio_gnss_driver/communication/sync_scanner.hpp>
+#include <septentrio_gnss_driver/communication/telegram.hpp>
+
+/**
+ * @file sync_scanner.cpp
+ * @date 17/10/26
+ * @brief Search for the sync sequence of SBF blocks and ASCII telegrams
+ */
+
+namespace io {
+
+    namespace {
+        inline bool isSyncByte2(uint8_t byte)
+        {
+            return (byte == SBF_SYNC_BYTE_2) || (byte == NMEA_SYNC_BYTE_2) ||
+                   (byte == NMEA_INS_SYNC_BYTE_2) || (byte == RESPONSE_SYNC_BYTE_2);
+        }
+
+        typedef size_t (*FindSyncFunction)(const uint8_t*, size_t);
+
+        FindSyncFunction selectFindSync()
+        {
+#if defined(__x86_64__) || defined(__i386__)
+            if (hasAvx2())
+                return &findSyncAvx2;
+            return &findSyncSse2;
+#else
+            return &findSyncScalar;
+#endif
+        }
+
+        const FindSyncFunction findSyncImpl = selectFindSync();
+    } // namespace
+
+    [[nodiscard]] size_t findSync(const uint8_t* data, size_t size)
+    {
+        return findSyncImpl(data, size);
+    }
+
+    [[nodiscard]] size_t findSyncScalar(const uint8_t* data, size_t size)
+    {
+        // memchr is vectorized by the C library
+        const uint8_t* end = data + size;
+        const uint8_t* pos = data;
+        while ((pos = static_cast<const uint8_t*>(
+                    std::memchr(pos, SYNC_BYTE_1, end - pos))) != nullptr)
+        {
+            if (((pos + 1) == end) || isSyncByte2(pos[1]))
+                return pos - data;
+            ++pos;
+        }
+        return size;
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    [[nodiscard]] size_t findSyncSse2(const uint8_t* data, size_t size)
+    {
+        const __m128i sync1 = _mm_set1_epi8(SYNC_BYTE_1);
+        const __m128i sbf = _mm_set1_epi8(SBF_SYNC_BYTE_2);
+        const __m128i nmea = _mm_set1_epi8(NMEA_SYNC_BYTE_2);
+        const __m128i nmeaIns = _mm_set1_epi8(NMEA_INS_SYNC_BYTE_2);
+        const __m128i response = _mm_set1_epi8(RESPONSE_SYNC_BYTE_2);
+
+        size_t i = 0;
+        // The second byte is loaded with an offset of one
+        for (; (i + 17) <= size; i += 16)
+        {
+            __m128i first =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            __m128i second =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 1));
+            __m128i isSync2 = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(second, sbf),
+                             _mm_cmpeq_epi8(second, nmea)),
+                _mm_or_si128(_mm_cmpeq_epi8(second, nmeaIns),
+                             _mm_cmpeq_epi8(second, response)));
+            int mask = _mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(first, sync1), isSync2));
+            if (mask != 0)
+                return i + __builtin_ctz(mask);
+        }
+        return i + findSyncScalar(data + i, size - i);
+    }
+
+    __attribute__((target("avx2"))) [[nodiscard]] size_t
+    findSyncAvx2(const uint8_t* data, size_t size)
+    {
+        const __m256i sync1 = _mm256_set1_epi8(SYNC_BYTE_1);
+        const __m256i sbf = _mm256_set1_epi8(SBF_SYNC_BYTE_2);
+        const __m256i nmea = _mm256_set1_epi8(NMEA_SYNC_BYTE_2);
+        const __m256i nmeaIns = _mm256_set1_epi8(NMEA_INS_SYNC_BYTE_2);
+        const __m256i response = _mm256_set1_epi8(RESPONSE_SYNC_BYTE_2);
+
+        size_t i = 0;
+        for (; (i + 33) <= size; i += 32)
+        {
+            __m256i first =
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            __m256i second =
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 1));
+            __m256i isSync2 = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(second, sbf),
+                                _mm256_cmpeq_epi8(second, nmea)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(second, nmeaIns),
+                                _mm256_cmpeq_epi8(second, response)));
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+                _mm256_and_si256(_mm256_cmpeq_epi8(first, sync1), isSync2)));
+            if (mask != 0)
+                return i + __builtin_ctz(mask);
+        }
+        return i + findSyncSse2(data + i, size - i);
+    }
+
+    [[nodiscard]] bool hasAvx2()
+    {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    }
+#endif
+
+    [[nodiscard]] const char* syncScannerName()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        if (findSyncImpl == &findSyncAvx2)
+            return "AVX2";
+        if (findSyncImpl == &findSyncSse2)
+            return "SSE2";
+#endif
+        return "scalar";
+    }
+} // namespace io
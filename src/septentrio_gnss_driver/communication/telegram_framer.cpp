@@ -0,0 +1,446 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <cstring>
+
+#include <septentrio_gnss_driver/communication/sync_scanner.hpp>
+#include <septentrio_gnss_driver/communication/telegram_framer.hpp>
+#include <septentrio_gnss_driver/crc/crc.hpp>
+#include <septentrio_gnss_driver/parsers/parsing_utilities.hpp>
+
+/**
+ * @file telegram_framer.cpp
+ * @date 17/10/26
+ * @brief Splits a received byte stream into telegrams
+ */
+
+namespace io {
+
+    TelegramFramer::TelegramFramer(TelegramQueue* telegramQueue,
+                                   TelegramPool* telegramPool) :
+        telegramQueue_(telegramQueue),
+        telegramPool_(telegramPool), buffer_(2 * READ_CHUNK_SIZE)
+    {
+    }
+
+    TelegramFramer::TelegramFramer(TelegramSink sink, TelegramPool* telegramPool) :
+        telegramQueue_(nullptr), sink_(std::move(sink)),
+        telegramPool_(telegramPool), buffer_(2 * READ_CHUNK_SIZE)
+    {
+    }
+
+    TelegramFramer::~TelegramFramer()
+    {
+        if (paused_)
+            telegramQueue_->cancel(this);
+    }
+
+    void TelegramFramer::setResumeHandler(ResumeHandler handler)
+    {
+        resume_ = std::move(handler);
+    }
+
+    bool TelegramFramer::resume(uint64_t pause)
+    {
+        if (!paused_ || (pause != pauses_))
+            return false;
+        paused_ = false;
+        offerHeld();
+        if (!paused_)
+            frame(pausedStamp_);
+        return !paused_;
+    }
+
+    [[nodiscard]] uint8_t* TelegramFramer::prepare(size_t size)
+    {
+        if (buffer_.size() - writePos_ < size)
+        {
+            // Move the unconsumed tail to the front of the buffer, it is bounded
+            // by the maximum telegram size
+            size_t pending = writePos_ - readPos_;
+            if (pending > 0)
+                std::memmove(buffer_.data(), buffer_.data() + readPos_, pending);
+            carriedEnd_ = (carriedEnd_ > readPos_) ? carriedEnd_ - readPos_ : 0;
+            readPos_ = 0;
+            writePos_ = pending;
+            if (buffer_.size() - writePos_ < size)
+                buffer_.resize(writePos_ + size);
+        }
+        return buffer_.data() + writePos_;
+    }
+
+    void TelegramFramer::commit(size_t size, Timestamp stamp)
+    {
+        if (size == 0)
+            return;
+        if (recorder_)
+            recorder_->record(buffer_.data() + writePos_, size);
+        writePos_ += size;
+        stats_.bytes += size;
+        frame(stamp);
+    }
+
+    void TelegramFramer::feed(const uint8_t* data, size_t size, Timestamp stamp)
+    {
+        std::memcpy(prepare(size), data, size);
+        commit(size, stamp);
+    }
+
+    [[nodiscard]] size_t TelegramFramer::frameInPlace(const uint8_t* data,
+                                                      size_t size, Timestamp stamp)
+    {
+        size_t pos = 0;
+        while (pos < size)
+        {
+            if (resyncing_)
+            {
+                size_t skip = findSync(data + pos, size - pos);
+                bool found = (skip + 1) < (size - pos);
+                pos += skip;
+                stats_.discardedBytes += skip;
+                // Sync not found yet or its second byte is still missing, a
+                // trailing sync byte is handed back with the following bytes
+                if (!found)
+                    break;
+                resyncing_ = false;
+                scanOffset_ = 0;
+                continue;
+            }
+
+            size_t consumed = 0;
+            FrameResult result = frameAt(data + pos, size - pos, stamp, consumed);
+
+            if (result == FrameResult::INCOMPLETE)
+                break;
+
+            if (result != FrameResult::COMPLETE)
+                stats_.discardedBytes += consumed;
+            pos += consumed;
+            scanOffset_ = 0;
+            if (paused_)
+                break;
+        }
+        stats_.bytes += pos;
+        return pos;
+    }
+
+    void TelegramFramer::reset()
+    {
+        if ((writePos_ > readPos_) && !resyncing_)
+            ++stats_.droppedFrames;
+        if (paused_)
+        {
+            telegramQueue_->cancel(this);
+            held_.reset();
+            paused_ = false;
+            ++stats_.droppedFrames;
+        }
+        readPos_ = 0;
+        writePos_ = 0;
+        carriedEnd_ = 0;
+        scanOffset_ = 0;
+        resyncing_ = false;
+    }
+
+    void TelegramFramer::frame(Timestamp stamp)
+    {
+        // The bytes are framed once the queue has drained
+        if (paused_)
+            return;
+
+        while (readPos_ < writePos_)
+        {
+            const uint8_t* data = buffer_.data() + readPos_;
+            size_t size = writePos_ - readPos_;
+
+            if (resyncing_)
+            {
+                size_t skip = findSync(data, size);
+                readPos_ += skip;
+                stats_.discardedBytes += skip;
+                // Sync not found yet or its second byte is still missing
+                if ((skip + 1) >= size)
+                    break;
+                resyncing_ = false;
+                scanOffset_ = 0;
+                continue;
+            }
+
+            bool carried = readPos_ < carriedEnd_;
+            size_t consumed = 0;
+            FrameResult result =
+                frameAt(data, size, carried ? carriedStamp_ : stamp, consumed);
+
+            if (result == FrameResult::INCOMPLETE)
+                break;
+
+            if (result == FrameResult::COMPLETE)
+            {
+                if (carried)
+                    ++stats_.reassembled;
+            } else
+                stats_.discardedBytes += consumed;
+            readPos_ += consumed;
+            scanOffset_ = 0;
+            if (paused_)
+            {
+                // Continued by resume() with the state of this chunk
+                pausedStamp_ = stamp;
+                return;
+            }
+        }
+
+        if (readPos_ == writePos_)
+        {
+            readPos_ = 0;
+            writePos_ = 0;
+            carriedEnd_ = 0;
+        } else if (readPos_ >= carriedEnd_)
+        {
+            // The pending telegram started in this chunk
+            carriedStamp_ = stamp;
+            carriedEnd_ = writePos_;
+        } else
+            carriedEnd_ = writePos_;
+    }
+
+    TelegramFramer::FrameResult TelegramFramer::frameAt(const uint8_t* data,
+                                                        size_t size, Timestamp stamp,
+                                                        size_t& consumed)
+    {
+        if (data[0] != SYNC_BYTE_1)
+            return frameString(data, size, telegram_type::UNKNOWN, stamp, consumed);
+
+        if (size < 2)
+            return FrameResult::INCOMPLETE;
+
+        telegram_type::TelegramType type;
+        switch (data[1])
+        {
+        case SYNC_BYTE_1:
+        {
+            // Restart at the second sync byte
+            consumed = 1;
+            return FrameResult::INVALID;
+        }
+        case SBF_SYNC_BYTE_2:
+        {
+            return frameSbf(data, size, stamp, consumed);
+        }
+        case NMEA_SYNC_BYTE_2:
+        {
+            type = telegram_type::NMEA;
+            break;
+        }
+        case NMEA_INS_SYNC_BYTE_2:
+        {
+            type = telegram_type::NMEA_INS;
+            break;
+        }
+        case RESPONSE_SYNC_BYTE_2:
+        {
+            type = telegram_type::RESPONSE;
+            break;
+        }
+        default:
+        {
+            consumed = 2;
+            return FrameResult::INVALID;
+        }
+        }
+
+        if (size < 3)
+            return FrameResult::INCOMPLETE;
+
+        bool valid = false;
+        switch (data[2])
+        {
+        case SYNC_BYTE_1:
+        {
+            consumed = 2;
+            return FrameResult::INVALID;
+        }
+        case NMEA_SYNC_BYTE_3:
+        {
+            valid = (type == telegram_type::NMEA);
+            break;
+        }
+        case NMEA_INS_SYNC_BYTE_3:
+        {
+            valid = (type == telegram_type::NMEA_INS);
+            break;
+        }
+        case RESPONSE_SYNC_BYTE_3:
+        case RESPONSE_SYNC_BYTE_3a:
+        {
+            valid = (type == telegram_type::RESPONSE);
+            break;
+        }
+        case ERROR_SYNC_BYTE_3:
+        {
+            valid = (type == telegram_type::RESPONSE);
+            type = telegram_type::ERROR_RESPONSE;
+            break;
+        }
+        default:
+        {
+            break;
+        }
+        }
+
+        if (!valid)
+        {
+            consumed = 3;
+            return FrameResult::INVALID;
+        }
+        return frameString(data, size, type, stamp, consumed);
+    }
+
+    TelegramFramer::FrameResult TelegramFramer::frameSbf(const uint8_t* data,
+                                                         size_t size,
+                                                         Timestamp stamp,
+                                                         size_t& consumed)
+    {
+        if (size < SBF_HEADER_SIZE)
+            return FrameResult::INCOMPLETE;
+
+        uint16_t length = parsing_utilities::parseUInt16(data + 6);
+        // SBF blocks are padded to a multiple of 4 bytes
+        if ((length < SBF_HEADER_SIZE) || ((length % 4) != 0))
+        {
+            consumed = 1;
+            resyncing_ = true;
+            return FrameResult::INVALID;
+        }
+
+        if (size < length)
+            return FrameResult::INCOMPLETE;
+
+        if (crc::compute16CCITT(data + 4, length - 4) !=
+            parsing_utilities::parseUInt16(data + 2))
+        {
+            // The length may be corrupted as well, so look for the next sync
+            // right after this one
+            ++stats_.crcFailures;
+            ++stats_.droppedFrames;
+            consumed = 1;
+            resyncing_ = true;
+            return FrameResult::INVALID;
+        }
+
+        emit(data, length, telegram_type::SBF, stamp);
+        consumed = length;
+        return FrameResult::COMPLETE;
+    }
+
+    TelegramFramer::FrameResult
+    TelegramFramer::frameString(const uint8_t* data, size_t size,
+                                telegram_type::TelegramType type, Timestamp stamp,
+                                size_t& consumed)
+    {
+        size_t prefix = (type == telegram_type::UNKNOWN) ? 1 : 3;
+        for (size_t i = std::max(prefix, scanOffset_); i < size; ++i)
+        {
+            switch (data[i])
+            {
+            case SYNC_BYTE_1:
+            {
+                // Unterminated string, the sync byte starts the next telegram
+                consumed = i;
+                ++stats_.droppedFrames;
+                return FrameResult::INVALID;
+            }
+            case LF:
+            {
+                consumed = i + 1;
+                if (data[i - 1] != CR)
+                {
+                    ++stats_.droppedFrames;
+                    return FrameResult::INVALID;
+                }
+                emit(data, consumed, type, stamp);
+                return FrameResult::COMPLETE;
+            }
+            case CONNECTION_DESCRIPTOR_FOOTER:
+            {
+                consumed = i + 1;
+                emit(data, consumed, telegram_type::CONNECTION_DESCRIPTOR, stamp);
+                return FrameResult::COMPLETE;
+            }
+            default:
+            {
+                break;
+            }
+            }
+        }
+
+        if (size > MAX_STRING_SIZE)
+        {
+            consumed = size;
+            resyncing_ = true;
+            ++stats_.droppedFrames;
+            return FrameResult::INVALID;
+        }
+        scanOffset_ = size;
+        return FrameResult::INCOMPLETE;
+    }
+
+    void TelegramFramer::emit(const uint8_t* data, size_t size,
+                              telegram_type::TelegramType type, Timestamp stamp)
+    {
+        std::shared_ptr<Telegram> telegram = telegramPool_->acquire();
+        telegram->stamp = stamp;
+        telegram->type = type;
+        telegram->message.assign(data, data + size);
+        if (sink_)
+            sink_(std::move(telegram));
+        else if (resume_)
+        {
+            held_ = std::move(telegram);
+            offerHeld();
+        } else
+            telegramQueue_->push(std::move(telegram));
+        ++stats_.telegrams;
+    }
+
+    void TelegramFramer::offerHeld()
+    {
+        while (!telegramQueue_->offer(held_))
+        {
+            paused_ = true;
+            uint64_t pause = ++pauses_;
+            ResumeHandler handler = resume_;
+            if (telegramQueue_->resumeWhenDrained(
+                    *held_, this, [handler, pause]() { handler(pause); }))
+                return;
+            paused_ = false;
+        }
+    }
+} // namespace io
@@ -29,6 +29,7 @@
 // *****************************************************************************
 
 #include <septentrio_gnss_driver/communication/telegram_handler.hpp>
+#include <septentrio_gnss_driver/parsers/parsing_utilities.hpp>
 
 /**
  * @file telegram_handler.cpp
@@ -91,6 +92,12 @@ namespace io {
                 }
                 capabilitiesSemaphore_.notify();
             }
+            {
+                std::lock_guard<std::mutex> lock(captureMutex_);
+                if (capturing_)
+                    capturedLines_.push_back(
+                        CommandPipeline::normalize(block_in_string));
+            }
             break;
         }
         default:
@@ -105,6 +112,13 @@ namespace io {
     void TelegramHandler::handleSbf(const std::shared_ptr<Telegram>& telegram)
     {
         messageHandler_.parseSbf(telegram);
+
+        if (parsing_utilities::getId(telegram->message) == RECEIVER_SETUP)
+        {
+            std::lock_guard<std::mutex> lock(captureMutex_);
+            rxSerialNumber_ = messageHandler_.rxSerialNumber();
+            captureCv_.notify_all();
+        }
     }
 
     void TelegramHandler::handleNmea(const std::shared_ptr<Telegram>& telegram)
@@ -117,13 +131,16 @@ namespace io {
         std::string block_in_string(telegram->message.begin(),
                                     telegram->message.end());
 
-        if (telegram->type == telegram_type::ERROR_RESPONSE)
+        bool error = (telegram->type == telegram_type::ERROR_RESPONSE);
+        std::string command = commands_.complete(block_in_string, error);
+
+        if (error)
         {
             node_->log(
                 log_level::ERROR,
                 "Invalid command just sent to the Rx! The Rx's response contains " +
                     std::to_string(block_in_string.size()) + " bytes and reads:\n " +
-                    block_in_string);
+                    block_in_string + "The command was: " + command);
 
             if (block_in_string ==
                 std::string(
@@ -140,7 +157,6 @@ namespace io {
                                              " bytes and reads:\n " +
                                              block_in_string);
         }
-        responseSemaphore_.notify();
     }
 
     void TelegramHandler::handleCd(const std::shared_ptr<Telegram>& telegram)
@@ -154,6 +170,49 @@ namespace io {
                 std::string(telegram->message.begin(), telegram->message.end() - 1);
 
             cdSemaphore_.notify();
+
+            {
+                std::lock_guard<std::mutex> lock(captureMutex_);
+                if (capturing_)
+                {
+                    ++capturedPrompts_;
+                    captureCv_.notify_all();
+                }
+            }
+            // Flushing commands returns now, hence a capture started afterwards
+            // does not count this prompt
+            commands_.prompt();
         }
     }
+
+    std::string
+    TelegramHandler::waitForRxSerialNumber(std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(captureMutex_);
+        captureCv_.wait_for(lock, timeout,
+                            [this] { return !rxSerialNumber_.empty(); });
+        return rxSerialNumber_;
+    }
+
+    void TelegramHandler::startCapture()
+    {
+        std::lock_guard<std::mutex> lock(captureMutex_);
+        capturing_ = true;
+        capturedPrompts_ = 0;
+        capturedLines_.clear();
+    }
+
+    std::vector<std::string>
+    TelegramHandler::finishCapture(size_t prompts, std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(captureMutex_);
+        if (!captureCv_.wait_for(lock, timeout, [this, prompts] {
+                return capturedPrompts_ >= prompts;
+            }))
+            node_->log(log_level::WARN, "Timeout while reading back Rx settings.");
+        capturing_ = false;
+        std::vector<std::string> lines;
+        lines.swap(capturedLines_);
+        return lines;
+    }
 } // namespace io
\ No newline at end of file
@@ -0,0 +1,99 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <algorithm>
+
+#include <septentrio_gnss_driver/communication/telegram_pool.hpp>
+
+/**
+ * @file telegram_pool.cpp
+ * @date 17/10/26
+ * @brief Pool of recycled telegrams
+ */
+
+namespace io {
+
+    TelegramPool::TelegramPool(size_t size)
+    {
+        slots_.reserve(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            slots_.emplace_back(new Telegram(0));
+            slots_.back()->message.reserve(TELEGRAM_RESERVE);
+        }
+    }
+
+    [[nodiscard]] std::shared_ptr<Telegram> TelegramPool::acquire(size_t messageSize)
+    {
+        const size_t size = slots_.size();
+        for (size_t n = 0; n < size; ++n)
+        {
+            size_t idx = (cursor_ + n) % size;
+            std::shared_ptr<Telegram>& slot = slots_[idx];
+            if (slot.use_count() != 1)
+                continue;
+
+            // Synchronizes with the release of the last reference on another thread
+            std::atomic_thread_fence(std::memory_order_acquire);
+            slot->stamp = 0;
+            slot->type = telegram_type::EMPTY;
+            slot->message.resize(messageSize);
+            cursor_ = (idx + 1) % size;
+            ++stats_.hits;
+
+            std::shared_ptr<Telegram> telegram = slot;
+            updateHighWaterMark();
+            return telegram;
+        }
+
+        ++stats_.misses;
+        stats_.highWaterMark = size;
+        return std::make_shared<Telegram>(messageSize);
+    }
+
+    void TelegramPool::updateHighWaterMark()
+    {
+        // Telegrams are released in any order, e.g. by the lanes of the queue, so
+        // the slots in use are counted. Counting is skipped as long as the
+        // telegrams handed out since the last count cannot exceed the mark.
+        ++acquiredSinceCount_;
+        if (inUseAtCount_ + acquiredSinceCount_ <= stats_.highWaterMark)
+            return;
+
+        inUseAtCount_ = static_cast<uint64_t>(
+            std::count_if(slots_.begin(), slots_.end(),
+                          [](const std::shared_ptr<Telegram>& slot) {
+                              return slot.use_count() > 1;
+                          }));
+        acquiredSinceCount_ = 0;
+        if (inUseAtCount_ > stats_.highWaterMark)
+            stats_.highWaterMark = inUseAtCount_;
+    }
+} // namespace io
@@ -0,0 +1,474 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+// C++
+#include <chrono>
+
+// ROSaic
+#include <septentrio_gnss_driver/communication/telegram_queue.hpp>
+#include <septentrio_gnss_driver/parsers/parsing_utilities.hpp>
+
+/**
+ * @file telegram_queue.cpp
+ * @date 17/10/26
+ * @brief Bounded queue handing telegrams from the I/O threads to the processing
+ * thread
+ */
+
+namespace {
+    //! Size of an SBF block up to and including its time stamp (TOW and WNc)
+    const size_t SBF_TIME_STAMP_END = SBF_HEADER_SIZE + 6;
+
+    //! Hint to the CPU that the thread is busy-waiting
+    inline void cpuRelax()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+
+    inline int64_t steadyNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    //! Whether a position in a lane has been dequeued, modulo 2^32
+    inline bool dequeuedUpTo(uint64_t dequeued, uint32_t position)
+    {
+        return static_cast<int32_t>(static_cast<uint32_t>(dequeued) - position) >= 0;
+    }
+
+    inline void updateMax(std::atomic<uint64_t>& max, uint64_t value)
+    {
+        uint64_t current = max.load(std::memory_order_relaxed);
+        while ((value > current) &&
+               !max.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        {
+        }
+    }
+} // namespace
+
+[[nodiscard]] bool parseOverflowPolicy(const std::string& name,
+                                       overflow_policy::OverflowPolicy& policy)
+{
+    if (name == "drop_oldest")
+        policy = overflow_policy::DROP_OLDEST;
+    else if (name == "drop_newest")
+        policy = overflow_policy::DROP_NEWEST;
+    else if (name == "block")
+        policy = overflow_policy::BLOCK;
+    else
+        return false;
+    return true;
+}
+
+[[nodiscard]] telegram_lane::TelegramLane classifyTelegram(const Telegram& telegram)
+{
+    switch (telegram.type)
+    {
+    case telegram_type::RESPONSE:
+    case telegram_type::ERROR_RESPONSE:
+    case telegram_type::CONNECTION_DESCRIPTOR:
+    {
+        return telegram_lane::CONTROL;
+    }
+    case telegram_type::SBF:
+    {
+        if (telegram.message.size() < SBF_HEADER_SIZE)
+            return telegram_lane::BULK;
+        switch (parsing_utilities::getId(telegram.message))
+        {
+        case 4225: // INSNavCart
+        case 4226: // INSNavGeod
+        case 4229: // ExtEventINSNavCart
+        case 4230: // ExtEventINSNavGeod
+        case 4037: // ExtEventPVTCartesian
+        case 4038: // ExtEventPVTGeodetic
+        case 4050: // ExtSensorMeas
+        case 5924: // ExtEvent
+        {
+            return telegram_lane::REALTIME;
+        }
+        default:
+            return telegram_lane::BULK;
+        }
+    }
+    default:
+        return telegram_lane::BULK;
+    }
+}
+
+[[nodiscard]] const char* laneName(telegram_lane::TelegramLane lane)
+{
+    switch (lane)
+    {
+    case telegram_lane::CONTROL:
+        return "control";
+    case telegram_lane::REALTIME:
+        return "realtime";
+    case telegram_lane::BULK:
+        return "bulk";
+    }
+    return "unknown";
+}
+
+bool TelegramQueue::Lane::tryPush(Entry& entry) noexcept
+{
+    // The entry is only moved from if it was queued
+    return spsc ? spsc->tryPush(std::move(entry)) : mpmc->tryPush(std::move(entry));
+}
+
+bool TelegramQueue::Lane::tryPop(Entry& entry) noexcept
+{
+    return spsc ? spsc->tryPop(entry) : mpmc->tryPop(entry);
+}
+
+bool TelegramQueue::Lane::peek() noexcept
+{
+    if (holding.load(std::memory_order_relaxed))
+        return true;
+    if (!tryPop(head))
+        return false;
+    holding.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+[[nodiscard]] size_t TelegramQueue::Lane::size() const noexcept
+{
+    return spsc ? spsc->size() : mpmc->size();
+}
+
+[[nodiscard]] size_t TelegramQueue::Lane::capacity() const noexcept
+{
+    return spsc ? spsc->capacity() : mpmc->capacity();
+}
+
+TelegramQueue::TelegramQueue()
+{
+    configure(DEFAULT_TELEGRAM_QUEUE_CAPACITY, overflow_policy::BLOCK, true, 0);
+}
+
+void TelegramQueue::configure(size_t capacity,
+                              overflow_policy::OverflowPolicy policy,
+                              bool multiProducer, uint32_t spinCount,
+                              bool realtime)
+{
+    if (capacity == 0)
+        capacity = 1;
+    policy_ = policy;
+    spinCount_ = spinCount;
+    realtime_ = realtime;
+    for (size_t i = 0; i < TELEGRAM_LANE_COUNT; ++i)
+    {
+        Lane& lane = lanes_[i];
+        lane.head = Entry();
+        lane.holding = false;
+        lane.policy =
+            (i == telegram_lane::CONTROL) ? overflow_policy::BLOCK : policy;
+        // Dropping the oldest telegram makes the producer a second consumer
+        if (multiProducer || (lane.policy == overflow_policy::DROP_OLDEST))
+        {
+            lane.spsc.reset();
+            lane.mpmc.reset(new io::MpmcRing<Entry>(capacity));
+        } else
+        {
+            lane.mpmc.reset();
+            lane.spsc.reset(new io::SpscRing<Entry>(capacity));
+        }
+    }
+}
+
+[[nodiscard]] telegram_lane::TelegramLane
+TelegramQueue::laneOf(const Telegram& telegram) const noexcept
+{
+    telegram_lane::TelegramLane lane = classifyTelegram(telegram);
+    if ((lane == telegram_lane::REALTIME) && !realtime_)
+        return telegram_lane::BULK;
+    return lane;
+}
+
+bool TelegramQueue::push(value_type&& telegram) noexcept
+{
+    return push(telegram, true);
+}
+
+[[nodiscard]] bool TelegramQueue::offer(value_type& telegram) noexcept
+{
+    push(telegram, false);
+    // Queued or discarded otherwise
+    return !telegram;
+}
+
+[[nodiscard]] bool TelegramQueue::resumeWhenDrained(const Telegram& telegram,
+                                                    const void* producer,
+                                                    std::function<void()> resume)
+{
+    telegram_lane::TelegramLane laneIndex = laneOf(telegram);
+    Lane& lane = lanes_[laneIndex];
+    std::lock_guard<std::mutex> lock(mutex_);
+    producersWaiting_.fetch_add(1);
+    // Pairs with the fence in notifyProducers(): either the consumer sees the
+    // resumer or this thread sees the space freed by the consumer
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (closed_.load() || (lane.size() < lane.capacity()))
+    {
+        producersWaiting_.fetch_sub(1);
+        return false;
+    }
+    resumers_.push_back({laneIndex, producer, std::move(resume)});
+    return true;
+}
+
+void TelegramQueue::cancel(const void* producer)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = resumers_.begin(); it != resumers_.end();)
+    {
+        if (it->producer == producer)
+        {
+            it = resumers_.erase(it);
+            producersWaiting_.fetch_sub(1);
+        } else
+            ++it;
+    }
+}
+
+bool TelegramQueue::push(value_type& telegram, bool wait) noexcept
+{
+    telegram_lane::TelegramLane laneIndex = laneOf(*telegram);
+    Lane& lane = lanes_[laneIndex];
+    bool text = (telegram->type == telegram_type::UNKNOWN);
+    bool timed = (telegram->type == telegram_type::SBF) &&
+                 (telegram->message.size() >= SBF_TIME_STAMP_END);
+    uint64_t tow = timed ? parsing_utilities::getTow(telegram->message) : 0;
+
+    Entry entry{std::move(telegram), steadyNs()};
+    if (laneIndex == telegram_lane::CONTROL)
+    {
+        // Responses and prompts follow the output lines of previous commands
+        entry.after = lastText_.load();
+        entry.ordered = (entry.after != 0);
+    } else if ((laneIndex == telegram_lane::REALTIME) && timed)
+    {
+        // Real-time blocks follow the bulk blocks of their epoch
+        uint64_t last = lastEpoch_.load();
+        entry.ordered = (last != 0) && ((last >> 32) == tow);
+        entry.after = static_cast<uint32_t>(last);
+    }
+
+    for (uint32_t spin = 0;; ++spin)
+    {
+        if (closed_.load(std::memory_order_acquire))
+            return false;
+
+        if (lane.tryPush(entry))
+        {
+            uint64_t position = ++lane.stats.pushed;
+            if (laneIndex == telegram_lane::BULK)
+            {
+                if (text)
+                    lastText_.store(static_cast<uint32_t>(position));
+                else if (timed)
+                    lastEpoch_.store((tow << 32) | static_cast<uint32_t>(position));
+            }
+            updateMax(lane.stats.highWaterMark, lane.size());
+            notifyConsumer();
+            return true;
+        }
+
+        switch (lane.policy)
+        {
+        case overflow_policy::DROP_NEWEST:
+        {
+            ++lane.stats.dropped;
+            return false;
+        }
+        case overflow_policy::DROP_OLDEST:
+        {
+            Entry oldest;
+            if (lane.tryPop(oldest))
+            {
+                ++lane.stats.dropped;
+                ++lane.dequeued;
+            }
+            break;
+        }
+        case overflow_policy::BLOCK:
+        {
+            if (!wait)
+            {
+                // Handed back to the producer
+                telegram = std::move(entry.telegram);
+                return false;
+            }
+            if (spin < spinCount_)
+            {
+                cpuRelax();
+                break;
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            producersWaiting_.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            notFull_.wait(lock, [this, &lane] {
+                return closed_.load() || (lane.size() < lane.capacity());
+            });
+            producersWaiting_.fetch_sub(1);
+            break;
+        }
+        }
+    }
+}
+
+bool TelegramQueue::pop(value_type& telegram) noexcept
+{
+    for (uint32_t spin = 0;; ++spin)
+    {
+        if (tryPop(telegram))
+        {
+            notifyProducers();
+            return true;
+        }
+        // Pushes fail once the queue is closed, so it is drained now
+        if (closed_.load(std::memory_order_acquire))
+            return tryPop(telegram);
+
+        if (spin < spinCount_)
+        {
+            cpuRelax();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        consumerWaiting_.store(true);
+        notifiedNs_ = 0;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        notEmpty_.wait(lock, [this] { return closed_.load() || (size() > 0); });
+        consumerWaiting_.store(false);
+        if (notifiedNs_ != 0)
+            wakeupLatency_.record(steadyNs() - notifiedNs_);
+    }
+}
+
+void TelegramQueue::close() noexcept
+{
+    closed_.store(true);
+    std::lock_guard<std::mutex> lock(mutex_);
+    notEmpty_.notify_all();
+    notFull_.notify_all();
+    // Offering fails from now on, so the producers find out when they resume
+    for (Resumer& resumer : resumers_)
+        resumer.resume();
+    producersWaiting_.fetch_sub(static_cast<uint32_t>(resumers_.size()));
+    resumers_.clear();
+}
+
+[[nodiscard]] size_t TelegramQueue::size() const noexcept
+{
+    size_t size = 0;
+    for (const Lane& lane : lanes_)
+        size += lane.size() + (lane.holding.load(std::memory_order_relaxed) ? 1 : 0);
+    return size;
+}
+
+[[nodiscard]] size_t TelegramQueue::capacity() const noexcept
+{
+    return lanes_[telegram_lane::BULK].capacity();
+}
+
+bool TelegramQueue::tryPop(value_type& telegram) noexcept
+{
+    Lane& bulk = lanes_[telegram_lane::BULK];
+    for (Lane& lane : lanes_)
+    {
+        if (!lane.peek())
+            continue;
+        // The bulk telegrams the head belongs with are handed over first
+        if ((&lane != &bulk) && lane.head.ordered &&
+            !dequeuedUpTo(bulk.dequeued.load(), lane.head.after) && bulk.peek())
+        {
+            take(bulk, telegram);
+            return true;
+        }
+        take(lane, telegram);
+        return true;
+    }
+    return false;
+}
+
+void TelegramQueue::take(Lane& lane, value_type& telegram) noexcept
+{
+    int64_t latency = steadyNs() - lane.head.enqueuedNs;
+    uint64_t latencyNs = latency > 0 ? static_cast<uint64_t>(latency) : 0;
+    ++lane.stats.popped;
+    lane.stats.latencySumNs += latencyNs;
+    updateMax(lane.stats.latencyMaxNs, latencyNs);
+    telegram = std::move(lane.head.telegram);
+    lane.holding.store(false, std::memory_order_relaxed);
+    ++lane.dequeued;
+}
+
+void TelegramQueue::notifyConsumer() noexcept
+{
+    // Pairs with the fence in pop(): either the consumer sees the telegram before
+    // it parks or this thread sees that it is parked
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (consumerWaiting_.load(std::memory_order_relaxed))
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Only the first notification marks the wakeup
+        if (notifiedNs_ == 0)
+            notifiedNs_ = steadyNs();
+        notEmpty_.notify_one();
+    }
+}
+
+void TelegramQueue::notifyProducers() noexcept
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (producersWaiting_.load(std::memory_order_relaxed) != 0)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        notFull_.notify_all();
+        // Resuming at half the capacity lets a paused connection read a good
+        // portion before the lane is full again
+        for (auto it = resumers_.begin(); it != resumers_.end();)
+        {
+            const Lane& lane = lanes_[it->lane];
+            if (lane.size() <= lane.capacity() / 2)
+            {
+                it->resume();
+                it = resumers_.erase(it);
+                producersWaiting_.fetch_sub(1);
+            } else
+                ++it;
+        }
+    }
+}
@@ -0,0 +1,127 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <septentrio_gnss_driver/communication/thread_scheduling.hpp>
+
+// C++
+#include <cstring>
+#include <sstream>
+
+/**
+ * @file thread_scheduling.cpp
+ * @date 17/10/26
+ * @brief Names, CPU affinity and real-time scheduling of the driver's threads
+ */
+
+namespace io {
+
+    namespace {
+        inline void appendError(std::string& error, const std::string& what,
+                                int code)
+        {
+            if (!error.empty())
+                error += ", ";
+            error += what + ": " + std::strerror(code);
+        }
+    } // namespace
+
+    [[nodiscard]] bool parseCpuList(const std::string& list, std::vector<int>& cpus)
+    {
+        cpus.clear();
+        std::istringstream ranges(list);
+        std::string range;
+        while (std::getline(ranges, range, ','))
+        {
+            int first;
+            int last;
+            char dash;
+            std::istringstream tokens(range);
+            if (!(tokens >> first))
+                return false;
+            last = first;
+            if ((tokens >> dash) && ((dash != '-') || !(tokens >> last)))
+                return false;
+            if (tokens >> dash)
+                return false;
+            if ((first < 0) || (last < first) || (last >= CPU_SETSIZE))
+                return false;
+            for (int cpu = first; cpu <= last; ++cpu)
+                cpus.push_back(cpu);
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool parseSchedulingPolicy(const std::string& name, int& policy)
+    {
+        if (name == "other")
+            policy = SCHED_OTHER;
+        else if (name == "fifo")
+            policy = SCHED_FIFO;
+        else if (name == "rr")
+            policy = SCHED_RR;
+        else
+            return false;
+        return true;
+    }
+
+    [[nodiscard]] bool configureThread(pthread_t thread, const std::string& name,
+                                       const ThreadScheduling& scheduling,
+                                       std::string& error)
+    {
+        error.clear();
+        int result = pthread_setname_np(thread, name.substr(0, 15).c_str());
+        if (result != 0)
+            appendError(error, "name", result);
+
+        if (!scheduling.cpus.empty())
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (int cpu : scheduling.cpus)
+            {
+                if ((cpu >= 0) && (cpu < CPU_SETSIZE))
+                    CPU_SET(cpu, &set);
+            }
+            result = pthread_setaffinity_np(thread, sizeof(set), &set);
+            if (result != 0)
+                appendError(error, "affinity", result);
+        }
+
+        if (scheduling.policy != SCHED_OTHER)
+        {
+            sched_param param{};
+            param.sched_priority = scheduling.priority;
+            result = pthread_setschedparam(thread, scheduling.policy, &param);
+            if (result != 0)
+                appendError(error, "scheduling", result);
+        }
+        return error.empty();
+    }
+} // namespace io
@@ -0,0 +1,114 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <septentrio_gnss_driver/communication/write_queue.hpp>
+
+// C++
+#include <chrono>
+
+/**
+ * @file write_queue.cpp
+ * @date 17/10/26
+ * @brief Outbound queue of a connection with one write in flight at a time
+ */
+
+namespace io {
+
+    namespace {
+        inline uint64_t steadyNs()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        }
+    } // namespace
+
+    bool WriteQueue::push(std::string message,
+                          write_priority::WritePriority priority)
+    {
+        uint64_t now = steadyNs();
+        std::lock_guard<std::mutex> lock(mutex_);
+        lanes_[priority].push_back({std::move(message), now});
+        uint64_t depth = lanes_[0].size() + lanes_[1].size();
+        if (depth > stats_.maxDepth.load(std::memory_order_relaxed))
+            stats_.maxDepth.store(depth, std::memory_order_relaxed);
+
+        if (writing_)
+            return false;
+        writing_ = true;
+        return true;
+    }
+
+    const std::vector<std::string>& WriteQueue::gather()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        batch_.clear();
+        batchQueuedNs_.clear();
+        for (auto& lane : lanes_)
+        {
+            while (!lane.empty() && (batch_.size() < MAX_WRITE_GATHER))
+            {
+                batch_.push_back(std::move(lane.front().message));
+                batchQueuedNs_.push_back(lane.front().queuedNs);
+                lane.pop_front();
+            }
+        }
+        return batch_;
+    }
+
+    bool WriteQueue::complete(bool success)
+    {
+        uint64_t now = steadyNs();
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.writes;
+        if (success)
+        {
+            stats_.messages += batch_.size();
+            for (size_t i = 0; i < batch_.size(); ++i)
+            {
+                stats_.bytes += batch_[i].size();
+                uint64_t latency = now - batchQueuedNs_[i];
+                stats_.latencySumNs += latency;
+                if (latency > stats_.latencyMaxNs.load(std::memory_order_relaxed))
+                    stats_.latencyMaxNs.store(latency, std::memory_order_relaxed);
+            }
+        } else
+            stats_.failures += batch_.size();
+
+        writing_ = !lanes_[0].empty() || !lanes_[1].empty();
+        return writing_;
+    }
+
+    size_t WriteQueue::depth() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return lanes_[0].size() + lanes_[1].size();
+    }
+} // namespace io
@@ -0,0 +1,131 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+// C++
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+// ROSaic
+#include <septentrio_gnss_driver/node/rosaic_node.hpp>
+
+/**
+ * @file multi_receiver_main.cpp
+ * @date 17/10/26
+ * @brief Main function of the multi-receiver driver: Runs one ROSaic node per
+ * receiver in one process
+ *
+ * Receiver "name" is driven by node /name/septentrio_gnss_driver, i.e. its
+ * parameters are given in that node's section of the parameter file and its
+ * topics are published in namespace /name. All receivers share the I/O threads
+ * and the executor threads. Each receiver is spun as soon as it is connected.
+ */
+
+int main(int argc, char** argv)
+{
+    rclcpp::init(argc, argv);
+
+    auto options = rclcpp::NodeOptions().use_intra_process_comms(false);
+    auto manager =
+        std::make_shared<rclcpp::Node>("septentrio_multi_receiver", options);
+
+    std::vector<std::string> receivers =
+        manager->declare_parameter<std::vector<std::string>>(
+            "receivers", std::vector<std::string>());
+    int64_t ioThreads = manager->declare_parameter<int64_t>("io.threads", 1);
+    ThreadSettings ioThreadSettings;
+    ioThreadSettings.cpus =
+        manager->declare_parameter<std::string>("threads.io.cpus", "");
+    ioThreadSettings.policy =
+        manager->declare_parameter<std::string>("threads.io.policy", "other");
+    ioThreadSettings.priority = static_cast<int32_t>(
+        manager->declare_parameter<int64_t>("threads.io.priority", 0));
+    int64_t executorThreads =
+        manager->declare_parameter<int64_t>("executor_threads", 0);
+
+    if (receivers.empty())
+    {
+        RCLCPP_ERROR(manager->get_logger(), "No receivers given.");
+        rclcpp::shutdown();
+        return 1;
+    }
+
+    auto ioPool = std::make_shared<io::IoContextPool>(
+        static_cast<size_t>(std::max<int64_t>(ioThreads, 1)));
+    std::string error;
+    if (!ioPool->configure(ioThreadSettings, error))
+        RCLCPP_WARN_STREAM(manager->get_logger(), "I/O threads: " << error);
+    RCLCPP_INFO_STREAM(manager->get_logger(),
+                       "Running " << receivers.size() << " receivers on "
+                                  << ioPool->threads() << " I/O thread(s).");
+
+    rclcpp::executors::MultiThreadedExecutor executor(
+        rclcpp::ExecutorOptions(), static_cast<size_t>(executorThreads));
+    executor.add_node(manager);
+
+    // Connecting blocks until the receiver is reachable, hence every receiver is
+    // started on a thread of its own and spun as soon as it is connected, so
+    // that one unreachable receiver does not delay the others
+    std::mutex nodesMutex;
+    std::vector<std::shared_ptr<rosaic_node::ROSaicNode>> nodes;
+    std::vector<std::thread> startThreads;
+    for (size_t i = 0; i < receivers.size(); ++i)
+    {
+        startThreads.emplace_back([&, i]() {
+            auto rxOptions = rclcpp::NodeOptions(options).arguments(
+                {"--ros-args", "-r", "__node:=septentrio_gnss_driver", "-r",
+                 "__ns:=/" + receivers[i]});
+            auto node = std::make_shared<rosaic_node::ROSaicNode>(rxOptions, ioPool);
+            {
+                std::lock_guard<std::mutex> lock(nodesMutex);
+                nodes.push_back(node);
+            }
+            if (rclcpp::ok())
+                executor.add_node(node);
+        });
+    }
+    executor.spin();
+
+    // Receivers still connecting give up once ROS is shut down
+    for (std::thread& thread : startThreads)
+        thread.join();
+
+    // The receivers are reset while the I/O still runs, their connections are
+    // destroyed after it stopped
+    for (auto& node : nodes)
+        node->close();
+    ioPool->stop();
+    nodes.clear();
+
+    rclcpp::shutdown();
+    return 0;
+}
@@ -39,7 +39,13 @@
  */
 
 rosaic_node::ROSaicNode::ROSaicNode(const rclcpp::NodeOptions& options) :
-    ROSaicNodeBase(options), IO_(this), tfBuffer_(this->get_clock())
+    ROSaicNode(options, std::shared_ptr<io::IoContextPool>())
+{
+}
+
+rosaic_node::ROSaicNode::ROSaicNode(const rclcpp::NodeOptions& options,
+                                    std::shared_ptr<io::IoContextPool> ioPool) :
+    ROSaicNodeBase(options), IO_(this, ioPool), tfBuffer_(this->get_clock())
 {
     param("activate_debug_log", settings_.activate_debug_log, false);
     if (settings_.activate_debug_log)
@@ -62,12 +68,76 @@ rosaic_node::ROSaicNode::ROSaicNode(const rclcpp::NodeOptions& options) :
     if (!getROSParams())
         return;
 
+    if (settings_.read_from_sbf_log || settings_.read_from_pcap)
+    {
+        replayClock().setRate(settings_.replay_rate);
+        registerReplayServices();
+    }
+
     // Initializes Connection
     IO_.connect();
 
+    if (!settings_.flight_recorder_directory.empty())
+        dumpService_ = this->create_service<std_srvs::srv::Trigger>(
+            "~/flight_recorder/dump",
+            [this](const std::shared_ptr<std_srvs::srv::Trigger::Request>,
+                   std::shared_ptr<std_srvs::srv::Trigger::Response> response) {
+                response->success = IO_.dumpFlightRecorder(response->message);
+            });
+
+    if (settings_.publish_io_diagnostics)
+        ioDiagnosticsTimer_ = this->create_wall_timer(
+            std::chrono::seconds(1), [this]() { IO_.publishIoDiagnostics(); });
+
     this->log(log_level::DEBUG, "Leaving ROSaicNode() constructor..");
 }
 
+rosaic_node::ROSaicNode::ROSaicNode(const rclcpp::NodeOptions& options,
+                                    MessageSink sink) :
+    ROSaicNodeBase(options), IO_(this, nullptr), tfBuffer_(this->get_clock())
+{
+    setMessageSink(std::move(sink));
+    // Messages are handed over as fast as the log is parsed
+    replayClock().setRate(0.0);
+
+    if (!getROSParams())
+        this->log(log_level::ERROR, "Invalid parameters for converting logs.");
+}
+
+void rosaic_node::ROSaicNode::close()
+{
+    ioDiagnosticsTimer_.reset();
+    dumpService_.reset();
+    IO_.close();
+}
+
+void rosaic_node::ROSaicNode::registerReplayServices()
+{
+    pauseService_ = this->create_service<std_srvs::srv::SetBool>(
+        "~/replay/pause",
+        [this](const std::shared_ptr<std_srvs::srv::SetBool::Request> request,
+               std::shared_ptr<std_srvs::srv::SetBool::Response> response) {
+            if (request->data)
+                replayClock().pause();
+            else
+                replayClock().resume();
+            response->success = true;
+            response->message = request->data ? "paused" : "resumed";
+        });
+    stepService_ = this->create_service<std_srvs::srv::Trigger>(
+        "~/replay/step",
+        [this](const std::shared_ptr<std_srvs::srv::Trigger::Request>,
+               std::shared_ptr<std_srvs::srv::Trigger::Response> response) {
+            response->success = replayClock().paused();
+            if (response->success)
+            {
+                replayClock().step();
+                response->message = "stepped";
+            } else
+                response->message = "replay is not paused";
+        });
+}
+
 [[nodiscard]] bool rosaic_node::ROSaicNode::getROSParams()
 {
     param("use_gnss_time", settings_.use_gnss_time, true);
@@ -86,6 +156,8 @@ rosaic_node::ROSaicNode::ROSaicNode(const rclcpp::NodeOptions& options) :
     param("lock_utm_zone", settings_.lock_utm_zone, true);
     param("leap_seconds", settings_.leap_seconds, -128);
     param("configure_rx", settings_.configure_rx, true);
+    param("configuration_cache", settings_.configuration_cache,
+          static_cast<std::string>(""));
 
     // Communication parameters
     param("device", settings_.device, static_cast<std::string>("/dev/ttyACM0"));
@@ -93,6 +165,7 @@ rosaic_node::ROSaicNode::ROSaicNode(const rclcpp::NodeOptions& options) :
                    static_cast<uint32_t>(921600));
     param("serial.hw_flow_control", settings_.hw_flow_control,
           static_cast<std::string>("off"));
+    param("serial.fast_bringup", settings_.serial_fast_bringup, true);
     getUint32Param("stream_device.tcp.port", settings_.tcp_port,
                    static_cast<uint32_t>(0));
     param("stream_device.tcp.ip_server", settings_.tcp_ip_server,
@@ -103,10 +176,158 @@ rosaic_node::ROSaicNode::ROSaicNode(const rclcpp::NodeOptions& options) :
           static_cast<std::string>(""));
     param("stream_device.udp.ip_server", settings_.udp_ip_server,
           static_cast<std::string>(""));
+    getUint32Param("stream_device.udp.receive_buffer_size",
+                   settings_.udp_receive_buffer_size, static_cast<uint32_t>(0));
+    getUint32Param("stream_device.udp.batch_size", settings_.udp_batch_size,
+                   static_cast<uint32_t>(16));
     param("login.user", settings_.login_user, static_cast<std::string>(""));
     param("login.password", settings_.login_password, static_cast<std::string>(""));
+    param("io.bulk_read", settings_.bulk_read, true);
+    param("io.mmap_files", settings_.mmap_files, true);
+    param("replay.start", settings_.replay_start, 0.0);
+    param("replay.end", settings_.replay_end, 0.0);
+    std::vector<int64_t> replayBlockIds;
+    param("replay.block_ids", replayBlockIds, std::vector<int64_t>());
+    for (int64_t id : replayBlockIds)
+    {
+        if ((id < 0) || (id > 0x1FFF))
+        {
+            this->log(log_level::ERROR,
+                      "Invalid replay.block_ids entry " + std::to_string(id) +
+                          " -> replaying all blocks.");
+            settings_.replay_block_ids.clear();
+            break;
+        }
+        settings_.replay_block_ids.push_back(static_cast<uint16_t>(id));
+    }
+    param("replay.rate", settings_.replay_rate, 1.0);
+    if (settings_.replay_rate < 0.0)
+    {
+        this->log(log_level::ERROR, "replay.rate must not be negative -> 1.0.");
+        settings_.replay_rate = 1.0;
+    }
+    param("replay.publish_clock", settings_.replay_publish_clock, false);
+    param("pcap.rx_ip", settings_.pcap_rx_ip, static_cast<std::string>(""));
+    getUint32Param("pcap.rx_port", settings_.pcap_rx_port, static_cast<uint32_t>(0));
+    if (settings_.pcap_rx_port > 65535)
+    {
+        this->log(log_level::ERROR, "pcap.rx_port is no valid port -> 0 (any).");
+        settings_.pcap_rx_port = 0;
+    }
+    param("record.directory", settings_.record_directory,
+          static_cast<std::string>(""));
+    getUint32Param("record.max_file_size", settings_.record_max_file_size,
+                   static_cast<uint32_t>(1024));
+    getUint32Param("record.max_file_duration", settings_.record_max_file_duration,
+                   static_cast<uint32_t>(3600));
+    getUint32Param("record.max_files", settings_.record_max_files,
+                   static_cast<uint32_t>(0));
+    getUint32Param("record.buffer_size", settings_.record_buffer_size,
+                   static_cast<uint32_t>(1048576));
+    getUint32Param("record.buffer_count", settings_.record_buffer_count,
+                   static_cast<uint32_t>(16));
+    param("record.direct_io", settings_.record_direct_io, false);
+    param("record.preallocate", settings_.record_preallocate, true);
+    param("record.compression_level", settings_.record_compression_level, 0);
+    if ((settings_.record_compression_level < 0) ||
+        (settings_.record_compression_level > 22))
+    {
+        this->log(log_level::ERROR,
+                  "record.compression_level must be within 0 to 22 -> 0.");
+        settings_.record_compression_level = 0;
+    }
+    param("flight_recorder.directory", settings_.flight_recorder_directory,
+          static_cast<std::string>(""));
+    getUint32Param("flight_recorder.size", settings_.flight_recorder_size,
+                   static_cast<uint32_t>(16));
+    if (settings_.flight_recorder_size == 0)
+    {
+        this->log(log_level::ERROR, "flight_recorder.size must be positive -> 16.");
+        settings_.flight_recorder_size = 16;
+    }
+    param("flight_recorder.duration", settings_.flight_recorder_duration, 30.0);
+    if (settings_.flight_recorder_duration <= 0.0)
+    {
+        this->log(log_level::ERROR,
+                  "flight_recorder.duration must be positive -> 30.0.");
+        settings_.flight_recorder_duration = 30.0;
+    }
+    param("flight_recorder.post_trigger", settings_.flight_recorder_post_trigger,
+          2.0);
+    if (settings_.flight_recorder_post_trigger < 0.0)
+    {
+        this->log(log_level::ERROR,
+                  "flight_recorder.post_trigger must not be negative -> 2.0.");
+        settings_.flight_recorder_post_trigger = 2.0;
+    }
+    param("flight_recorder.triggers", settings_.flight_recorder_triggers,
+          std::vector<std::string>{"crc_storm", "pvt_mode_drop", "ins_error"});
+    for (const auto& trigger : settings_.flight_recorder_triggers)
+    {
+        if ((trigger != "crc_storm") && (trigger != "pvt_mode_drop") &&
+            (trigger != "ins_error"))
+            this->log(log_level::WARN,
+                      "Unknown flight_recorder.triggers entry " + trigger +
+                          " is ignored.");
+    }
+    getUint32Param("flight_recorder.crc_storm", settings_.flight_recorder_crc_storm,
+                   static_cast<uint32_t>(10));
+    getUint32Param("io.telegram_pool_size", settings_.telegram_pool_size,
+                   static_cast<uint32_t>(128));
+    getUint32Param("io.queue.capacity", settings_.queue_capacity,
+                   static_cast<uint32_t>(4096));
+    param("io.queue.overflow_policy", settings_.queue_overflow_policy,
+          static_cast<std::string>("drop_oldest"));
+    overflow_policy::OverflowPolicy overflowPolicy;
+    if (!parseOverflowPolicy(settings_.queue_overflow_policy, overflowPolicy))
+    {
+        this->log(log_level::FATAL, "Unknown io.queue.overflow_policy " +
+                                        settings_.queue_overflow_policy +
+                                        " use drop_oldest, drop_newest or block.");
+        return false;
+    }
+    getUint32Param("io.queue.spin_count", settings_.queue_spin_count,
+                   static_cast<uint32_t>(0));
+    param("io.kernel_timestamps", settings_.kernel_timestamps, false);
+    getUint32Param("io.command_pipeline_depth", settings_.command_pipeline_depth,
+                   static_cast<uint32_t>(4));
+    getUint32Param("io.threads", settings_.io_threads, static_cast<uint32_t>(1));
+    param("threads.io.cpus", settings_.io_thread_settings.cpus,
+          static_cast<std::string>(""));
+    param("threads.io.policy", settings_.io_thread_settings.policy,
+          static_cast<std::string>("other"));
+    param("threads.io.priority", settings_.io_thread_settings.priority, 0);
+    param("threads.processing.cpus", settings_.processing_thread_settings.cpus,
+          static_cast<std::string>(""));
+    param("threads.processing.policy", settings_.processing_thread_settings.policy,
+          static_cast<std::string>("other"));
+    param("threads.processing.priority",
+          settings_.processing_thread_settings.priority, 0);
 
-    settings_.reconnect_delay_s = 2.0f; // Removed from ROS parameter list.
+    param("reconnect.delay", settings_.reconnect_delay_s, 0.5f);
+    param("reconnect.max_delay", settings_.reconnect_max_delay_s, 10.0f);
+    param("reconnect.jitter", settings_.reconnect_jitter, 0.2f);
+    param("reconnect.tcp_keepalive", settings_.tcp_keepalive, true);
+    getUint32Param("reconnect.tcp_keepalive_idle", settings_.tcp_keepalive_idle_s,
+                   static_cast<uint32_t>(10));
+    getUint32Param("reconnect.tcp_keepalive_interval",
+                   settings_.tcp_keepalive_interval_s, static_cast<uint32_t>(5));
+    getUint32Param("reconnect.tcp_keepalive_count", settings_.tcp_keepalive_count,
+                   static_cast<uint32_t>(3));
+    getUint32Param("reconnect.tcp_user_timeout", settings_.tcp_user_timeout_ms,
+                   static_cast<uint32_t>(30000));
+    if (settings_.tcp_keepalive &&
+        ((settings_.tcp_keepalive_idle_s == 0) ||
+         (settings_.tcp_keepalive_interval_s == 0) ||
+         (settings_.tcp_keepalive_count == 0)))
+    {
+        this->log(log_level::FATAL,
+                  "reconnect.tcp_keepalive_idle, reconnect.tcp_keepalive_interval "
+                  "and reconnect.tcp_keepalive_count must be at least 1.");
+        return false;
+    }
+    getUint32Param("reconnect.silence_periods", settings_.silence_periods,
+                   static_cast<uint32_t>(3));
     param("receiver_type", settings_.septentrio_receiver_type,
           static_cast<std::string>("gnss"));
     if (!((settings_.septentrio_receiver_type == "gnss") ||
@@ -163,6 +384,7 @@ rosaic_node::ROSaicNode::ROSaicNode(const rclcpp::NodeOptions& options) :
     param("publish.gpsfix", settings_.publish_gpsfix, false);
     param("publish.pose", settings_.publish_pose, false);
     param("publish.diagnostics", settings_.publish_diagnostics, false);
+    param("publish.io_diagnostics", settings_.publish_io_diagnostics, false);
     param("publish.aimplusstatus", settings_.publish_aimplusstatus, false);
     param("publish.galauthstatus", settings_.publish_galauthstatus, false);
     param("publish.gpgga", settings_.publish_gpgga, false);
@@ -0,0 +1,92 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+// C++
+#include <iomanip>
+#include <iostream>
+#include <string>
+// ROSaic
+#include <septentrio_gnss_driver/communication/mapped_file.hpp>
+#include <septentrio_gnss_driver/communication/sbf_index.hpp>
+
+/**
+ * @file sbf_index_main.cpp
+ * @date 17/10/26
+ * @brief Builds the block index of SBF logs, which is stored next to each log
+ *
+ * Usage: sbf_index <log.sbf>...
+ */
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <log.sbf>..." << std::endl;
+        return 1;
+    }
+
+    int result = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string log(argv[i]);
+        io::MappedFile file;
+        std::string error;
+        if (!file.open(log, error))
+        {
+            std::cerr << log << ": " << error << std::endl;
+            result = 1;
+            continue;
+        }
+
+        auto index = io::buildSbfIndex(file.data(), file.size());
+        std::string path = io::sbfIndexPath(log);
+        if (!io::writeSbfIndex(path, file.size(), index, error))
+        {
+            std::cerr << log << ": " << error << std::endl;
+            result = 1;
+            continue;
+        }
+
+        double first = 0.0;
+        double last = 0.0;
+        for (const auto& entry : index)
+        {
+            if (!entry.hasTime())
+                continue;
+            if (first == 0.0)
+                first = entry.gpsTime();
+            last = entry.gpsTime();
+        }
+        std::cout << path << ": " << index.size() << " blocks, GPS time "
+                  << std::fixed << std::setprecision(3) << first << " to " << last
+                  << std::endl;
+    }
+    return result;
+}
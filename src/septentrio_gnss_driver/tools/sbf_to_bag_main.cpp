@@ -0,0 +1,442 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+// C++
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+// pcap
+#include <pcap.h>
+// ROS
+#include <rosbag2_cpp/writer.hpp>
+// ROSaic
+#include <septentrio_gnss_driver/communication/mapped_file.hpp>
+#include <septentrio_gnss_driver/communication/pcap_decoder.hpp>
+#include <septentrio_gnss_driver/communication/sbf_index.hpp>
+#include <septentrio_gnss_driver/communication/telegram_framer.hpp>
+#include <septentrio_gnss_driver/communication/telegram_handler.hpp>
+#include <septentrio_gnss_driver/node/rosaic_node.hpp>
+
+/**
+ * @file sbf_to_bag_main.cpp
+ * @date 17/10/26
+ * @brief Converts an SBF log or a PCAP capture into a rosbag2 without publishing
+ *
+ * Usage: sbf_to_bag <log.sbf|capture.pcap> <bag> [--jobs N] [--storage ID]
+ *        [--ros-args --params-file <file>]
+ *
+ * The messages are assembled by the MessageHandler of the driver according to the
+ * parameters of node septentrio_gnss_driver, but are written to the bag instead
+ * of being published. The log is split into segments at epoch boundaries, which
+ * are parsed in parallel, and the messages are written in timestamp order.
+ */
+
+namespace {
+    //! Log time processed before a segment to restore the state at its start [s]
+    const double WARMUP_S = 2.0;
+    //! Minimum size of a segment, smaller logs are split into fewer segments
+    const size_t MIN_SEGMENT_SIZE = 16777216;
+
+    struct Record
+    {
+        Timestamp stamp;
+        std::string topic;
+        std::string type;
+        std::shared_ptr<rclcpp::SerializedMessage> message;
+    };
+
+    bool earlier(const Record& a, const Record& b) { return a.stamp < b.stamp; }
+
+    /**
+     * @class SegmentConverter
+     * @brief Parses segments of a log with a node of its own
+     */
+    class SegmentConverter
+    {
+    public:
+        explicit SegmentConverter(const rclcpp::NodeOptions& options)
+        {
+            node_ = std::make_shared<rosaic_node::ROSaicNode>(
+                options,
+                [this](const std::string& topic, const std::string& type,
+                       std::shared_ptr<rclcpp::SerializedMessage> message,
+                       Timestamp stamp) {
+                    if (stamp != 0)
+                        lastStamp_ = stamp;
+                    if (recording_)
+                        records_.push_back({lastStamp_, topic, type, message});
+                });
+        }
+
+        [[nodiscard]] const Settings* settings() const { return node_->settings(); }
+
+        /**
+         * @brief Parses a segment
+         * @param[in] data Content of the log
+         * @param[in] segment Segment to be parsed
+         * @return Messages of the segment in timestamp order
+         */
+        [[nodiscard]] std::vector<Record> convert(const uint8_t* data,
+                                                  const io::SbfSegment& segment)
+        {
+            // Every segment starts with the state of a freshly started driver
+            io::TelegramHandler handler(node_.get());
+            io::TelegramPool pool;
+            io::TelegramFramer framer(
+                [&handler](std::shared_ptr<Telegram>&& telegram) {
+                    handler.handleTelegram(telegram);
+                },
+                &pool);
+
+            records_.clear();
+            lastStamp_ = 0;
+            recording_ = false;
+            static_cast<void>(framer.frameInPlace(
+                data + segment.warmup, segment.range.begin - segment.warmup, 0));
+            framer.reset();
+            recording_ = true;
+            static_cast<void>(
+                framer.frameInPlace(data + segment.range.begin,
+                                    segment.range.end - segment.range.begin, 0));
+            telegrams_ += framer.statistics().telegrams;
+
+            std::stable_sort(records_.begin(), records_.end(), earlier);
+            return std::move(records_);
+        }
+
+        //! Number of telegrams parsed, including the warm-up
+        [[nodiscard]] uint64_t telegrams() const { return telegrams_; }
+
+    private:
+        std::shared_ptr<rosaic_node::ROSaicNode> node_;
+        bool recording_ = false;
+        //! Stamp of messages without header
+        Timestamp lastStamp_ = 0;
+        std::vector<Record> records_;
+        uint64_t telegrams_ = 0;
+    };
+
+    /**
+     * @brief Extracts the stream of the Rx from a capture
+     * @param[in] path Path of the capture
+     * @param[in] settings Settings selecting the stream
+     * @param[out] stream Stream of the Rx
+     * @param[out] error Description of the failure
+     * @return Whether the capture was read
+     */
+    bool decodeCapture(const std::string& path, const Settings& settings,
+                       std::vector<uint8_t>& stream, std::string& error)
+    {
+        uint32_t address;
+        if (!io::parseRxAddress(settings.pcap_rx_ip, address))
+        {
+            error = "invalid pcap.rx_ip " + settings.pcap_rx_ip;
+            return false;
+        }
+        std::array<char, PCAP_ERRBUF_SIZE> errBuff;
+        pcap_t* pcap = pcap_open_offline(path.c_str(), errBuff.data());
+        if (!pcap)
+        {
+            error = errBuff.data();
+            return false;
+        }
+        io::PcapDecoder decoder;
+        if (!decoder.reset(pcap_datalink(pcap), address,
+                           static_cast<uint16_t>(settings.pcap_rx_port)))
+        {
+            error = "unsupported link-layer header type " +
+                    std::to_string(pcap_datalink(pcap));
+            pcap_close(pcap);
+            return false;
+        }
+
+        io::PcapDecoder::PayloadSink sink = [&stream](const uint8_t* data,
+                                                      size_t size) {
+            stream.insert(stream.end(), data, data + size);
+        };
+        pcap_pkthdr* header;
+        const u_char* data;
+        int result;
+        while ((result = pcap_next_ex(pcap, &header, &data)) == 1)
+            decoder.decode(data, header->caplen, sink);
+        decoder.flush(sink);
+        if (result != PCAP_ERROR_BREAK)
+            error = pcap_geterr(pcap);
+        pcap_close(pcap);
+        if (!error.empty())
+            return false;
+
+        std::cout << "Decoded " << decoder.statistics().packets << " packets, "
+                  << stream.size() << " bytes of " << decoder.streamName() << ", "
+                  << decoder.statistics().lostBytes << " bytes missing"
+                  << std::endl;
+        return true;
+    }
+
+    /**
+     * @brief Parses the number of parallel conversions
+     * @param[in] value Argument of --jobs
+     * @param[out] jobs Number of conversions, at least 1
+     * @return Whether the argument is a decimal number
+     */
+    bool parseJobs(const std::string& value, size_t& jobs)
+    {
+        if (value.empty() || !std::all_of(value.begin(), value.end(), [](char c) {
+                return (c >= '0') && (c <= '9');
+            }))
+            return false;
+        try
+        {
+            jobs = std::max<size_t>(1, std::stoul(value));
+        } catch (const std::out_of_range&)
+        {
+            return false;
+        }
+        return true;
+    }
+
+    double secondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                             start)
+            .count();
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    rclcpp::init(argc, argv);
+    std::vector<std::string> args = rclcpp::remove_ros_arguments(argc, argv);
+
+    std::vector<std::string> positional;
+    size_t jobs = std::max(1u, std::thread::hardware_concurrency());
+    std::string storage;
+    bool valid = true;
+    for (size_t i = 1; i < args.size(); ++i)
+    {
+        if (args[i] == "--jobs")
+        {
+            if ((i + 1 >= args.size()) || !parseJobs(args[++i], jobs))
+                valid = false;
+        } else if (args[i] == "--storage")
+        {
+            if (i + 1 < args.size())
+                storage = args[++i];
+            else
+                valid = false;
+        } else
+            positional.push_back(args[i]);
+    }
+    if (!valid || (positional.size() != 2))
+    {
+        std::cerr << "Usage: " << args[0]
+                  << " <log.sbf|capture.pcap> <bag> [--jobs N] [--storage ID]"
+                     " [--ros-args --params-file <file>]"
+                  << std::endl;
+        rclcpp::shutdown();
+        return 1;
+    }
+    std::string input = std::filesystem::absolute(positional[0]).string();
+    std::string output = positional[1];
+
+    // The nodes read the parameters of the driver, the log replaces the device and
+    // there is no tf tree to take the spatial configuration from
+    auto options =
+        rclcpp::NodeOptions()
+            .arguments({"--ros-args", "-r", "__node:=septentrio_gnss_driver"})
+            .parameter_overrides(
+                {rclcpp::Parameter("device", "file_name:" + input),
+                 rclcpp::Parameter("replay.publish_clock", false),
+                 rclcpp::Parameter("get_spatial_config_from_tf", false)});
+    std::vector<std::unique_ptr<SegmentConverter>> converters;
+    for (size_t i = 0; i < jobs; ++i)
+        converters.push_back(std::make_unique<SegmentConverter>(options));
+    const Settings& settings = *converters.front()->settings();
+    if (!settings.read_from_sbf_log && !settings.read_from_pcap)
+    {
+        std::cerr << input
+                  << ": expected an absolute path to a .sbf or .pcap file "
+                     "consisting of letters, digits, '_' and '-'"
+                  << std::endl;
+        rclcpp::shutdown();
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    io::MappedFile file;
+    std::vector<uint8_t> stream;
+    const uint8_t* data;
+    size_t size;
+    std::vector<io::SbfIndexEntry> index;
+    std::string error;
+    if (settings.read_from_sbf_log)
+    {
+        if (!file.open(input, error))
+        {
+            std::cerr << input << ": " << error << std::endl;
+            rclcpp::shutdown();
+            return 1;
+        }
+        data = file.data();
+        size = file.size();
+        if (!io::readSbfIndex(io::sbfIndexPath(input), size, index, error))
+            index = io::buildSbfIndex(data, size);
+    } else
+    {
+        if (!decodeCapture(input, settings, stream, error))
+        {
+            std::cerr << input << ": " << error << std::endl;
+            rclcpp::shutdown();
+            return 1;
+        }
+        data = stream.data();
+        size = stream.size();
+        index = io::buildSbfIndex(data, size);
+    }
+    size_t count = std::max<size_t>(1, std::min(4 * jobs, size / MIN_SEGMENT_SIZE));
+    std::vector<io::SbfSegment> segments =
+        io::splitSbfSegments(index, size, count, WARMUP_S);
+    double indexSeconds = secondsSince(start);
+
+    rosbag2_cpp::Writer writer;
+    rosbag2_storage::StorageOptions storageOptions;
+    storageOptions.uri = output;
+    storageOptions.storage_id = storage;
+    try
+    {
+        writer.open(storageOptions, rosbag2_cpp::ConverterOptions{"cdr", "cdr"});
+    } catch (const std::exception& e)
+    {
+        std::cerr << output << ": " << e.what() << std::endl;
+        rclcpp::shutdown();
+        return 1;
+    }
+
+    // Segments are parsed in parallel, at most two per thread ahead of the writer
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<std::vector<Record>> results(segments.size());
+    std::vector<bool> done(segments.size(), false);
+    size_t nextSegment = 0;
+    size_t written = 0;
+    std::vector<std::thread> workers;
+    for (auto& converter : converters)
+    {
+        workers.emplace_back([&, converter = converter.get()]() {
+            while (true)
+            {
+                size_t k;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    changed.wait(lock, [&]() {
+                        return (nextSegment == segments.size()) ||
+                               (nextSegment < written + 2 * jobs);
+                    });
+                    if (nextSegment == segments.size())
+                        return;
+                    k = nextSegment++;
+                }
+                std::vector<Record> records = converter->convert(data, segments[k]);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    results[k] = std::move(records);
+                    done[k] = true;
+                }
+                changed.notify_all();
+            }
+        });
+    }
+
+    // Messages of a segment stamped later than the start of the next segment are
+    // merged with the latter
+    uint64_t messages = 0;
+    std::vector<Record> pending;
+    auto write = [&](std::vector<Record>::iterator begin,
+                     std::vector<Record>::iterator end) {
+        for (auto it = begin; it != end; ++it)
+            writer.write(*it->message, it->topic, it->type,
+                         rclcpp::Time(static_cast<int64_t>(it->stamp)));
+        messages += end - begin;
+    };
+    for (size_t k = 0; k < segments.size(); ++k)
+    {
+        std::vector<Record> records;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]() { return done[k]; });
+            records = std::move(results[k]);
+            ++written;
+        }
+        changed.notify_all();
+
+        if (!records.empty())
+        {
+            auto due = std::upper_bound(pending.begin(), pending.end(),
+                                        records.front(), earlier);
+            write(pending.begin(), due);
+            pending.erase(pending.begin(), due);
+        }
+        std::vector<Record> merged;
+        merged.reserve(pending.size() + records.size());
+        std::merge(std::make_move_iterator(pending.begin()),
+                   std::make_move_iterator(pending.end()),
+                   std::make_move_iterator(records.begin()),
+                   std::make_move_iterator(records.end()),
+                   std::back_inserter(merged), earlier);
+        pending = std::move(merged);
+    }
+    write(pending.begin(), pending.end());
+    for (auto& worker : workers)
+        worker.join();
+    writer.close();
+
+    double seconds = secondsSince(start);
+    uint64_t telegrams = 0;
+    for (const auto& converter : converters)
+        telegrams += converter->telegrams();
+    std::cout << "Converted " << size / 1e6 << " MB in " << segments.size()
+              << " segment(s) with " << jobs << " thread(s): " << telegrams
+              << " telegrams, " << messages << " messages in " << seconds
+              << " s (indexing " << indexSeconds << " s), " << size / 1e6 / seconds
+              << " MB/s, " << messages / seconds << " messages/s" << std::endl;
+
+    converters.clear();
+    rclcpp::shutdown();
+    return 0;
+}
@@ -0,0 +1,247 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+// Compares the byte-wise and the bulk read path of the AsyncManager. A synthetic
+// stream of SBF blocks and NMEA sentences is written into a socket pair and the
+// number of read handler invocations as well as the CPU time per MB are reported.
+//
+// Usage: benchmark_async_manager [MB]
+
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+#include <iostream>
+#include <random>
+
+#include <septentrio_gnss_driver/communication/async_manager.hpp>
+
+namespace {
+    //! Stream wrapper counting the read operations, i.e. handler invocations
+    class CountingSocket
+    {
+    public:
+        typedef boost::asio::local::stream_protocol::socket Socket;
+        typedef Socket::executor_type executor_type;
+
+        CountingSocket(const io::IoExecutor& executor) : socket_(executor) {}
+
+        executor_type get_executor() { return socket_.get_executor(); }
+
+        template <typename MutableBufferSequence, typename ReadHandler>
+        auto async_read_some(const MutableBufferSequence& buffers,
+                             ReadHandler&& handler)
+        {
+            ++reads;
+            return socket_.async_read_some(buffers,
+                                           std::forward<ReadHandler>(handler));
+        }
+
+        template <typename ConstBufferSequence, typename WriteHandler>
+        auto async_write_some(const ConstBufferSequence& buffers,
+                              WriteHandler&& handler)
+        {
+            return socket_.async_write_some(buffers,
+                                            std::forward<WriteHandler>(handler));
+        }
+
+        void assign(int fd) { socket_.assign(boost::asio::local::stream_protocol(), fd); }
+
+        void close() { socket_.close(); }
+
+        static inline std::atomic<uint64_t> reads = 0;
+
+    private:
+        Socket socket_;
+    };
+
+    //! IoType reading from one end of a socket pair
+    class SocketPairIo
+    {
+    public:
+        SocketPairIo(ROSaicNodeBase* /*node*/, const io::IoExecutor& executor) :
+            executor_(executor)
+        {
+        }
+
+        [[nodiscard]] bool connect()
+        {
+            stream_.reset(new CountingSocket(executor_));
+            stream_->assign(fd);
+            return true;
+        }
+
+        void close() { stream_->close(); }
+
+        static inline int fd = -1;
+
+    private:
+        io::IoExecutor executor_;
+
+    public:
+        std::unique_ptr<CountingSocket> stream_;
+    };
+
+    class BenchNode : public ROSaicNodeBase
+    {
+    public:
+        BenchNode(bool bulkRead) : ROSaicNodeBase(rclcpp::NodeOptions())
+        {
+            settings_.bulk_read = bulkRead;
+        }
+
+    private:
+        void sendVelocity(const std::string& /*velNmea*/) {}
+    };
+
+    std::vector<uint8_t> sbfBlock(uint16_t id, uint16_t length, std::mt19937& gen)
+    {
+        std::vector<uint8_t> block(length);
+        for (auto& byte : block)
+            byte = gen() & 0xFF;
+        block[0] = SYNC_BYTE_1;
+        block[1] = SBF_SYNC_BYTE_2;
+        block[4] = id & 0xFF;
+        block[5] = id >> 8;
+        block[6] = length & 0xFF;
+        block[7] = length >> 8;
+        uint16_t crc = crc::compute16CCITT(block.data() + 4, length - 4);
+        block[2] = crc & 0xFF;
+        block[3] = crc >> 8;
+        return block;
+    }
+
+    std::vector<uint8_t> generateStream(size_t size, size_t& telegrams)
+    {
+        std::mt19937 gen(42);
+        std::string nmea = "$GPGGA,120000.00,5000.0000,N,00400.0000,E,4,12,0.9,"
+                           "50.000,M,47.000,M,1.0,0000*4B\r\n";
+        std::vector<uint8_t> stream;
+        stream.reserve(size + 8192);
+        telegrams = 0;
+        while (stream.size() < size)
+        {
+            // Typical 100 Hz INS output interleaved with larger GNSS blocks
+            auto block = sbfBlock(4226, 4 * (20 + gen() % 20), gen);
+            stream.insert(stream.end(), block.begin(), block.end());
+            ++telegrams;
+            if ((telegrams % 10) == 0)
+            {
+                block = sbfBlock(4027, 4 * (200 + gen() % 800), gen);
+                stream.insert(stream.end(), block.begin(), block.end());
+                stream.insert(stream.end(), nmea.begin(), nmea.end());
+                telegrams += 2;
+            }
+        }
+        return stream;
+    }
+
+    double cpuSeconds()
+    {
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+               1e-6 * (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+    }
+
+    void run(bool bulkRead, const std::vector<uint8_t>& stream, size_t telegrams)
+    {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+        {
+            std::cerr << "socketpair failed" << std::endl;
+            return;
+        }
+        SocketPairIo::fd = fds[0];
+        CountingSocket::reads = 0;
+
+        auto node = std::make_shared<BenchNode>(bulkRead);
+        TelegramQueue queue;
+        size_t received = 0;
+        double cpu = 0.0;
+        double wall = 0.0;
+        double cpuStart = cpuSeconds();
+        auto wallStart = std::chrono::steady_clock::now();
+        {
+            io::IoContextPool ioPool(1);
+            io::AsyncManager<SocketPairIo> manager(node.get(), &queue, &ioPool);
+            if (!manager.connect())
+                return;
+
+            std::thread writer([&stream, fd = fds[1]]() {
+                size_t written = 0;
+                while (written < stream.size())
+                {
+                    ssize_t n = ::write(fd, stream.data() + written,
+                                        stream.size() - written);
+                    if (n <= 0)
+                        break;
+                    written += n;
+                }
+            });
+
+            while (received < telegrams)
+            {
+                std::shared_ptr<Telegram> telegram;
+                queue.pop(telegram);
+                ++received;
+            }
+            cpu = cpuSeconds() - cpuStart;
+            wall = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                                 wallStart)
+                       .count();
+            writer.join();
+            ioPool.stop();
+        }
+        ::close(fds[1]);
+
+        double mb = stream.size() / 1e6;
+        std::cout << (bulkRead ? "bulk     " : "bytewise ")
+                  << " telegrams: " << received
+                  << " read handlers: " << CountingSocket::reads
+                  << " handlers/MB: " << CountingSocket::reads / mb
+                  << " CPU ms/MB: " << 1e3 * cpu / mb
+                  << " wall ms/MB: " << 1e3 * wall / mb << std::endl;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    rclcpp::init(argc, argv);
+
+    size_t mb = (argc > 1) ? std::stoul(argv[1]) : 20;
+    size_t telegrams;
+    auto stream = generateStream(mb * 1000000, telegrams);
+
+    run(false, stream, telegrams);
+    run(true, stream, telegrams);
+
+    rclcpp::shutdown();
+    return 0;
+}
@@ -0,0 +1,250 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+// Measures the replay speed of PCAP captures: packets are read with libpcap,
+// decoded, the TCP stream of the Rx is reassembled and framed into the telegram
+// queue, whose consumer only counts the telegrams. A synthetic capture of a TCP
+// connection carrying SBF blocks and NMEA sentences is written to a temporary
+// file, with an acknowledgement from the host after every segment, some
+// segments swapped and some retransmitted.
+//
+// Usage: benchmark_pcap_replay [MB]
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+#include <septentrio_gnss_driver/communication/async_manager.hpp>
+
+namespace {
+    const uint32_t RX_ADDRESS = 0x0A000002;
+    const uint32_t HOST_ADDRESS = 0x0A000001;
+    const uint16_t RX_PORT = 28784;
+    const uint16_t HOST_PORT = 50000;
+    const size_t MSS = 1448;
+
+    class BenchNode : public ROSaicNodeBase
+    {
+    public:
+        BenchNode(const std::string& file) : ROSaicNodeBase(rclcpp::NodeOptions())
+        {
+            settings_.device = file;
+            settings_.read_from_pcap = true;
+            settings_.pcap_rx_ip = "10.0.0.2";
+            settings_.pcap_rx_port = RX_PORT;
+        }
+
+    private:
+        void sendVelocity(const std::string& /*velNmea*/) {}
+    };
+
+    std::vector<uint8_t> sbfBlock(uint16_t id, uint16_t length, std::mt19937& gen)
+    {
+        std::vector<uint8_t> block(length);
+        for (auto& byte : block)
+            byte = gen() & 0xFF;
+        block[0] = SYNC_BYTE_1;
+        block[1] = SBF_SYNC_BYTE_2;
+        block[4] = id & 0xFF;
+        block[5] = id >> 8;
+        block[6] = length & 0xFF;
+        block[7] = length >> 8;
+        uint16_t crc = crc::compute16CCITT(block.data() + 4, length - 4);
+        block[2] = crc & 0xFF;
+        block[3] = crc >> 8;
+        return block;
+    }
+
+    void put16(uint8_t* data, uint16_t value)
+    {
+        data[0] = value >> 8;
+        data[1] = value & 0xFF;
+    }
+
+    void put32(uint8_t* data, uint32_t value)
+    {
+        put16(data, value >> 16);
+        put16(data + 2, value & 0xFFFF);
+    }
+
+    class CaptureWriter
+    {
+    public:
+        explicit CaptureWriter(const std::string& file) :
+            capture_(file, std::ios::binary)
+        {
+            // Classic pcap with nanosecond time stamps, Ethernet link type
+            uint32_t header[6] = {0xA1B23C4D, 0x00040002, 0, 0, 65535, 1};
+            capture_.write(reinterpret_cast<const char*>(header), sizeof(header));
+        }
+
+        void tcp(uint32_t src, uint16_t srcPort, uint32_t dst, uint16_t dstPort,
+                 uint32_t seq, const uint8_t* payload, size_t size)
+        {
+            std::vector<uint8_t> frame(54 + size, 0);
+            put16(&frame[12], 0x0800);
+            frame[14] = 0x45;
+            put16(&frame[16], static_cast<uint16_t>(40 + size));
+            put16(&frame[20], 0x4000);
+            frame[22] = 64;
+            frame[23] = 6;
+            put32(&frame[26], src);
+            put32(&frame[30], dst);
+            put16(&frame[34], srcPort);
+            put16(&frame[36], dstPort);
+            put32(&frame[38], seq);
+            frame[46] = 5 << 4;
+            frame[47] = 0x10;
+            std::copy(payload, payload + size, frame.begin() + 54);
+            // Ethernet pads short frames
+            if (frame.size() < 60)
+                frame.resize(60, 0);
+
+            stamp_ += 100000;
+            uint32_t record[4] = {static_cast<uint32_t>(stamp_ / 1000000000),
+                                  static_cast<uint32_t>(stamp_ % 1000000000),
+                                  static_cast<uint32_t>(frame.size()),
+                                  static_cast<uint32_t>(frame.size())};
+            capture_.write(reinterpret_cast<const char*>(record), sizeof(record));
+            capture_.write(reinterpret_cast<const char*>(frame.data()),
+                           frame.size());
+        }
+
+    private:
+        std::ofstream capture_;
+        uint64_t stamp_ = 1700000000000000000;
+    };
+
+    //! Writes a capture of typical INS and GNSS output, returns the telegram count
+    size_t writeCapture(const std::string& file, size_t size)
+    {
+        std::mt19937 gen(42);
+        std::string nmea = "$GPGGA,120000.00,5000.0000,N,00400.0000,E,4,12,0.9,"
+                           "50.000,M,47.000,M,1.0,0000*4B\r\n";
+        std::vector<uint8_t> stream;
+        size_t telegrams = 0;
+        while (stream.size() < size)
+        {
+            auto block = sbfBlock(4226, 4 * (20 + gen() % 20), gen);
+            stream.insert(stream.end(), block.begin(), block.end());
+            ++telegrams;
+            if ((telegrams % 10) == 0)
+            {
+                block = sbfBlock(4027, 4 * (200 + gen() % 800), gen);
+                stream.insert(stream.end(), block.begin(), block.end());
+                stream.insert(stream.end(), nmea.begin(), nmea.end());
+                telegrams += 2;
+            }
+        }
+
+        CaptureWriter capture(file);
+        uint32_t isn = 0xFFF00000;
+        size_t segments = (stream.size() + MSS - 1) / MSS;
+        auto segment = [&](size_t i) {
+            size_t offset = i * MSS;
+            capture.tcp(RX_ADDRESS, RX_PORT, HOST_ADDRESS, HOST_PORT,
+                        isn + static_cast<uint32_t>(offset), &stream[offset],
+                        std::min(MSS, stream.size() - offset));
+            capture.tcp(HOST_ADDRESS, HOST_PORT, RX_ADDRESS, RX_PORT, 1, nullptr, 0);
+        };
+        for (size_t i = 0; i < segments; ++i)
+        {
+            if (((i % 100) == 50) && (i + 1 < segments))
+            {
+                segment(i + 1);
+                segment(i);
+                ++i;
+                continue;
+            }
+            segment(i);
+            if ((i % 500) == 0)
+                segment(i);
+        }
+        return telegrams;
+    }
+
+    void run(const std::string& file, size_t size, size_t telegrams)
+    {
+        auto node = std::make_shared<BenchNode>(file);
+        TelegramQueue queue;
+        queue.configure(4096, overflow_policy::BLOCK, false, 0);
+        size_t received = 0;
+        double wall = 0.0;
+        {
+            io::IoContextPool ioPool(1);
+            io::AsyncManager<io::PcapFileIo> manager(node.get(), &queue, &ioPool);
+            auto start = std::chrono::steady_clock::now();
+            if (!manager.connect())
+            {
+                std::cerr << "opening " << file << " failed" << std::endl;
+                return;
+            }
+
+            while (received < telegrams)
+            {
+                std::shared_ptr<Telegram> telegram;
+                if (!queue.pop(telegram))
+                    break;
+                ++received;
+            }
+            wall = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                                 start)
+                       .count();
+            ioPool.stop();
+        }
+
+        std::cout << "pcap telegrams: " << received << " of " << telegrams
+                  << " MB/s: " << size / 1e6 / wall
+                  << " blocks/s: " << received / wall << std::endl;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    rclcpp::init(argc, argv);
+
+    size_t mb = (argc > 1) ? std::stoul(argv[1]) : 200;
+    std::string file = "/tmp/benchmark_pcap_replay_" + std::to_string(getpid()) +
+                       ".pcap";
+    size_t telegrams = writeCapture(file, mb * 1000000);
+    std::ifstream capture(file, std::ios::binary | std::ios::ate);
+    size_t size = capture.tellg();
+
+    // The second run reads from the page cache
+    for (int i = 0; i < 2; ++i)
+        run(file, size, telegrams);
+
+    std::remove(file.c_str());
+    rclcpp::shutdown();
+    return 0;
+}
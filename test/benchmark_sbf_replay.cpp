@@ -0,0 +1,167 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+// Compares the replay paths of SBF logs: the memory-mapped file framed in place
+// and the file read in chunks through a stream descriptor. A synthetic log of SBF
+// blocks and NMEA sentences is written to a temporary file and replayed into the
+// telegram queue, whose consumer only counts the telegrams.
+//
+// Usage: benchmark_sbf_replay [MB]
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+#include <septentrio_gnss_driver/communication/async_manager.hpp>
+
+namespace {
+    class BenchNode : public ROSaicNodeBase
+    {
+    public:
+        BenchNode(const std::string& file, bool mmapFiles) :
+            ROSaicNodeBase(rclcpp::NodeOptions())
+        {
+            settings_.device = file;
+            settings_.read_from_sbf_log = true;
+            settings_.bulk_read = true;
+            settings_.mmap_files = mmapFiles;
+        }
+
+    private:
+        void sendVelocity(const std::string& /*velNmea*/) {}
+    };
+
+    std::vector<uint8_t> sbfBlock(uint16_t id, uint16_t length, std::mt19937& gen)
+    {
+        std::vector<uint8_t> block(length);
+        for (auto& byte : block)
+            byte = gen() & 0xFF;
+        block[0] = SYNC_BYTE_1;
+        block[1] = SBF_SYNC_BYTE_2;
+        block[4] = id & 0xFF;
+        block[5] = id >> 8;
+        block[6] = length & 0xFF;
+        block[7] = length >> 8;
+        uint16_t crc = crc::compute16CCITT(block.data() + 4, length - 4);
+        block[2] = crc & 0xFF;
+        block[3] = crc >> 8;
+        return block;
+    }
+
+    //! Writes a log of typical INS and GNSS output, returns the telegram count
+    size_t writeLog(const std::string& file, size_t size)
+    {
+        std::mt19937 gen(42);
+        std::string nmea = "$GPGGA,120000.00,5000.0000,N,00400.0000,E,4,12,0.9,"
+                           "50.000,M,47.000,M,1.0,0000*4B\r\n";
+        std::ofstream log(file, std::ios::binary);
+        size_t written = 0;
+        size_t telegrams = 0;
+        while (written < size)
+        {
+            auto block = sbfBlock(4226, 4 * (20 + gen() % 20), gen);
+            log.write(reinterpret_cast<const char*>(block.data()), block.size());
+            written += block.size();
+            ++telegrams;
+            if ((telegrams % 10) == 0)
+            {
+                block = sbfBlock(4027, 4 * (200 + gen() % 800), gen);
+                log.write(reinterpret_cast<const char*>(block.data()),
+                          block.size());
+                log.write(nmea.data(), nmea.size());
+                written += block.size() + nmea.size();
+                telegrams += 2;
+            }
+        }
+        return telegrams;
+    }
+
+    void run(bool mmapFiles, const std::string& file, size_t size,
+             size_t telegrams)
+    {
+        auto node = std::make_shared<BenchNode>(file, mmapFiles);
+        TelegramQueue queue;
+        queue.configure(4096, overflow_policy::BLOCK, false, 0);
+        size_t received = 0;
+        double wall = 0.0;
+        {
+            io::IoContextPool ioPool(1);
+            io::AsyncManager<io::SbfFileIo> manager(node.get(), &queue, &ioPool);
+            auto start = std::chrono::steady_clock::now();
+            if (!manager.connect())
+            {
+                std::cerr << "opening " << file << " failed" << std::endl;
+                return;
+            }
+
+            while (received < telegrams)
+            {
+                std::shared_ptr<Telegram> telegram;
+                if (!queue.pop(telegram))
+                    break;
+                ++received;
+            }
+            wall = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                                 start)
+                       .count();
+            ioPool.stop();
+        }
+
+        std::cout << (mmapFiles ? "mmap   " : "stream ")
+                  << " telegrams: " << received << " MB/s: " << size / 1e6 / wall
+                  << " blocks/s: " << received / wall << std::endl;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    rclcpp::init(argc, argv);
+
+    size_t mb = (argc > 1) ? std::stoul(argv[1]) : 200;
+    std::string file = "/tmp/benchmark_sbf_replay_" + std::to_string(getpid()) +
+                       ".sbf";
+    size_t telegrams = writeLog(file, mb * 1000000);
+    std::ifstream log(file, std::ios::binary | std::ios::ate);
+    size_t size = log.tellg();
+
+    // The second run of each path reads from the page cache
+    for (int i = 0; i < 2; ++i)
+    {
+        run(false, file, size, telegrams);
+        run(true, file, size, telegrams);
+    }
+
+    std::remove(file.c_str());
+    rclcpp::shutdown();
+    return 0;
+}
@@ -0,0 +1,130 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+// Micro-benchmark of the sync sequence search on noisy input, e.g. after line
+// noise on a serial link or in a partially written SBF log.
+//
+// Usage: benchmark_sync_scanner [MB]
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <septentrio_gnss_driver/communication/sync_scanner.hpp>
+
+namespace {
+    typedef size_t (*FindSyncFunction)(const uint8_t*, size_t);
+
+    //! Byte by byte search as done by the original resync loops
+    size_t findSyncBytewise(const uint8_t* data, size_t size)
+    {
+        for (size_t i = 0; i < size; ++i)
+        {
+            if (data[i] != '$')
+                continue;
+            if ((i + 1) == size)
+                return i;
+            uint8_t next = data[i + 1];
+            if ((next == '@') || (next == 'G') || (next == 'I') || (next == 'R'))
+                return i;
+        }
+        return size;
+    }
+
+    void run(const std::string& name, FindSyncFunction findSync,
+             const std::vector<uint8_t>& data)
+    {
+        auto start = std::chrono::steady_clock::now();
+        size_t found = 0;
+        const int repetitions = 10;
+        for (int r = 0; r < repetitions; ++r)
+        {
+            size_t pos = 0;
+            while (pos < data.size())
+            {
+                pos += findSync(data.data() + pos, data.size() - pos) + 1;
+                ++found;
+            }
+        }
+        double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+        std::cout << name << ": " << found / repetitions << " syncs, "
+                  << repetitions * data.size() / seconds / 1e6 << " MB/s"
+                  << std::endl;
+    }
+
+    std::vector<uint8_t> generate(size_t size, double syncRate, std::mt19937& gen)
+    {
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+        std::vector<uint8_t> data(size);
+        for (auto& byte : data)
+        {
+            byte = gen() & 0xFF;
+            // Sync sequences are rare in noise, stray sync bytes are not
+            if (byte == '$')
+                byte = 0;
+            if (dist(gen) < 0.01)
+                byte = '$';
+        }
+        for (size_t i = 0; (i + 1) < size; ++i)
+        {
+            if (dist(gen) < syncRate)
+            {
+                data[i] = '$';
+                data[i + 1] = '@';
+            }
+        }
+        return data;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t mb = (argc > 1) ? std::stoul(argv[1]) : 64;
+    std::mt19937 gen(42);
+
+    std::cout << "findSync dispatches to " << io::syncScannerName() << std::endl;
+    for (double syncRate : {0.0, 1e-5, 1e-3})
+    {
+        auto data = generate(mb * 1000000, syncRate, gen);
+        std::cout << "noise with sync rate " << syncRate << std::endl;
+        run("  bytewise", &findSyncBytewise, data);
+        run("  scalar  ", &io::findSyncScalar, data);
+#if defined(__x86_64__) || defined(__i386__)
+        run("  SSE2    ", &io::findSyncSse2, data);
+        if (io::hasAvx2())
+            run("  AVX2    ", &io::findSyncAvx2, data);
+#endif
+    }
+    return 0;
+}
@@ -0,0 +1,173 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <septentrio_gnss_driver/communication/command_pipeline.hpp>
+
+TEST(CommandPipelineTest, echo)
+{
+    EXPECT_EQ(io::CommandPipeline::echo("$R: sso, all, none, none, off\r\n"),
+              "sso, all, none, none, off");
+    EXPECT_EQ(io::CommandPipeline::normalize("\rsno, all, none, none, off \r"),
+              "sno, all, none, none, off");
+    EXPECT_EQ(io::CommandPipeline::echo("$R"), "");
+}
+
+TEST(CommandPipelineTest, matchesEchoedCommand)
+{
+    io::CommandPipeline pipeline(3);
+    pipeline.submit("sso, all, none, none, off \r");
+    pipeline.submit("sno, all, none, none, off \r");
+    pipeline.submit("grc \r");
+
+    EXPECT_EQ(pipeline.complete("$R: sno, all, none, none, off\r\n", false),
+              "sno, all, none, none, off");
+    // Errors only echo the full name and complete the oldest command
+    EXPECT_EQ(pipeline.complete("$R? setSBFOutput: Invalid command!\r\n", true),
+              "sso, all, none, none, off");
+    EXPECT_EQ(pipeline.complete("$R: get receiver capabilities\r\n", false), "grc");
+    EXPECT_EQ(pipeline.complete("$R: grc\r\n", false), "");
+    EXPECT_EQ(pipeline.submitted(), 3u);
+
+    auto failures = pipeline.takeFailures();
+    ASSERT_EQ(failures.size(), 1u);
+    EXPECT_EQ(failures[0].command, "sso, all, none, none, off");
+    EXPECT_EQ(failures[0].response, "$R? setSBFOutput: Invalid command!");
+    EXPECT_TRUE(pipeline.takeFailures().empty());
+}
+
+TEST(CommandPipelineTest, windowBlocks)
+{
+    io::CommandPipeline pipeline(2);
+    pipeline.submit("a");
+    pipeline.submit("b");
+
+    std::atomic<bool> submitted(false);
+    std::thread sender([&] {
+        pipeline.submit("c");
+        submitted = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(submitted);
+
+    pipeline.complete("$R: a\r\n", false);
+    // The output of the command only ends with the prompt
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_FALSE(submitted);
+    pipeline.prompt();
+    sender.join();
+    EXPECT_TRUE(submitted);
+
+    std::thread responder([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        pipeline.complete("$R: b\r\n", false);
+        pipeline.prompt();
+        pipeline.complete("$R: c\r\n", false);
+        pipeline.prompt();
+    });
+    pipeline.flush();
+    responder.join();
+    EXPECT_EQ(pipeline.complete("$R: d\r\n", false), "");
+}
+
+TEST(CommandPipelineTest, flushWaitsForSplitPrompt)
+{
+    io::CommandPipeline pipeline(4);
+    pipeline.submit("sso, Stream1, USB1, PVTGeodetic, sec1");
+    pipeline.submit("gso");
+    // The prompt of the first command arrives after the response of the second
+    pipeline.prompt();
+    EXPECT_EQ(pipeline.complete("$R: sso, Stream1, USB1, PVTGeodetic, sec1\r\n",
+                                false),
+              "sso, Stream1, USB1, PVTGeodetic, sec1");
+    EXPECT_EQ(pipeline.complete("$R: gso\r\n", false), "gso");
+    pipeline.prompt();
+
+    std::atomic<bool> flushed(false);
+    std::thread flusher([&] {
+        pipeline.flush();
+        flushed = true;
+    });
+    // Output lines of gso may still arrive
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(flushed);
+    pipeline.prompt();
+    flusher.join();
+    EXPECT_TRUE(flushed);
+}
+
+TEST(CommandPipelineTest, failedWriteReleasesWindow)
+{
+    io::CommandPipeline pipeline(2);
+    pipeline.submit("sso, all, none, none, off \r");
+    pipeline.submit("grc \r");
+    EXPECT_FALSE(pipeline.fail("$PSSN,VSM,...\r\n", "Broken pipe"));
+
+    std::atomic<bool> submitted(false);
+    std::thread submitter([&] {
+        pipeline.submit("sno, all, none, none, off \r");
+        submitted = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(submitted);
+    // The batch of both commands could not be written
+    EXPECT_TRUE(pipeline.fail("sso, all, none, none, off \r", "Broken pipe"));
+    submitter.join();
+    EXPECT_TRUE(submitted);
+    EXPECT_TRUE(pipeline.fail("grc \r", "Broken pipe"));
+    EXPECT_TRUE(pipeline.fail("sno, all, none, none, off \r", "Broken pipe"));
+    pipeline.flush();
+
+    auto failures = pipeline.takeFailures();
+    ASSERT_EQ(failures.size(), 3u);
+    EXPECT_EQ(failures[0].command, "sso, all, none, none, off");
+    EXPECT_EQ(failures[0].response, "Broken pipe");
+    EXPECT_EQ(failures[1].command, "grc");
+}
+
+TEST(CommandPipelineTest, clearReleasesWaiters)
+{
+    io::CommandPipeline pipeline(1);
+    pipeline.submit("a");
+
+    std::thread sender([&] { pipeline.submit("b"); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    pipeline.clear();
+    sender.join();
+
+    // Commands submitted after clearing are tracked again
+    EXPECT_EQ(pipeline.complete("$R: b\r\n", false), "b");
+    EXPECT_EQ(pipeline.submitted(), 2u);
+}
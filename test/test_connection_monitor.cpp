@@ -0,0 +1,136 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <septentrio_gnss_driver/communication/connection_monitor.hpp>
+
+using namespace std::chrono_literals;
+
+TEST(ReconnectBackoffTest, doublesUpToMax)
+{
+    io::ReconnectBackoff backoff(0.1, 0.5, 0.0);
+    EXPECT_EQ(backoff.next(), 100ms);
+    EXPECT_EQ(backoff.next(), 200ms);
+    EXPECT_EQ(backoff.next(), 400ms);
+    EXPECT_EQ(backoff.next(), 500ms);
+    EXPECT_EQ(backoff.next(), 500ms);
+    EXPECT_EQ(backoff.attempts(), 5u);
+
+    backoff.reset();
+    EXPECT_EQ(backoff.attempts(), 0u);
+    EXPECT_EQ(backoff.next(), 100ms);
+}
+
+TEST(ReconnectBackoffTest, jitterBounds)
+{
+    io::ReconnectBackoff backoff(1.0, 1.0, 0.25);
+    bool varied = false;
+    for (int i = 0; i < 100; ++i)
+    {
+        auto delay = backoff.next();
+        EXPECT_GE(delay, 750ms);
+        EXPECT_LE(delay, 1250ms);
+        varied |= (delay != 1s);
+    }
+    EXPECT_TRUE(varied);
+}
+
+TEST(ConnectionMonitorTest, measuresOutage)
+{
+    io::ConnectionMonitor monitor;
+    EXPECT_FALSE(monitor.dataReceived());
+
+    monitor.lost();
+    // A loss detected twice is one outage
+    monitor.lost();
+    monitor.attempt();
+    monitor.attempt();
+    std::this_thread::sleep_for(10ms);
+    monitor.reconnected();
+    EXPECT_TRUE(monitor.dataReceived());
+    EXPECT_FALSE(monitor.dataReceived());
+
+    const io::ConnectionStatistics& stats = monitor.statistics();
+    EXPECT_EQ(stats.outages, 1u);
+    EXPECT_EQ(stats.reconnectAttempts, 2u);
+    EXPECT_EQ(stats.resumed, 1u);
+    EXPECT_GE(monitor.lastOutageMs(), 10u);
+    EXPECT_GE(stats.outageMaxNs, stats.resumeMaxNs);
+}
+
+TEST(ConnectionMonitorTest, silence)
+{
+    io::ConnectionMonitor monitor;
+    monitor.watch();
+    std::this_thread::sleep_for(20ms);
+    EXPECT_GE(monitor.silence(), 20ms);
+
+    monitor.dataReceived();
+    EXPECT_LT(monitor.silence(), 20ms);
+
+    std::this_thread::sleep_for(20ms);
+    monitor.lost();
+    monitor.reconnected();
+    EXPECT_LT(monitor.silence(), 20ms);
+}
+
+TEST(ConnectionMonitorTest, tcpKeepalive)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(fd, 0);
+    EXPECT_TRUE(io::enableTcpKeepalive(fd, 7, 2, 4, 12000));
+
+    int enabled = 0;
+    socklen_t length = sizeof(enabled);
+    getsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &enabled, &length);
+    EXPECT_EQ(enabled, 1);
+    int idle = 0;
+    getsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &idle, &length);
+    EXPECT_EQ(idle, 7);
+    int interval = 0;
+    getsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &interval, &length);
+    EXPECT_EQ(interval, 2);
+    int count = 0;
+    getsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT, &count, &length);
+    EXPECT_EQ(count, 4);
+    unsigned int userTimeout = 0;
+    length = sizeof(userTimeout);
+    getsockopt(fd, IPPROTO_TCP, TCP_USER_TIMEOUT, &userTimeout, &length);
+    EXPECT_EQ(userTimeout, 12000u);
+    close(fd);
+}
@@ -0,0 +1,122 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <gtest/gtest.h>
+
+#include <netinet/in.h>
+#include <unistd.h>
+
+#include <septentrio_gnss_driver/communication/datagram_batch.hpp>
+#include <septentrio_gnss_driver/communication/receive_clock.hpp>
+
+namespace {
+    class UdpPair
+    {
+    public:
+        UdpPair()
+        {
+            receiver = socket(AF_INET, SOCK_DGRAM, 0);
+            sender = socket(AF_INET, SOCK_DGRAM, 0);
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            bind(receiver, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+            socklen_t length = sizeof(address);
+            getsockname(receiver, reinterpret_cast<sockaddr*>(&address), &length);
+        }
+
+        ~UdpPair()
+        {
+            close(sender);
+            close(receiver);
+        }
+
+        bool send(const std::vector<uint8_t>& data)
+        {
+            return sendto(sender, data.data(), data.size(), 0,
+                          reinterpret_cast<sockaddr*>(&address),
+                          sizeof(address)) == static_cast<ssize_t>(data.size());
+        }
+
+        int receiver;
+        int sender;
+        sockaddr_in address{};
+    };
+} // namespace
+
+TEST(DatagramBatchTest, receivesBatches)
+{
+    UdpPair udp;
+    ASSERT_TRUE(io::enableKernelTimestamps(udp.receiver));
+    io::DatagramBatch batch(4, 1024);
+    EXPECT_LT(batch.receive(udp.receiver), 0);
+
+    for (uint8_t i = 0; i < 5; ++i)
+        ASSERT_TRUE(udp.send(std::vector<uint8_t>(i + 1, i)));
+    usleep(10000);
+
+    ASSERT_EQ(batch.receive(udp.receiver), 4);
+    for (uint8_t i = 0; i < 4; ++i)
+    {
+        ASSERT_EQ(batch.size(i), i + 1u);
+        EXPECT_EQ(batch.data(i)[0], i);
+        EXPECT_NE(batch.stamp(i).tv_sec, 0);
+        EXPECT_EQ(batch.senderLength(i), sizeof(sockaddr_in));
+        EXPECT_EQ(batch.sender(i).ss_family, AF_INET);
+    }
+    ASSERT_EQ(batch.receive(udp.receiver), 1);
+    EXPECT_EQ(batch.size(0), 5u);
+    EXPECT_EQ(batch.data(0)[4], 4);
+}
+
+TEST(DatagramBatchTest, countsKernelDrops)
+{
+    UdpPair udp;
+    ASSERT_TRUE(io::enableDropCounter(udp.receiver));
+    size_t granted = io::setReceiveBufferSize(udp.receiver, 4096);
+    EXPECT_GT(granted, 0u);
+
+    // Overflow the small receive buffer
+    for (int i = 0; i < 200; ++i)
+        udp.send(std::vector<uint8_t>(1000, 0x24));
+    usleep(10000);
+
+    io::DatagramBatch batch(256, 1024);
+    int count = batch.receive(udp.receiver);
+    ASSERT_GT(count, 0);
+    ASSERT_LT(count, 200);
+
+    // The counter is attached to datagrams queued after the drops
+    ASSERT_TRUE(udp.send(std::vector<uint8_t>(10, 0x24)));
+    usleep(10000);
+    ASSERT_EQ(batch.receive(udp.receiver), 1);
+    uint32_t drops = 0;
+    ASSERT_TRUE(batch.drops(0, drops));
+    EXPECT_EQ(drops + count, 200u);
+}
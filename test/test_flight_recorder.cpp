@@ -0,0 +1,281 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include <septentrio_gnss_driver/communication/flight_recorder.hpp>
+
+namespace {
+    //! Nodes can only be created after rclcpp is initialized
+    class RclcppEnvironment : public ::testing::Environment
+    {
+    public:
+        void SetUp() override { rclcpp::init(0, nullptr); }
+        void TearDown() override { rclcpp::shutdown(); }
+    };
+
+    ::testing::Environment* const rclcppEnvironment =
+        ::testing::AddGlobalTestEnvironment(new RclcppEnvironment);
+
+    class RecorderNode : public ROSaicNodeBase
+    {
+    public:
+        explicit RecorderNode(const std::string& directory) :
+            ROSaicNodeBase(rclcpp::NodeOptions())
+        {
+            settings_.flight_recorder_directory = directory;
+            settings_.flight_recorder_size = 1;
+            settings_.flight_recorder_post_trigger = 0.0;
+        }
+
+        Settings& mutableSettings() { return settings_; }
+
+    private:
+        void sendVelocity(const std::string& /*velNmea*/) {}
+    };
+
+    class FlightRecorderTest : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            directory_ = "/tmp/test_flight_recorder_" + std::to_string(getpid());
+            std::filesystem::remove_all(directory_);
+        }
+
+        void TearDown() override { std::filesystem::remove_all(directory_); }
+
+        //! Files of the directory in order of their names
+        std::vector<std::string> files() const
+        {
+            std::vector<std::string> paths;
+            if (!std::filesystem::exists(directory_))
+                return paths;
+            for (const auto& entry : std::filesystem::directory_iterator(directory_))
+                paths.push_back(entry.path().string());
+            std::sort(paths.begin(), paths.end());
+            return paths;
+        }
+
+        static std::vector<uint8_t> read(const std::string& path)
+        {
+            std::ifstream file(path, std::ios::binary);
+            return std::vector<uint8_t>(std::istreambuf_iterator<char>(file),
+                                        std::istreambuf_iterator<char>());
+        }
+
+        static Telegram telegram(size_t size, uint8_t fill, Timestamp stamp)
+        {
+            Telegram telegram(size);
+            std::fill(telegram.message.begin(), telegram.message.end(), fill);
+            telegram.type = telegram_type::SBF;
+            telegram.stamp = stamp;
+            return telegram;
+        }
+
+        //! SBF block with the Mode and Error fields of PVT and INS blocks
+        static Telegram block(uint16_t id, uint8_t mode, uint8_t error)
+        {
+            Telegram telegram = FlightRecorderTest::telegram(20, 0, 1000);
+            telegram.message[0] = SYNC_BYTE_1;
+            telegram.message[1] = SBF_SYNC_BYTE_2;
+            telegram.message[4] = static_cast<uint8_t>(id & 0xFF);
+            telegram.message[5] = static_cast<uint8_t>(id >> 8);
+            telegram.message[6] = 20;
+            telegram.message[14] = mode;
+            telegram.message[15] = error;
+            return telegram;
+        }
+
+        static bool waitForDumps(const io::FlightRecorder& recorder, uint64_t dumps)
+        {
+            for (int i = 0; i < 500; ++i)
+            {
+                if (recorder.statistics().dumps >= dumps)
+                    return true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            return false;
+        }
+
+        std::string directory_;
+    };
+} // namespace
+
+TEST_F(FlightRecorderTest, dumpsLatestTelegramsAfterWrap)
+{
+    RecorderNode node(directory_);
+    io::FlightRecorder recorder(&node);
+
+    // 17 telegrams of 60000 bytes fit into the ring of 1 MB
+    std::vector<uint8_t> expected;
+    for (uint8_t i = 0; i < 40; ++i)
+    {
+        Telegram t = telegram(60000, i, 1000);
+        recorder.add(t);
+        if (i >= 23)
+            expected.insert(expected.end(), t.message.begin(), t.message.end());
+    }
+    EXPECT_TRUE(recorder.trigger("test", std::chrono::nanoseconds(0)));
+    ASSERT_TRUE(waitForDumps(recorder, 1));
+
+    std::vector<std::string> paths = files();
+    ASSERT_EQ(paths.size(), 1u);
+    EXPECT_NE(paths[0].find("_test.sbf"), std::string::npos);
+    EXPECT_EQ(read(paths[0]), expected);
+}
+
+TEST_F(FlightRecorderTest, skipsTelegramsLargerThanRing)
+{
+    RecorderNode node(directory_);
+    io::FlightRecorder recorder(&node);
+
+    recorder.add(telegram(2 * 1024 * 1024, 1, 1000));
+    EXPECT_EQ(recorder.statistics().skippedTelegrams, 1u);
+}
+
+TEST_F(FlightRecorderTest, dumpsDuration)
+{
+    RecorderNode node(directory_);
+    node.mutableSettings().flight_recorder_duration = 2.5;
+    io::FlightRecorder recorder(&node);
+
+    std::vector<uint8_t> expected;
+    for (uint8_t i = 0; i < 10; ++i)
+    {
+        Telegram t = telegram(100, i, 1000000000ull * (i + 1));
+        recorder.add(t);
+        if (i >= 7)
+            expected.insert(expected.end(), t.message.begin(), t.message.end());
+    }
+    EXPECT_TRUE(recorder.trigger("test", std::chrono::nanoseconds(0)));
+    ASSERT_TRUE(waitForDumps(recorder, 1));
+
+    std::vector<std::string> paths = files();
+    ASSERT_EQ(paths.size(), 1u);
+    EXPECT_EQ(read(paths[0]), expected);
+}
+
+TEST_F(FlightRecorderTest, triggersOnPvtModeDrop)
+{
+    RecorderNode node(directory_);
+    node.mutableSettings().flight_recorder_triggers = {"pvt_mode_drop"};
+    io::FlightRecorder recorder(&node);
+
+    recorder.add(block(4007, 1, 0));    // Stand-Alone
+    recorder.add(block(4007, 0x44, 0)); // RTK fixed, 2D flag set
+    EXPECT_EQ(recorder.statistics().triggers, 0u);
+    recorder.add(block(4007, 5, 0)); // RTK float
+    ASSERT_TRUE(waitForDumps(recorder, 1));
+    recorder.add(block(4006, 4, 0)); // RTK fixed
+
+    std::vector<std::string> paths = files();
+    ASSERT_EQ(paths.size(), 1u);
+    EXPECT_NE(paths[0].find("_pvt_mode_drop.sbf"), std::string::npos);
+    EXPECT_EQ(read(paths[0]).size(), 60u);
+    EXPECT_EQ(recorder.statistics().triggers, 1u);
+}
+
+TEST_F(FlightRecorderTest, triggersOnceOnInsError)
+{
+    RecorderNode node(directory_);
+    node.mutableSettings().flight_recorder_triggers = {"ins_error"};
+    io::FlightRecorder recorder(&node);
+
+    recorder.add(block(4226, 0, 0));
+    recorder.add(block(4226, 0, 1));
+    ASSERT_TRUE(waitForDumps(recorder, 1));
+    recorder.add(block(4225, 0, 1));
+    recorder.add(block(4226, 0, 2));
+    EXPECT_EQ(recorder.statistics().triggers, 1u);
+
+    std::vector<std::string> paths = files();
+    ASSERT_EQ(paths.size(), 1u);
+    EXPECT_NE(paths[0].find("_ins_error.sbf"), std::string::npos);
+}
+
+TEST_F(FlightRecorderTest, ignoresDisabledTriggers)
+{
+    RecorderNode node(directory_);
+    node.mutableSettings().flight_recorder_triggers = {};
+    io::FlightRecorder recorder(&node);
+
+    recorder.add(block(4007, 4, 0));
+    recorder.add(block(4007, 1, 0));
+    recorder.add(block(4226, 0, 1));
+    EXPECT_EQ(recorder.statistics().triggers, 0u);
+}
+
+TEST_F(FlightRecorderTest, triggersOnCrcStorm)
+{
+    RecorderNode node(directory_);
+    node.mutableSettings().flight_recorder_triggers = {"crc_storm"};
+    node.mutableSettings().flight_recorder_crc_storm = 5;
+    io::FlightRecorder recorder(&node);
+
+    std::atomic<uint64_t> crcFailures{100};
+    recorder.monitorCrcFailures([&crcFailures]() { return crcFailures.load(); });
+    recorder.add(telegram(100, 1, 1000));
+    // The first check takes the current count as reference
+    std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+    crcFailures += 5;
+    ASSERT_TRUE(waitForDumps(recorder, 1));
+
+    std::vector<std::string> paths = files();
+    ASSERT_EQ(paths.size(), 1u);
+    EXPECT_NE(paths[0].find("_crc_storm.sbf"), std::string::npos);
+}
+
+TEST_F(FlightRecorderTest, mergesTriggersIntoPendingDump)
+{
+    RecorderNode node(directory_);
+    io::FlightRecorder recorder(&node);
+
+    recorder.add(telegram(100, 1, 1000));
+    EXPECT_TRUE(recorder.trigger("first", std::chrono::seconds(60)));
+    EXPECT_FALSE(recorder.trigger("second", std::chrono::nanoseconds(0)));
+    // Closing writes the pending dump without waiting
+    recorder.close();
+    EXPECT_EQ(recorder.statistics().dumps, 1u);
+    EXPECT_EQ(recorder.statistics().triggers, 2u);
+    EXPECT_FALSE(recorder.trigger("third", std::chrono::nanoseconds(0)));
+
+    std::vector<std::string> paths = files();
+    ASSERT_EQ(paths.size(), 1u);
+    EXPECT_NE(paths[0].find("_first.sbf"), std::string::npos);
+}
@@ -0,0 +1,159 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <septentrio_gnss_driver/communication/io_context_pool.hpp>
+
+TEST(IoContextPoolTest, strandSerializesHandlers)
+{
+    io::IoContextPool pool(4);
+    EXPECT_EQ(pool.threads(), 4u);
+    EXPECT_GE(io::processThreadCount(), 5u);
+
+    io::IoExecutor strand = pool.makeStrand();
+    std::atomic<int> running(0);
+    std::atomic<int> maxRunning(0);
+    std::atomic<int> done(0);
+    for (int i = 0; i < 100; ++i)
+    {
+        boost::asio::post(strand, [&]() {
+            int now = ++running;
+            if (now > maxRunning)
+                maxRunning = now;
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            --running;
+            ++done;
+        });
+    }
+    while (done < 100)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    EXPECT_EQ(maxRunning, 1);
+    pool.stop();
+    EXPECT_GE(pool.cpuTime(), 0.0);
+    EXPECT_GT(io::processCpuTime(), 0.0);
+}
+
+TEST(IoContextPoolTest, atLeastOneThread)
+{
+    io::IoContextPool pool(0);
+    EXPECT_EQ(pool.threads(), 1u);
+
+    std::atomic<bool> ran(false);
+    boost::asio::post(pool.makeStrand(), [&]() { ran = true; });
+    while (!ran)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+TEST(IoContextPoolTest, translatesThreadSettings)
+{
+    ThreadSettings settings;
+    settings.cpus = "0-1";
+    settings.policy = "fifo";
+    settings.priority = 10;
+    io::ThreadScheduling scheduling;
+    std::string error;
+    EXPECT_TRUE(io::toThreadScheduling(settings, scheduling, error)) << error;
+    EXPECT_EQ(scheduling.cpus, std::vector<int>({0, 1}));
+    EXPECT_EQ(scheduling.policy, SCHED_FIFO);
+    EXPECT_EQ(scheduling.priority, 10);
+
+    settings.cpus = "x";
+    settings.policy = "batch";
+    EXPECT_FALSE(io::toThreadScheduling(settings, scheduling, error));
+    EXPECT_NE(error.find("CPU list"), std::string::npos);
+    EXPECT_NE(error.find("scheduling policy"), std::string::npos);
+    EXPECT_TRUE(scheduling.cpus.empty());
+    EXPECT_EQ(scheduling.policy, SCHED_OTHER);
+}
+
+TEST(IoContextPoolTest, probesSchedulingLatency)
+{
+    io::IoContextPool pool(1);
+    std::string error;
+    EXPECT_TRUE(pool.configure(ThreadSettings(), error)) << error;
+
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(3 * io::SCHEDULING_PROBE_INTERVAL_MS + 50));
+    const io::SchedulingLatency& latency = pool.schedulingLatency(0);
+    EXPECT_GE(latency.count, 2u);
+    EXPECT_GE(latency.maxNs, latency.sumNs / latency.count);
+}
+
+TEST(IoContextPoolTest, probesEachThread)
+{
+    io::IoContextPool pool(2);
+    EXPECT_EQ(io::IoContextPool::threadName(1), "septentrio_io1");
+
+    // Keeps one thread busy, the other one runs all probes meanwhile
+    std::atomic<bool> busy(true);
+    boost::asio::post(pool.makeStrand(), [&]() {
+        while (busy)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(3 * io::SCHEDULING_PROBE_INTERVAL_MS + 50));
+    uint64_t first = pool.schedulingLatency(0).count;
+    uint64_t second = pool.schedulingLatency(1).count;
+    busy = false;
+    EXPECT_GE(first + second, 4u);
+    // Only the idle thread ran the probes
+    EXPECT_TRUE((first == 0) || (second == 0));
+}
+
+TEST(IoContextPoolTest, cpuTimeWhileStopping)
+{
+    io::IoContextPool pool(4);
+    std::atomic<bool> reading(true);
+    double last = 0.0;
+    bool monotonic = true;
+    // The diagnostics read the CPU time from another thread
+    std::thread diagnostics([&]() {
+        while (reading)
+        {
+            double now = pool.cpuTime();
+            monotonic = monotonic && (now >= last);
+            last = now;
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    pool.stop();
+    reading = false;
+    diagnostics.join();
+
+    EXPECT_TRUE(monotonic);
+    EXPECT_GE(pool.cpuTime(), last);
+}
@@ -0,0 +1,260 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <septentrio_gnss_driver/communication/pcap_decoder.hpp>
+
+namespace {
+    const uint32_t RX_ADDRESS = 0x0A000002;   // 10.0.0.2
+    const uint32_t HOST_ADDRESS = 0x0A000001; // 10.0.0.1
+    const uint16_t RX_PORT = 28784;
+    const uint16_t HOST_PORT = 50000;
+    const uint8_t SYN = 0x02;
+    const uint8_t ACK = 0x10;
+
+    void put16(std::vector<uint8_t>& frame, size_t offset, uint16_t value)
+    {
+        frame[offset] = value >> 8;
+        frame[offset + 1] = value & 0xFF;
+    }
+
+    void put32(std::vector<uint8_t>& frame, size_t offset, uint32_t value)
+    {
+        put16(frame, offset, value >> 16);
+        put16(frame, offset + 2, value & 0xFFFF);
+    }
+
+    //! IPv4 packet with a TCP or UDP header, checksums are not verified
+    std::vector<uint8_t> ipPacket(uint8_t protocol, uint32_t src, uint16_t srcPort,
+                                  uint32_t dst, uint16_t dstPort, uint32_t seq,
+                                  uint8_t flags, const std::string& payload)
+    {
+        size_t transportSize = (protocol == 6) ? 20 : 8;
+        std::vector<uint8_t> packet(20 + transportSize);
+        packet[0] = 0x45;
+        put16(packet, 2, static_cast<uint16_t>(packet.size() + payload.size()));
+        put16(packet, 6, 0x4000); // don't fragment
+        packet[8] = 64;
+        packet[9] = protocol;
+        put32(packet, 12, src);
+        put32(packet, 16, dst);
+        put16(packet, 20, srcPort);
+        put16(packet, 22, dstPort);
+        if (protocol == 6)
+        {
+            put32(packet, 24, seq);
+            packet[32] = 5 << 4;
+            packet[33] = flags;
+        } else
+            put16(packet, 24, static_cast<uint16_t>(8 + payload.size()));
+        packet.insert(packet.end(), payload.begin(), payload.end());
+        return packet;
+    }
+
+    std::vector<uint8_t> ethernet(const std::vector<uint8_t>& packet,
+                                  bool vlan = false)
+    {
+        std::vector<uint8_t> frame(12, 0x11);
+        if (vlan)
+            frame.insert(frame.end(), {0x81, 0x00, 0x00, 0x05});
+        frame.insert(frame.end(), {0x08, 0x00});
+        frame.insert(frame.end(), packet.begin(), packet.end());
+        // Ethernet pads frames to 60 bytes
+        if (frame.size() < 60)
+            frame.resize(60, 0);
+        return frame;
+    }
+
+    std::vector<uint8_t> rxSegment(uint32_t seq, const std::string& payload,
+                                   uint8_t flags = ACK,
+                                   uint16_t hostPort = HOST_PORT)
+    {
+        return ethernet(ipPacket(6, RX_ADDRESS, RX_PORT, HOST_ADDRESS, hostPort, seq,
+                                 flags, payload));
+    }
+
+    class PcapDecoderTest : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            ASSERT_TRUE(decoder.reset(io::link_type::ETHERNET, RX_ADDRESS, RX_PORT));
+            sink = [this](const uint8_t* data, size_t size) {
+                stream.append(reinterpret_cast<const char*>(data), size);
+            };
+        }
+
+        void decode(const std::vector<uint8_t>& frame)
+        {
+            decoder.decode(frame.data(), frame.size(), sink);
+        }
+
+        io::PcapDecoder decoder;
+        io::PcapDecoder::PayloadSink sink;
+        std::string stream;
+    };
+} // namespace
+
+TEST_F(PcapDecoderTest, tcpInOrder)
+{
+    decode(rxSegment(999, "", SYN | ACK));
+    decode(rxSegment(1000, "$@abc"));
+    decode(rxSegment(1005, "def"));
+    decode(rxSegment(1008, "$GPGGA\r\n"));
+
+    EXPECT_EQ(stream, "$@abcdef$GPGGA\r\n");
+    EXPECT_TRUE(decoder.locked());
+    EXPECT_EQ(decoder.streamName(), "TCP 10.0.0.2:28784 -> 10.0.0.1:50000");
+    EXPECT_EQ(decoder.statistics().bytes, stream.size());
+    EXPECT_EQ(decoder.statistics().connections, 1u);
+}
+
+TEST_F(PcapDecoderTest, tcpReorderedAndRetransmitted)
+{
+    decode(rxSegment(999, "", SYN | ACK));
+    decode(rxSegment(1000, "$@01"));
+    decode(rxSegment(1008, "67"));
+    decode(rxSegment(1004, "2345"));
+    // Retransmission of data already passed on
+    decode(rxSegment(1002, "012345"));
+    // Retransmission overlapping passed on and new data
+    decode(rxSegment(1008, "6789ab"));
+
+    EXPECT_EQ(stream, "$@0123456789ab");
+    EXPECT_EQ(decoder.statistics().outOfOrderSegments, 1u);
+    EXPECT_EQ(decoder.statistics().duplicateBytes, 8u);
+    EXPECT_EQ(decoder.statistics().lostBytes, 0u);
+}
+
+TEST_F(PcapDecoderTest, tcpSequenceWrapAround)
+{
+    decode(rxSegment(0xFFFFFFFD, "", SYN | ACK));
+    decode(rxSegment(0xFFFFFFFE, "$@"));
+    decode(rxSegment(2, "cd"));
+    decode(rxSegment(0, "ab"));
+
+    EXPECT_EQ(stream, "$@abcd");
+}
+
+TEST_F(PcapDecoderTest, otherFlowsSkipped)
+{
+    // Command sent to the Rx, other host and other port of the Rx
+    decode(ethernet(
+        ipPacket(6, HOST_ADDRESS, HOST_PORT, RX_ADDRESS, RX_PORT, 1, ACK, "$@x")));
+    decode(ethernet(
+        ipPacket(6, 0x0A000003, RX_PORT, HOST_ADDRESS, HOST_PORT, 1, ACK, "$@x")));
+    decode(ethernet(
+        ipPacket(17, RX_ADDRESS, 28785, HOST_ADDRESS, HOST_PORT, 0, 0, "$@x")));
+    // Not IPv4
+    std::vector<uint8_t> arp = ethernet({});
+    arp[12] = 0x08;
+    arp[13] = 0x06;
+    decode(arp);
+    decode(rxSegment(1000, "$@abc"));
+
+    EXPECT_EQ(stream, "$@abc");
+    EXPECT_EQ(decoder.statistics().packets, 5u);
+    EXPECT_EQ(decoder.statistics().skippedPackets, 4u);
+}
+
+TEST_F(PcapDecoderTest, locksOnFirstStreamWithSync)
+{
+    ASSERT_TRUE(decoder.reset(io::link_type::ETHERNET, 0, 0));
+    // The connection descriptor and HTTP traffic precede the telegrams
+    decode(rxSegment(1000, "IP10>"));
+    decode(ethernet(
+        ipPacket(6, RX_ADDRESS, 80, HOST_ADDRESS, 40000, 1, ACK, "HTTP/1.1")));
+    decode(rxSegment(1005, "$R: setSBFOutput\r\n"));
+    decode(rxSegment(1023, "$@abc"));
+
+    EXPECT_EQ(stream, "$R: setSBFOutput\r\n$@abc");
+    EXPECT_EQ(decoder.streamName(), "TCP 10.0.0.2:28784 -> 10.0.0.1:50000");
+}
+
+TEST_F(PcapDecoderTest, missingDataSkippedOnFlush)
+{
+    decode(rxSegment(999, "", SYN | ACK));
+    decode(rxSegment(1000, "$@ab"));
+    decode(rxSegment(1010, "$@cd"));
+    EXPECT_EQ(stream, "$@ab");
+
+    decoder.flush(sink);
+    EXPECT_EQ(stream, "$@ab$@cd");
+    EXPECT_EQ(decoder.statistics().lostBytes, 6u);
+}
+
+TEST_F(PcapDecoderTest, followsNewConnection)
+{
+    decode(rxSegment(999, "", SYN | ACK));
+    decode(rxSegment(1000, "$@ab"));
+    // Reconnected, the pending segment of the old connection is dropped
+    decode(rxSegment(1010, "xx"));
+    decode(rxSegment(5000, "", SYN | ACK, HOST_PORT + 1));
+    decode(rxSegment(1004, "yy"));
+    decode(rxSegment(5001, "$@cd", ACK, HOST_PORT + 1));
+
+    EXPECT_EQ(stream, "$@ab$@cd");
+    EXPECT_EQ(decoder.statistics().connections, 2u);
+}
+
+TEST_F(PcapDecoderTest, udpAndLinkTypes)
+{
+    std::vector<uint8_t> packet =
+        ipPacket(17, RX_ADDRESS, RX_PORT, HOST_ADDRESS, HOST_PORT, 0, 0, "$@udp");
+
+    std::vector<uint8_t> sll(16, 0);
+    put16(sll, 14, 0x0800);
+    sll.insert(sll.end(), packet.begin(), packet.end());
+    ASSERT_TRUE(decoder.reset(io::link_type::LINUX_SLL, RX_ADDRESS, RX_PORT));
+    decode(sll);
+
+    ASSERT_TRUE(decoder.reset(io::link_type::RAW, RX_ADDRESS, RX_PORT));
+    decode(packet);
+
+    ASSERT_TRUE(decoder.reset(io::link_type::ETHERNET, RX_ADDRESS, RX_PORT));
+    decode(ethernet(packet, true));
+
+    EXPECT_EQ(stream, "$@udp$@udp$@udp");
+    EXPECT_FALSE(decoder.reset(147, RX_ADDRESS, RX_PORT));
+}
+
+TEST_F(PcapDecoderTest, fragmentsSkipped)
+{
+    std::vector<uint8_t> packet =
+        ipPacket(17, RX_ADDRESS, RX_PORT, HOST_ADDRESS, HOST_PORT, 0, 0, "$@frag");
+    put16(packet, 6, 0x2000); // more fragments
+    decode(ethernet(packet));
+
+    EXPECT_TRUE(stream.empty());
+    EXPECT_EQ(decoder.statistics().fragments, 1u);
+}
@@ -0,0 +1,277 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include <septentrio_gnss_driver/communication/raw_recorder.hpp>
+
+namespace {
+    //! Nodes can only be created after rclcpp is initialized
+    class RclcppEnvironment : public ::testing::Environment
+    {
+    public:
+        void SetUp() override { rclcpp::init(0, nullptr); }
+        void TearDown() override { rclcpp::shutdown(); }
+    };
+
+    ::testing::Environment* const rclcppEnvironment =
+        ::testing::AddGlobalTestEnvironment(new RclcppEnvironment);
+
+    class RecorderNode : public ROSaicNodeBase
+    {
+    public:
+        explicit RecorderNode(const std::string& directory) :
+            ROSaicNodeBase(rclcpp::NodeOptions())
+        {
+            settings_.record_directory = directory;
+            settings_.record_buffer_size = 4096;
+            settings_.record_buffer_count = 4;
+        }
+
+        Settings& mutableSettings() { return settings_; }
+
+    private:
+        void sendVelocity(const std::string& /*velNmea*/) {}
+    };
+
+    class RawRecorderTest : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            directory_ = "/tmp/test_raw_recorder_" + std::to_string(getpid());
+            std::filesystem::remove_all(directory_);
+        }
+
+        void TearDown() override { std::filesystem::remove_all(directory_); }
+
+        //! Files of the directory in order of their names
+        std::vector<std::string> files() const
+        {
+            std::vector<std::string> paths;
+            for (const auto& entry : std::filesystem::directory_iterator(directory_))
+                paths.push_back(entry.path().string());
+            std::sort(paths.begin(), paths.end());
+            return paths;
+        }
+
+        static std::vector<uint8_t> read(const std::string& path)
+        {
+            std::ifstream file(path, std::ios::binary);
+            return std::vector<uint8_t>(std::istreambuf_iterator<char>(file),
+                                        std::istreambuf_iterator<char>());
+        }
+
+        static std::vector<uint8_t> stream(size_t size)
+        {
+            std::vector<uint8_t> data(size);
+            for (size_t i = 0; i < size; ++i)
+                data[i] = static_cast<uint8_t>((i * 7) ^ (i >> 8));
+            return data;
+        }
+
+        std::string directory_;
+    };
+} // namespace
+
+TEST_F(RawRecorderTest, recordsChunksAcrossBuffers)
+{
+    auto node = std::make_shared<RecorderNode>(directory_);
+    std::vector<uint8_t> data = stream(10000);
+    {
+        io::RawRecorder recorder(node.get());
+        ASSERT_TRUE(recorder.running());
+        io::RecordChannel* channel = recorder.channel("main");
+        size_t sizes[] = {1, 4095, 5000, 3, 901};
+        size_t offset = 0;
+        for (size_t size : sizes)
+        {
+            channel->record(data.data() + offset, size);
+            offset += size;
+        }
+        ASSERT_EQ(offset, data.size());
+        recorder.close();
+
+        EXPECT_EQ(recorder.statistics().bytes, data.size());
+        EXPECT_EQ(recorder.statistics().bytesWritten, data.size());
+        EXPECT_EQ(recorder.statistics().files, 1u);
+        EXPECT_EQ(recorder.statistics().droppedBytes, 0u);
+        EXPECT_GE(recorder.statistics().writes, 3u);
+        // Ignored after closing
+        channel->record(data.data(), data.size());
+    }
+
+    std::vector<std::string> paths = files();
+    ASSERT_EQ(paths.size(), 1u);
+    EXPECT_EQ(std::filesystem::path(paths[0]).filename().string().rfind("main_", 0),
+              0u);
+    EXPECT_EQ(read(paths[0]), data);
+}
+
+TEST_F(RawRecorderTest, separatesChannels)
+{
+    auto node = std::make_shared<RecorderNode>(directory_);
+    std::vector<uint8_t> data = stream(6000);
+    {
+        io::RawRecorder recorder(node.get());
+        io::RecordChannel* main = recorder.channel("main");
+        io::RecordChannel* udp = recorder.channel("udp");
+        for (size_t offset = 0; offset < data.size(); offset += 1000)
+        {
+            main->record(data.data() + offset, 1000);
+            udp->record(data.data() + data.size() - offset - 1000, 1000);
+        }
+    }
+
+    std::vector<std::string> paths = files();
+    ASSERT_EQ(paths.size(), 2u);
+    EXPECT_EQ(read(paths[0]), data);
+    std::vector<uint8_t> udp = read(paths[1]);
+    ASSERT_EQ(udp.size(), data.size());
+    EXPECT_TRUE(std::equal(udp.begin(), udp.begin() + 1000, data.end() - 1000));
+}
+
+TEST_F(RawRecorderTest, rotatesFilesBySize)
+{
+    auto node = std::make_shared<RecorderNode>(directory_);
+    node->mutableSettings().record_max_file_size = 1;
+    node->mutableSettings().record_max_files = 2;
+    node->mutableSettings().record_buffer_count = 1024;
+    std::vector<uint8_t> data = stream(3500000);
+    {
+        io::RawRecorder recorder(node.get());
+        io::RecordChannel* channel = recorder.channel("tcp");
+        for (size_t offset = 0; offset < data.size(); offset += 10000)
+            channel->record(data.data() + offset, 10000);
+        recorder.close();
+        EXPECT_GE(recorder.statistics().files, 4u);
+        EXPECT_EQ(recorder.statistics().droppedBytes, 0u);
+    }
+
+    // A file is rotated at the first buffer after exceeding 1 MB, the oldest
+    // files are deleted
+    std::vector<std::string> paths = files();
+    ASSERT_EQ(paths.size(), 2u);
+    std::vector<uint8_t> previous = read(paths[0]);
+    std::vector<uint8_t> last = read(paths[1]);
+    EXPECT_GE(previous.size(), 1000000u);
+    EXPECT_LT(previous.size(), 1000000u + 4096u);
+    ASSERT_LT(previous.size() + last.size(), data.size());
+    auto tail = data.end() - last.size();
+    EXPECT_TRUE(std::equal(last.begin(), last.end(), tail));
+    EXPECT_TRUE(
+        std::equal(previous.begin(), previous.end(), tail - previous.size()));
+}
+
+TEST_F(RawRecorderTest, accountsForDroppedBytes)
+{
+    auto node = std::make_shared<RecorderNode>(directory_);
+    node->mutableSettings().record_buffer_count = 2;
+    std::vector<uint8_t> data = stream(4096);
+    uint64_t bytes;
+    {
+        io::RawRecorder recorder(node.get());
+        io::RecordChannel* channel = recorder.channel("main");
+        // Faster than the writer may keep up with two buffers
+        for (size_t i = 0; i < 1000; ++i)
+            channel->record(data.data(), data.size());
+        recorder.close();
+        const io::RecorderStatistics& stats = recorder.statistics();
+        EXPECT_EQ(stats.bytes, 1000 * data.size());
+        EXPECT_EQ(stats.bytesWritten + stats.droppedBytes, stats.bytes);
+        EXPECT_EQ(stats.droppedChunks * data.size(), stats.droppedBytes);
+        bytes = stats.bytesWritten;
+    }
+    std::vector<std::string> paths = files();
+    ASSERT_EQ(paths.size(), 1u);
+    EXPECT_EQ(read(paths[0]).size(), bytes);
+}
+
+TEST_F(RawRecorderTest, writesDirectIo)
+{
+    auto node = std::make_shared<RecorderNode>(directory_);
+    node->mutableSettings().record_direct_io = true;
+    std::vector<uint8_t> data = stream(10000);
+    {
+        io::RawRecorder recorder(node.get());
+        io::RecordChannel* channel = recorder.channel("main");
+        channel->record(data.data(), data.size());
+        recorder.close();
+        if (recorder.statistics().files == 0)
+            GTEST_SKIP() << "O_DIRECT is not supported by the file system";
+    }
+
+    // The padding of the last block is truncated
+    std::vector<std::string> paths = files();
+    ASSERT_EQ(paths.size(), 1u);
+    EXPECT_EQ(read(paths[0]), data);
+}
+
+#ifdef HAVE_ZSTD
+TEST_F(RawRecorderTest, compressesFiles)
+{
+    auto node = std::make_shared<RecorderNode>(directory_);
+    node->mutableSettings().record_compression_level = 3;
+    node->mutableSettings().record_buffer_count = 32;
+    std::vector<uint8_t> data = stream(100000);
+    {
+        io::RawRecorder recorder(node.get());
+        io::RecordChannel* channel = recorder.channel("main");
+        channel->record(data.data(), data.size());
+        recorder.close();
+        EXPECT_LT(recorder.statistics().bytesWritten, data.size());
+    }
+
+    std::vector<std::string> paths = files();
+    ASSERT_EQ(paths.size(), 1u);
+    EXPECT_EQ(paths[0].substr(paths[0].size() - 8), ".sbf.zst");
+    std::vector<uint8_t> compressed = read(paths[0]);
+    std::vector<uint8_t> decompressed(2 * data.size());
+    ZSTD_DCtx* dctx = ZSTD_createDCtx();
+    ZSTD_inBuffer input = {compressed.data(), compressed.size(), 0};
+    ZSTD_outBuffer output = {decompressed.data(), decompressed.size(), 0};
+    while (input.pos < input.size)
+        ASSERT_FALSE(ZSTD_isError(ZSTD_decompressStream(dctx, &output, &input)));
+    ZSTD_freeDCtx(dctx);
+    decompressed.resize(output.pos);
+    EXPECT_EQ(decompressed, data);
+}
+#endif
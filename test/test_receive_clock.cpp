@@ -0,0 +1,150 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <gtest/gtest.h>
+
+#include <netinet/in.h>
+#include <unistd.h>
+
+#include <septentrio_gnss_driver/communication/receive_clock.hpp>
+
+namespace {
+    //! Nodes can only be created after rclcpp is initialized
+    class RclcppEnvironment : public ::testing::Environment
+    {
+    public:
+        void SetUp() override { rclcpp::init(0, nullptr); }
+        void TearDown() override { rclcpp::shutdown(); }
+    };
+
+    ::testing::Environment* const rclcppEnvironment =
+        ::testing::AddGlobalTestEnvironment(new RclcppEnvironment);
+
+    class ClockNode : public ROSaicNodeBase
+    {
+    public:
+        ClockNode() : ROSaicNodeBase(rclcpp::NodeOptions()) {}
+
+    private:
+        void sendVelocity(const std::string& /*velNmea*/) {}
+    };
+
+    int64_t absDiff(Timestamp a, Timestamp b)
+    {
+        return (a > b) ? static_cast<int64_t>(a - b) : static_cast<int64_t>(b - a);
+    }
+
+    const int64_t TOLERANCE_NS = 5000000;
+} // namespace
+
+TEST(ReceiveClockTest, followsRosTime)
+{
+    auto node = std::make_shared<ClockNode>();
+    io::ReceiveClock clock(node.get());
+
+    EXPECT_LT(absDiff(clock.now(), node->getTime()), TOLERANCE_NS);
+
+    timespec realtime;
+    clock_gettime(CLOCK_REALTIME, &realtime);
+    EXPECT_LT(absDiff(clock.fromKernel(realtime), node->getTime()), TOLERANCE_NS);
+
+    // Monotonic between calibrations
+    Timestamp previous = clock.now();
+    for (int i = 0; i < 1000; ++i)
+    {
+        Timestamp current = clock.now();
+        EXPECT_GE(current, previous);
+        previous = current;
+    }
+}
+
+TEST(ReceiveClockTest, kernelDelay)
+{
+    auto node = std::make_shared<ClockNode>();
+    io::ReceiveClock clock(node.get());
+
+    clock.recordKernelDelay(1000000, 1010000);
+    clock.recordKernelDelay(1000000, 1030000);
+    clock.recordKernelDelay(1000000, 900000);
+    EXPECT_EQ(clock.statistics().count, 3u);
+    EXPECT_EQ(clock.statistics().delaySumNs, 40000u);
+    EXPECT_EQ(clock.statistics().delayMaxNs, 30000u);
+    EXPECT_EQ(clock.statistics().delaySqSumUs2, 1000u);
+}
+
+TEST(ReceiveClockTest, kernelTimestampOfDatagram)
+{
+    auto node = std::make_shared<ClockNode>();
+    io::ReceiveClock clock(node.get());
+
+    int receiver = socket(AF_INET, SOCK_DGRAM, 0);
+    int sender = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(receiver, 0);
+    ASSERT_GE(sender, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(bind(receiver, reinterpret_cast<sockaddr*>(&address),
+                   sizeof(address)),
+              0);
+    socklen_t length = sizeof(address);
+    getsockname(receiver, reinterpret_cast<sockaddr*>(&address), &length);
+    ASSERT_TRUE(io::enableKernelTimestamps(receiver));
+
+    uint8_t buffer[16];
+    timespec stamp;
+    EXPECT_LT(io::receiveWithTimestamp(receiver, buffer, sizeof(buffer), nullptr,
+                                       nullptr, stamp),
+              0);
+
+    const char data[] = "$@";
+    ASSERT_EQ(sendto(sender, data, 2, 0, reinterpret_cast<sockaddr*>(&address),
+                     sizeof(address)),
+              2);
+    sockaddr_in from{};
+    socklen_t fromLen = sizeof(from);
+    ssize_t received = -1;
+    for (int i = 0; (i < 1000) && (received < 0); ++i)
+    {
+        received = io::receiveWithTimestamp(receiver, buffer, sizeof(buffer),
+                                            reinterpret_cast<sockaddr*>(&from),
+                                            &fromLen, stamp);
+        if (received < 0)
+            usleep(1000);
+    }
+    ASSERT_EQ(received, 2);
+    EXPECT_EQ(fromLen, sizeof(from));
+    EXPECT_EQ(from.sin_addr.s_addr, htonl(INADDR_LOOPBACK));
+    ASSERT_NE(stamp.tv_sec, 0);
+    EXPECT_LT(absDiff(clock.fromKernel(stamp), node->getTime()), 1000000000);
+
+    close(sender);
+    close(receiver);
+}
@@ -0,0 +1,202 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <septentrio_gnss_driver/communication/replay_clock.hpp>
+#include <septentrio_gnss_driver/communication/telegram_queue.hpp>
+#include <septentrio_gnss_driver/parsers/parsing_utilities.hpp>
+
+using namespace std::chrono_literals;
+
+namespace {
+    const uint64_t MS = 1000000;
+    //! Arbitrary log start, e.g. some time in 2026
+    const uint64_t START = 1790000000000000000;
+
+    std::shared_ptr<Telegram> sbfTelegram(uint16_t id, Timestamp stamp)
+    {
+        auto telegram = std::make_shared<Telegram>(SBF_HEADER_SIZE);
+        telegram->type = telegram_type::SBF;
+        telegram->stamp = stamp;
+        telegram->message[0] = SYNC_BYTE_1;
+        telegram->message[1] = SBF_SYNC_BYTE_2;
+        telegram->message[4] = id & 0xFF;
+        telegram->message[5] = id >> 8;
+        telegram->message[6] = SBF_HEADER_SIZE;
+        return telegram;
+    }
+
+    double elapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+            .count();
+    }
+} // namespace
+
+TEST(ReplayClockTest, unthrottled)
+{
+    io::ReplayClock clock(0.0);
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < 1000; ++i)
+        EXPECT_TRUE(clock.waitUntil(START + i * 1000 * MS));
+    EXPECT_LT(elapsedMs(start), 100.0);
+    EXPECT_EQ(clock.time(), START + 999 * 1000 * MS);
+}
+
+TEST(ReplayClockTest, rateMultiplier)
+{
+    io::ReplayClock clock(10.0);
+    auto start = std::chrono::steady_clock::now();
+    // 400 ms of log at 10x
+    for (uint64_t i = 0; i <= 4; ++i)
+        EXPECT_TRUE(clock.waitUntil(START + i * 100 * MS));
+    EXPECT_GE(elapsedMs(start), 40.0);
+    EXPECT_LT(elapsedMs(start), 150.0);
+}
+
+TEST(ReplayClockTest, sameEpochNotDelayed)
+{
+    io::ReplayClock clock(1.0);
+    EXPECT_TRUE(clock.waitUntil(START));
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(clock.waitUntil(START));
+    EXPECT_FALSE(clock.waitUntil(START - 500 * MS));
+    EXPECT_LT(elapsedMs(start), 50.0);
+    EXPECT_EQ(clock.time(), START);
+    EXPECT_EQ(clock.earlierMessages(), 1u);
+}
+
+TEST(ReplayClockTest, pauseHoldsEarlierMessage)
+{
+    io::ReplayClock clock(0.0);
+    EXPECT_TRUE(clock.waitUntil(START + 10 * MS));
+    clock.pause();
+
+    std::atomic<bool> replayed{false};
+    std::thread replay([&]() {
+        EXPECT_FALSE(clock.waitUntil(START));
+        replayed = true;
+    });
+    std::this_thread::sleep_for(50ms);
+    EXPECT_FALSE(replayed);
+
+    clock.step();
+    replay.join();
+    EXPECT_EQ(clock.time(), START + 10 * MS);
+}
+
+TEST(ReplayClockTest, mixedInsPvtLogIsPaced)
+{
+    // 200 ms of a log with INS blocks at 50 Hz and PVT blocks at 10 Hz in
+    // between, as they are framed from the file
+    TelegramQueue queue;
+    queue.configure(64, overflow_policy::BLOCK, false, 0, false);
+    for (uint64_t t = 0; t <= 200; t += 20)
+    {
+        queue.push(sbfTelegram(4226, START + t * MS));
+        if (t % 100 == 0)
+            queue.push(sbfTelegram(4007, START + (t + 10) * MS));
+    }
+
+    io::ReplayClock clock(1.0);
+    auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<Telegram> telegram;
+    while (!queue.empty())
+    {
+        ASSERT_TRUE(queue.pop(telegram));
+        EXPECT_TRUE(clock.waitUntil(telegram->stamp));
+    }
+    EXPECT_EQ(clock.earlierMessages(), 0u);
+    EXPECT_EQ(clock.time(), START + 210 * MS);
+    EXPECT_GE(elapsedMs(start), 210.0);
+    EXPECT_LT(elapsedMs(start), 300.0);
+}
+
+TEST(ReplayClockTest, noDrift)
+{
+    io::ReplayClock clock(1.0);
+    auto start = std::chrono::steady_clock::now();
+    // Processing time between messages is absorbed by the schedule
+    for (uint64_t i = 0; i <= 20; ++i)
+    {
+        EXPECT_TRUE(clock.waitUntil(START + i * 10 * MS));
+        std::this_thread::sleep_for(3ms);
+    }
+    EXPECT_GE(elapsedMs(start), 200.0);
+    EXPECT_LT(elapsedMs(start), 200.0 + 20 * 3.0);
+}
+
+TEST(ReplayClockTest, pauseAndStep)
+{
+    io::ReplayClock clock(0.0);
+    EXPECT_TRUE(clock.waitUntil(START));
+    clock.pause();
+    EXPECT_TRUE(clock.paused());
+
+    std::atomic<int> replayed{0};
+    std::thread replay([&]() {
+        for (uint64_t i = 1; i <= 3; ++i)
+        {
+            if (clock.waitUntil(START + i * MS))
+                ++replayed;
+        }
+    });
+
+    std::this_thread::sleep_for(50ms);
+    EXPECT_EQ(replayed, 0);
+
+    clock.step();
+    std::this_thread::sleep_for(50ms);
+    EXPECT_EQ(replayed, 1);
+    EXPECT_EQ(clock.time(), START + MS);
+
+    clock.resume();
+    replay.join();
+    EXPECT_EQ(replayed, 3);
+}
+
+TEST(ReplayClockTest, closeReleasesPausedReplay)
+{
+    io::ReplayClock clock(1.0);
+    EXPECT_TRUE(clock.waitUntil(START));
+    clock.pause();
+
+    std::thread replay(
+        [&]() { EXPECT_TRUE(clock.waitUntil(START + 3600000 * MS)); });
+    std::this_thread::sleep_for(20ms);
+    clock.close();
+    replay.join();
+}
@@ -0,0 +1,113 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include <septentrio_gnss_driver/communication/rx_configuration.hpp>
+
+TEST(RxConfigurationTest, commandKey)
+{
+    EXPECT_EQ(io::commandKey("sso, Stream1, USB1, PVTCartesian, sec1"),
+              "sso, Stream1");
+    EXPECT_EQ(io::commandKey("sgd, WGS84"), "sgd, WGS84");
+    EXPECT_EQ(io::commandKey("grc"), "grc");
+}
+
+TEST(RxConfigurationTest, readBackCommands)
+{
+    std::vector<std::string> commands = {"sso, all, none, none, off",
+                                         "sso, Stream1, USB1, PVTCartesian, sec1",
+                                         "sao, Main, 0, 0, 0", "sntp, on",
+                                         "esoc, USB1, ReceiverSetup"};
+    EXPECT_EQ(io::readBackCommands(commands),
+              (std::vector<std::string>{"gso", "gao", "gntp"}));
+    EXPECT_TRUE(io::readBackCommands({"grc"}).empty());
+}
+
+TEST(RxConfigurationTest, delta)
+{
+    std::vector<std::string> applied = {"sso, all, none, none, off",
+                                        "sso, Stream1, USB1, PVTCartesian, sec1",
+                                        "sao, Main, 0, 0, 0"};
+    std::vector<std::string> required = applied;
+    std::vector<std::string> delta;
+
+    EXPECT_TRUE(io::configurationDelta(applied, required, delta));
+    EXPECT_TRUE(delta.empty());
+    EXPECT_EQ(io::configurationHash(applied), io::configurationHash(required));
+
+    required[1] = "sso, Stream1, USB1, PVTCartesian, msec100";
+    EXPECT_TRUE(io::configurationDelta(applied, required, delta));
+    ASSERT_EQ(delta.size(), 1u);
+    EXPECT_EQ(delta[0], required[1]);
+    EXPECT_NE(io::configurationHash(applied), io::configurationHash(required));
+
+    // Settings left over from the applied configuration require a full one
+    required.pop_back();
+    EXPECT_FALSE(io::configurationDelta(applied, required, delta));
+    required.push_back("sao, Aux1, 0, 0, 0");
+    EXPECT_FALSE(io::configurationDelta(applied, required, delta));
+}
+
+TEST(RxConfigurationTest, cache)
+{
+    std::string fileName = ::testing::TempDir() + "rx_configuration_cache";
+    std::remove(fileName.c_str());
+
+    io::RxConfiguration configuration;
+    configuration.commands = {"sso, all, none, none, off", "sao, Main, 0, 0, 0"};
+    configuration.hash = io::configurationHash(configuration.commands);
+    configuration.readBack = {"SBFOutput, Stream1, USB1, none, off"};
+    {
+        io::ConfigurationCache cache(fileName);
+        EXPECT_TRUE(cache.load());
+        EXPECT_EQ(cache.find("3034567"), nullptr);
+        cache.store("3034567", configuration);
+        cache.store("3000001", configuration);
+        cache.erase("3000001");
+        EXPECT_TRUE(cache.save());
+    }
+
+    io::ConfigurationCache cache(fileName);
+    EXPECT_TRUE(cache.load());
+    EXPECT_EQ(cache.find("3000001"), nullptr);
+    const io::RxConfiguration* loaded = cache.find("3034567");
+    ASSERT_NE(loaded, nullptr);
+    EXPECT_EQ(loaded->hash, configuration.hash);
+    EXPECT_EQ(loaded->commands, configuration.commands);
+    EXPECT_EQ(loaded->readBack, configuration.readBack);
+
+    std::ofstream(fileName) << "garbage\n";
+    EXPECT_FALSE(cache.load());
+    std::remove(fileName.c_str());
+}
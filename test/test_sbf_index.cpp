@@ -0,0 +1,226 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include <septentrio_gnss_driver/communication/mapped_file.hpp>
+#include <septentrio_gnss_driver/communication/sbf_index.hpp>
+#include <septentrio_gnss_driver/communication/telegram.hpp>
+#include <septentrio_gnss_driver/crc/crc.hpp>
+
+namespace {
+    std::vector<uint8_t> sbfBlock(uint16_t id, uint16_t length, uint32_t tow,
+                                  uint16_t wnc)
+    {
+        std::vector<uint8_t> block(length, 0x55);
+        block[0] = SYNC_BYTE_1;
+        block[1] = SBF_SYNC_BYTE_2;
+        block[4] = id & 0xFF;
+        block[5] = id >> 8;
+        block[6] = length & 0xFF;
+        block[7] = length >> 8;
+        for (size_t i = 0; i < 4; ++i)
+            block[8 + i] = (tow >> (8 * i)) & 0xFF;
+        block[12] = wnc & 0xFF;
+        block[13] = wnc >> 8;
+        uint16_t crc = crc::compute16CCITT(block.data() + 4, length - 4);
+        block[2] = crc & 0xFF;
+        block[3] = crc >> 8;
+        return block;
+    }
+
+    void append(std::vector<uint8_t>& log, const std::vector<uint8_t>& data)
+    {
+        log.insert(log.end(), data.begin(), data.end());
+    }
+
+    //! One PVTGeodetic and one AttEuler block per second, each epoch followed by
+    //! an NMEA sentence
+    std::vector<uint8_t> makeLog(uint32_t epochs)
+    {
+        std::vector<uint8_t> log;
+        std::string nmea = "$GPHDT,90.0,T*00\r\n";
+        for (uint32_t i = 0; i < epochs; ++i)
+        {
+            append(log, sbfBlock(4007, 96, 1000 * (100 + i), 2300));
+            append(log, sbfBlock(5938 | (1 << 13), 48, 1000 * (100 + i), 2300));
+            log.insert(log.end(), nmea.begin(), nmea.end());
+        }
+        return log;
+    }
+
+    double gpsTime(uint32_t towS) { return 2300 * 604800.0 + towS; }
+} // namespace
+
+TEST(SbfIndexTest, indexesValidBlocks)
+{
+    std::vector<uint8_t> log = makeLog(3);
+    auto corrupted = sbfBlock(4007, 96, 0, 0);
+    corrupted[20] ^= 0xFF;
+    append(log, corrupted);
+    // Block without time fields
+    append(log, sbfBlock(5902, 12, 0, 0));
+
+    auto index = io::buildSbfIndex(log.data(), log.size());
+
+    ASSERT_EQ(index.size(), 7u);
+    EXPECT_EQ(index[0].offset, 0u);
+    EXPECT_EQ(index[0].number(), 4007u);
+    EXPECT_EQ(index[1].offset, 96u);
+    EXPECT_EQ(index[1].number(), 5938u);
+    EXPECT_EQ(index[2].offset, 96u + 48u + 18u);
+    EXPECT_DOUBLE_EQ(index[2].gpsTime(), gpsTime(101));
+    EXPECT_EQ(index[6].number(), 5902u);
+    EXPECT_FALSE(index[6].hasTime());
+}
+
+TEST(SbfIndexTest, selectsTimeRangeContiguously)
+{
+    std::vector<uint8_t> log = makeLog(10);
+    auto index = io::buildSbfIndex(log.data(), log.size());
+    size_t epochSize = 96 + 48 + 18;
+
+    io::SbfReplayFilter filter;
+    auto ranges = io::selectSbfRanges(index, log.size(), filter);
+    ASSERT_EQ(ranges.size(), 1u);
+    EXPECT_EQ(ranges[0].begin, 0u);
+    EXPECT_EQ(ranges[0].end, log.size());
+
+    filter.start = gpsTime(103);
+    filter.end = gpsTime(105);
+    ranges = io::selectSbfRanges(index, log.size(), filter);
+    ASSERT_EQ(ranges.size(), 1u);
+    EXPECT_EQ(ranges[0].begin, 3 * epochSize);
+    // The NMEA sentence after the last block is not part of the time range
+    EXPECT_EQ(ranges[0].end, 6 * epochSize - 18);
+
+    filter.end = 0.0;
+    ranges = io::selectSbfRanges(index, log.size(), filter);
+    ASSERT_EQ(ranges.size(), 1u);
+    EXPECT_EQ(ranges[0].begin, 3 * epochSize);
+    EXPECT_EQ(ranges[0].end, log.size());
+
+    filter.start = gpsTime(200);
+    EXPECT_TRUE(io::selectSbfRanges(index, log.size(), filter).empty());
+}
+
+TEST(SbfIndexTest, selectsBlockNumbers)
+{
+    std::vector<uint8_t> log = makeLog(4);
+    // Two adjacent PVTGeodetic blocks are merged into one range
+    append(log, sbfBlock(4007, 96, 104000, 2300));
+    append(log, sbfBlock(4007, 96, 105000, 2300));
+    auto index = io::buildSbfIndex(log.data(), log.size());
+    size_t epochSize = 96 + 48 + 18;
+
+    io::SbfReplayFilter filter;
+    filter.blockNumbers = {4007};
+    filter.start = gpsTime(102);
+    auto ranges = io::selectSbfRanges(index, log.size(), filter);
+
+    ASSERT_EQ(ranges.size(), 3u);
+    EXPECT_EQ(ranges[0].begin, 2 * epochSize);
+    EXPECT_EQ(ranges[0].end, 2 * epochSize + 96);
+    EXPECT_EQ(ranges[1].begin, 3 * epochSize);
+    EXPECT_EQ(ranges[2].begin, 4 * epochSize);
+    EXPECT_EQ(ranges[2].end, log.size());
+}
+
+TEST(SbfIndexTest, storesIndexNextToLog)
+{
+    std::vector<uint8_t> log = makeLog(5);
+    std::string logPath =
+        "/tmp/test_sbf_index_" + std::to_string(getpid()) + ".sbf";
+    {
+        std::ofstream file(logPath, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(log.data()), log.size());
+    }
+
+    io::MappedFile file;
+    std::string error;
+    ASSERT_TRUE(file.open(logPath, error)) << error;
+    ASSERT_EQ(file.size(), log.size());
+    auto index = io::buildSbfIndex(file.data(), file.size());
+
+    std::string path = io::sbfIndexPath(logPath);
+    EXPECT_EQ(path, logPath + ".idx");
+    ASSERT_TRUE(io::writeSbfIndex(path, file.size(), index, error)) << error;
+
+    std::vector<io::SbfIndexEntry> read;
+    ASSERT_TRUE(io::readSbfIndex(path, file.size(), read, error)) << error;
+    ASSERT_EQ(read.size(), index.size());
+    for (size_t i = 0; i < index.size(); ++i)
+    {
+        EXPECT_EQ(read[i].offset, index[i].offset);
+        EXPECT_EQ(read[i].id, index[i].id);
+        EXPECT_EQ(read[i].length, index[i].length);
+        EXPECT_EQ(read[i].tow, index[i].tow);
+        EXPECT_EQ(read[i].wnc, index[i].wnc);
+    }
+
+    // An index of a log that has grown since is stale
+    EXPECT_FALSE(io::readSbfIndex(path, file.size() + 4, read, error));
+    EXPECT_FALSE(io::readSbfIndex(logPath, file.size(), read, error));
+
+    std::remove(path.c_str());
+    std::remove(logPath.c_str());
+}
+
+TEST(SbfIndexTest, splitsSegmentsAtEpochs)
+{
+    std::vector<uint8_t> log = makeLog(10);
+    auto index = io::buildSbfIndex(log.data(), log.size());
+    size_t epochSize = 96 + 48 + 18;
+
+    auto segments = io::splitSbfSegments(index, log.size(), 4, 2.0);
+    ASSERT_EQ(segments.size(), 4u);
+    EXPECT_EQ(segments[0].warmup, 0u);
+    EXPECT_EQ(segments[0].range.begin, 0u);
+    EXPECT_EQ(segments.back().range.end, log.size());
+    for (size_t i = 1; i < segments.size(); ++i)
+    {
+        EXPECT_EQ(segments[i].range.begin, segments[i - 1].range.end);
+        EXPECT_EQ(segments[i].range.begin % epochSize, 0u);
+        EXPECT_GE(segments[i].range.begin, i * log.size() / 4);
+        // The two preceding epochs are processed beforehand
+        EXPECT_EQ(segments[i].warmup, segments[i].range.begin - 2 * epochSize);
+    }
+
+    // Not more segments than epochs
+    segments = io::splitSbfSegments(index, log.size(), 20, 0.0);
+    EXPECT_EQ(segments.size(), 10u);
+    EXPECT_EQ(segments[1].warmup, segments[1].range.begin);
+    EXPECT_TRUE(io::splitSbfSegments(index, 0, 4, 2.0).empty());
+}
@@ -0,0 +1,93 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+
+#include <septentrio_gnss_driver/communication/sync_scanner.hpp>
+
+namespace {
+    size_t find(const std::string& str)
+    {
+        return io::findSync(reinterpret_cast<const uint8_t*>(str.data()),
+                            str.size());
+    }
+
+    // Noise with many sync bytes but only few valid sync sequences
+    std::vector<uint8_t> noise(size_t size, std::mt19937& gen)
+    {
+        const std::string alphabet = "$$$$@GIRxyz\r\n";
+        std::vector<uint8_t> data(size);
+        for (auto& byte : data)
+            byte = alphabet[gen() % alphabet.size()];
+        return data;
+    }
+} // namespace
+
+TEST(SyncScannerTest, sequences)
+{
+    EXPECT_EQ(find(""), 0u);
+    EXPECT_EQ(find("abc"), 3u);
+    EXPECT_EQ(find("$@"), 0u);
+    EXPECT_EQ(find("ab$GPGGA"), 2u);
+    EXPECT_EQ(find("ab$INHDT"), 2u);
+    EXPECT_EQ(find("ab$R: grc"), 2u);
+    EXPECT_EQ(find("$X$$@"), 3u);
+    EXPECT_EQ(find("abc$"), 3u);
+    EXPECT_EQ(find(std::string(100, 'a') + "$@" + std::string(100, 'b')), 100u);
+    EXPECT_EQ(find(std::string(100, '$') + "x"), 101u);
+    EXPECT_EQ(find(std::string(31, 'a') + "$" + "@"), 31u);
+    EXPECT_EQ(find(std::string(32, 'a') + "$" + "@"), 32u);
+}
+
+TEST(SyncScannerTest, implementationsAgree)
+{
+    std::mt19937 gen(1234);
+    for (size_t size = 0; size < 300; ++size)
+    {
+        auto data = noise(size, gen);
+        for (size_t offset = 0; offset < std::min<size_t>(size, 33); ++offset)
+        {
+            const uint8_t* ptr = data.data() + offset;
+            size_t len = size - offset;
+            size_t expected = io::findSyncScalar(ptr, len);
+            EXPECT_EQ(io::findSync(ptr, len), expected);
+#if defined(__x86_64__) || defined(__i386__)
+            EXPECT_EQ(io::findSyncSse2(ptr, len), expected);
+            if (io::hasAvx2())
+            {
+                EXPECT_EQ(io::findSyncAvx2(ptr, len), expected);
+            }
+#endif
+        }
+    }
+}
@@ -0,0 +1,446 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+
+#include <septentrio_gnss_driver/communication/telegram_framer.hpp>
+#include <septentrio_gnss_driver/crc/crc.hpp>
+
+namespace {
+    std::vector<uint8_t> sbfBlock(uint16_t id, uint16_t length, uint8_t fill)
+    {
+        std::vector<uint8_t> block(length, fill);
+        block[0] = SYNC_BYTE_1;
+        block[1] = SBF_SYNC_BYTE_2;
+        block[4] = id & 0xFF;
+        block[5] = id >> 8;
+        block[6] = length & 0xFF;
+        block[7] = length >> 8;
+        uint16_t crc = crc::compute16CCITT(block.data() + 4, length - 4);
+        block[2] = crc & 0xFF;
+        block[3] = crc >> 8;
+        return block;
+    }
+
+    std::vector<uint8_t> ascii(const std::string& str)
+    {
+        return std::vector<uint8_t>(str.begin(), str.end());
+    }
+
+    void append(std::vector<uint8_t>& stream, const std::vector<uint8_t>& data)
+    {
+        stream.insert(stream.end(), data.begin(), data.end());
+    }
+
+    std::vector<std::shared_ptr<Telegram>> drain(TelegramQueue& queue)
+    {
+        std::vector<std::shared_ptr<Telegram>> telegrams;
+        while (!queue.empty())
+        {
+            std::shared_ptr<Telegram> telegram;
+            queue.pop(telegram);
+            telegrams.push_back(telegram);
+        }
+        return telegrams;
+    }
+
+    struct Stream
+    {
+        std::vector<uint8_t> data;
+        std::vector<std::vector<uint8_t>> messages;
+        std::vector<telegram_type::TelegramType> types;
+
+        void add(const std::vector<uint8_t>& message,
+                 telegram_type::TelegramType type)
+        {
+            append(data, message);
+            messages.push_back(message);
+            types.push_back(type);
+        }
+    };
+
+    Stream mixedStream()
+    {
+        Stream stream;
+        stream.add(ascii("IP10>"), telegram_type::CONNECTION_DESCRIPTOR);
+        stream.add(ascii("$R: grc\r\n"), telegram_type::RESPONSE);
+        stream.add(ascii("  ReceiverCapabilities, INS\r\n"), telegram_type::UNKNOWN);
+        stream.add(ascii("$R? foo: Invalid command!\r\n"),
+                   telegram_type::ERROR_RESPONSE);
+        stream.add(sbfBlock(4007, 96, 0x24), telegram_type::SBF);
+        stream.add(ascii("$GPGGA,120000.00,5000.0,N,00400.0,E,1,12,0.9,50.0,M,"
+                         "47.0,M,,*4B\r\n"),
+                   telegram_type::NMEA);
+        stream.add(sbfBlock(4226, 8192, 0x0A), telegram_type::SBF);
+        stream.add(ascii("$INHDT,90.0,T*3C\r\n"), telegram_type::NMEA_INS);
+        stream.add(sbfBlock(5914, 24, 0x3E), telegram_type::SBF);
+        return stream;
+    }
+
+    //! Expects the telegrams of the stream in stream order within each lane, the
+    //! queue may hand out telegrams of higher priority lanes earlier
+    void expectStream(const Stream& stream,
+                      const std::vector<std::shared_ptr<Telegram>>& telegrams)
+    {
+        ASSERT_EQ(telegrams.size(), stream.messages.size());
+        for (size_t lane = 0; lane < TELEGRAM_LANE_COUNT; ++lane)
+        {
+            std::vector<size_t> expected;
+            for (size_t i = 0; i < stream.messages.size(); ++i)
+            {
+                Telegram telegram;
+                telegram.type = stream.types[i];
+                telegram.message = stream.messages[i];
+                if (classifyTelegram(telegram) == lane)
+                    expected.push_back(i);
+            }
+            std::vector<std::shared_ptr<Telegram>> handed;
+            for (const auto& telegram : telegrams)
+            {
+                if (classifyTelegram(*telegram) == lane)
+                    handed.push_back(telegram);
+            }
+            ASSERT_EQ(handed.size(), expected.size());
+            for (size_t i = 0; i < handed.size(); ++i)
+            {
+                EXPECT_EQ(handed[i]->type, stream.types[expected[i]]);
+                EXPECT_EQ(handed[i]->message, stream.messages[expected[i]]);
+            }
+        }
+    }
+} // namespace
+
+TEST(TelegramFramerTest, singleChunk)
+{
+    TelegramQueue queue;
+    io::TelegramPool pool;
+    io::TelegramFramer framer(&queue, &pool);
+    Stream stream = mixedStream();
+
+    framer.feed(stream.data.data(), stream.data.size(), 42);
+
+    auto telegrams = drain(queue);
+    expectStream(stream, telegrams);
+    for (const auto& telegram : telegrams)
+        EXPECT_EQ(telegram->stamp, 42u);
+    EXPECT_EQ(framer.pending(), 0u);
+    EXPECT_EQ(framer.statistics().crcFailures, 0u);
+    EXPECT_EQ(framer.statistics().discardedBytes, 0u);
+}
+
+TEST(TelegramFramerTest, byteByByte)
+{
+    TelegramQueue queue;
+    io::TelegramPool pool;
+    io::TelegramFramer framer(&queue, &pool);
+    Stream stream = mixedStream();
+
+    for (size_t i = 0; i < stream.data.size(); ++i)
+        framer.feed(stream.data.data() + i, 1, i);
+
+    expectStream(stream, drain(queue));
+    EXPECT_EQ(framer.statistics().discardedBytes, 0u);
+}
+
+TEST(TelegramFramerTest, randomChunks)
+{
+    Stream stream = mixedStream();
+    std::mt19937 gen(1234);
+    std::uniform_int_distribution<size_t> chunkSize(1, 700);
+
+    for (int run = 0; run < 50; ++run)
+    {
+        TelegramQueue queue;
+        io::TelegramPool pool;
+        io::TelegramFramer framer(&queue, &pool);
+
+        size_t pos = 0;
+        while (pos < stream.data.size())
+        {
+            size_t size = std::min(chunkSize(gen), stream.data.size() - pos);
+            std::copy(stream.data.begin() + pos,
+                      stream.data.begin() + pos + size, framer.prepare(size));
+            framer.commit(size, pos);
+            pos += size;
+        }
+
+        expectStream(stream, drain(queue));
+    }
+}
+
+TEST(TelegramFramerTest, pauseKeepsStreamOrder)
+{
+    Stream stream = mixedStream();
+    std::mt19937 gen(4321);
+    std::uniform_int_distribution<size_t> chunkSize(1, 700);
+
+    for (int run = 0; run < 20; ++run)
+    {
+        TelegramQueue queue;
+        queue.configure(1, overflow_policy::BLOCK, false, 0);
+        io::TelegramPool pool;
+        io::TelegramFramer framer(&queue, &pool);
+        uint64_t resumed = 0;
+        framer.setResumeHandler([&resumed](uint64_t pause) { resumed = pause; });
+
+        std::vector<std::shared_ptr<Telegram>> telegrams;
+        size_t pos = 0;
+        size_t pauses = 0;
+        while ((pos < stream.data.size()) || framer.paused())
+        {
+            // Like a connection, no chunk is read while the framer is paused
+            if (framer.paused())
+            {
+                ++pauses;
+                auto drained = drain(queue);
+                telegrams.insert(telegrams.end(), drained.begin(), drained.end());
+                ASSERT_NE(resumed, 0u);
+                framer.resume(resumed);
+                continue;
+            }
+            size_t size = std::min(chunkSize(gen), stream.data.size() - pos);
+            std::copy(stream.data.begin() + pos,
+                      stream.data.begin() + pos + size, framer.prepare(size));
+            framer.commit(size, pos);
+            pos += size;
+        }
+        auto drained = drain(queue);
+        telegrams.insert(telegrams.end(), drained.begin(), drained.end());
+
+        EXPECT_GT(pauses, 0u);
+        expectStream(stream, telegrams);
+        // An outdated pause does not resume the framer
+        EXPECT_FALSE(framer.resume(resumed));
+    }
+}
+
+TEST(TelegramFramerTest, stampOfFirstChunk)
+{
+    TelegramQueue queue;
+    io::TelegramPool pool;
+    io::TelegramFramer framer(&queue, &pool);
+    auto block = sbfBlock(4007, 96, 0);
+
+    framer.feed(block.data(), 50, 1);
+    framer.feed(block.data() + 50, 46, 2);
+
+    auto telegrams = drain(queue);
+    ASSERT_EQ(telegrams.size(), 1u);
+    EXPECT_EQ(telegrams[0]->stamp, 1u);
+    EXPECT_EQ(framer.statistics().reassembled, 1u);
+}
+
+TEST(TelegramFramerTest, corruptedBlock)
+{
+    TelegramQueue queue;
+    io::TelegramPool pool;
+    io::TelegramFramer framer(&queue, &pool);
+    auto corrupted = sbfBlock(4007, 96, 0x24);
+    corrupted[20] ^= 0xFF;
+    auto valid = sbfBlock(4013, 64, 0x40);
+
+    std::vector<uint8_t> data;
+    append(data, corrupted);
+    append(data, ascii("noise $X"));
+    append(data, valid);
+    framer.feed(data.data(), data.size(), 0);
+
+    auto telegrams = drain(queue);
+    ASSERT_EQ(telegrams.size(), 1u);
+    EXPECT_EQ(telegrams[0]->message, valid);
+    EXPECT_EQ(framer.statistics().crcFailures, 1u);
+    EXPECT_EQ(framer.statistics().discardedBytes, data.size() - valid.size());
+    EXPECT_EQ(framer.statistics().droppedFrames, 1u);
+}
+
+TEST(TelegramFramerTest, resetDropsPendingTelegram)
+{
+    TelegramQueue queue;
+    io::TelegramPool pool;
+    io::TelegramFramer framer(&queue, &pool);
+    auto block = sbfBlock(4007, 96, 0x24);
+
+    framer.feed(block.data(), 50, 0);
+    framer.reset();
+    framer.feed(block.data() + 50, 46, 0);
+    framer.feed(block.data(), block.size(), 0);
+
+    auto telegrams = drain(queue);
+    ASSERT_EQ(telegrams.size(), 1u);
+    EXPECT_EQ(telegrams[0]->message, block);
+    EXPECT_EQ(framer.statistics().droppedFrames, 1u);
+}
+
+TEST(TelegramFramerTest, invalidLength)
+{
+    TelegramQueue queue;
+    io::TelegramPool pool;
+    io::TelegramFramer framer(&queue, &pool);
+    auto valid = sbfBlock(4007, 96, 0);
+
+    std::vector<uint8_t> data = {SYNC_BYTE_1, SBF_SYNC_BYTE_2, 0, 0, 0, 0, 3, 0};
+    append(data, valid);
+    framer.feed(data.data(), data.size(), 0);
+
+    auto telegrams = drain(queue);
+    ASSERT_EQ(telegrams.size(), 1u);
+    EXPECT_EQ(telegrams[0]->message, valid);
+}
+
+TEST(TelegramFramerTest, unterminatedString)
+{
+    TelegramQueue queue;
+    io::TelegramPool pool;
+    io::TelegramFramer framer(&queue, &pool);
+
+    std::vector<uint8_t> data = ascii("$GPGGA,1234");
+    append(data, ascii("$GPHDT,90.0,T*00\r\n"));
+    append(data, ascii("no CR\n"));
+    framer.feed(data.data(), data.size(), 0);
+
+    auto telegrams = drain(queue);
+    ASSERT_EQ(telegrams.size(), 1u);
+    EXPECT_EQ(telegrams[0]->type, telegram_type::NMEA);
+    EXPECT_EQ(telegrams[0]->message, ascii("$GPHDT,90.0,T*00\r\n"));
+}
+
+TEST(TelegramFramerTest, splitPromptFollowsOutput)
+{
+    TelegramQueue queue;
+    io::TelegramPool pool;
+    io::TelegramFramer framer(&queue, &pool);
+
+    // The prompt ending the output of a get command arrives in two reads
+    std::vector<uint8_t> data = ascii("$R: gso\r\n");
+    append(data, ascii("  SBFOutput, Stream1, USB1, PVTGeodetic, sec1\r\n"));
+    append(data, ascii("IP1"));
+    framer.feed(data.data(), data.size(), 0);
+    std::vector<uint8_t> rest = ascii("0>");
+    framer.feed(rest.data(), rest.size(), 1);
+
+    auto telegrams = drain(queue);
+    ASSERT_EQ(telegrams.size(), 3u);
+    EXPECT_EQ(telegrams[0]->type, telegram_type::RESPONSE);
+    EXPECT_EQ(telegrams[1]->type, telegram_type::UNKNOWN);
+    EXPECT_EQ(telegrams[2]->type, telegram_type::CONNECTION_DESCRIPTOR);
+    EXPECT_EQ(telegrams[2]->message, ascii("IP10>"));
+}
+
+TEST(TelegramFramerTest, oversizedString)
+{
+    TelegramQueue queue;
+    io::TelegramPool pool;
+    io::TelegramFramer framer(&queue, &pool);
+
+    std::vector<uint8_t> noise(io::MAX_STRING_SIZE + 10, 'a');
+    framer.feed(noise.data(), noise.size(), 0);
+    EXPECT_EQ(framer.pending(), 0u);
+
+    auto valid = sbfBlock(4007, 96, 0);
+    framer.feed(valid.data(), valid.size(), 0);
+
+    auto telegrams = drain(queue);
+    ASSERT_EQ(telegrams.size(), 1u);
+    EXPECT_EQ(telegrams[0]->message, valid);
+}
+
+TEST(TelegramFramerTest, inPlaceRandomWindows)
+{
+    Stream stream = mixedStream();
+    std::mt19937 gen(4321);
+    std::uniform_int_distribution<size_t> windowGrowth(1, 700);
+
+    for (int run = 0; run < 50; ++run)
+    {
+        TelegramQueue queue;
+        io::TelegramPool pool;
+        io::TelegramFramer framer(&queue, &pool);
+
+        // Unconsumed bytes are passed again together with the following ones
+        size_t pos = 0;
+        size_t end = 0;
+        while (end < stream.data.size())
+        {
+            end = std::min(end + windowGrowth(gen), stream.data.size());
+            pos += framer.frameInPlace(stream.data.data() + pos, end - pos, 0);
+        }
+
+        EXPECT_EQ(pos, stream.data.size());
+        expectStream(stream, drain(queue));
+        EXPECT_EQ(framer.statistics().bytes, stream.data.size());
+    }
+}
+
+TEST(TelegramFramerTest, inPlaceCorruptedBlock)
+{
+    TelegramQueue queue;
+    io::TelegramPool pool;
+    io::TelegramFramer framer(&queue, &pool);
+    auto corrupted = sbfBlock(4007, 96, 0x24);
+    corrupted[20] ^= 0xFF;
+    auto valid = sbfBlock(4013, 64, 0x40);
+
+    std::vector<uint8_t> data;
+    append(data, corrupted);
+    append(data, ascii("noise $X"));
+    append(data, valid);
+    EXPECT_EQ(framer.frameInPlace(data.data(), data.size(), 0), data.size());
+
+    auto telegrams = drain(queue);
+    ASSERT_EQ(telegrams.size(), 1u);
+    EXPECT_EQ(telegrams[0]->message, valid);
+    EXPECT_EQ(framer.statistics().crcFailures, 1u);
+    EXPECT_EQ(framer.statistics().discardedBytes, data.size() - valid.size());
+}
+
+TEST(TelegramFramerTest, sinkKeepsStreamOrder)
+{
+    io::TelegramPool pool;
+    std::vector<std::shared_ptr<Telegram>> telegrams;
+    io::TelegramFramer framer(
+        [&telegrams](std::shared_ptr<Telegram>&& telegram) {
+            telegrams.push_back(std::move(telegram));
+        },
+        &pool);
+    Stream stream = mixedStream();
+
+    EXPECT_EQ(framer.frameInPlace(stream.data.data(), stream.data.size(), 7),
+              stream.data.size());
+
+    ASSERT_EQ(telegrams.size(), stream.messages.size());
+    for (size_t i = 0; i < telegrams.size(); ++i)
+    {
+        EXPECT_EQ(telegrams[i]->type, stream.types[i]);
+        EXPECT_EQ(telegrams[i]->message, stream.messages[i]);
+    }
+}
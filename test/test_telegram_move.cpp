@@ -0,0 +1,130 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include <septentrio_gnss_driver/communication/telegram_framer.hpp>
+#include <septentrio_gnss_driver/crc/crc.hpp>
+
+namespace {
+    //! Allocations of at least the size of the test block
+    std::atomic<size_t> largeAllocations{0};
+    const size_t BLOCK_SIZE = 4096;
+} // namespace
+
+void* operator new(size_t size)
+{
+    if (size >= BLOCK_SIZE)
+        ++largeAllocations;
+    if (void* ptr = std::malloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+// Not inlined so that free() is not matched against new expressions
+__attribute__((noinline)) void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+__attribute__((noinline)) void operator delete(void* ptr, size_t /*size*/) noexcept
+{
+    std::free(ptr);
+}
+
+namespace {
+    std::vector<uint8_t> sbfBlock(uint16_t id, uint16_t length)
+    {
+        std::vector<uint8_t> block(length, 0x55);
+        block[0] = SYNC_BYTE_1;
+        block[1] = SBF_SYNC_BYTE_2;
+        block[4] = id & 0xFF;
+        block[5] = id >> 8;
+        block[6] = length & 0xFF;
+        block[7] = length >> 8;
+        uint16_t crc = crc::compute16CCITT(block.data() + 4, length - 4);
+        block[2] = crc & 0xFF;
+        block[3] = crc >> 8;
+        return block;
+    }
+} // namespace
+
+TEST(TelegramMoveTest, moveKeepsBuffer)
+{
+    Telegram telegram(BLOCK_SIZE);
+    const uint8_t* data = telegram.message.data();
+
+    size_t allocations = largeAllocations;
+    Telegram moved(std::move(telegram));
+    EXPECT_EQ(moved.message.data(), data);
+
+    Telegram assigned;
+    assigned = std::move(moved);
+    EXPECT_EQ(assigned.message.data(), data);
+    EXPECT_EQ(largeAllocations, allocations);
+}
+
+TEST(TelegramMoveTest, ringMovesTelegrams)
+{
+    io::SpscRing<Telegram> ring(2);
+    Telegram telegram(BLOCK_SIZE);
+    const uint8_t* data = telegram.message.data();
+
+    size_t allocations = largeAllocations;
+    ASSERT_TRUE(ring.tryPush(std::move(telegram)));
+    Telegram popped;
+    ASSERT_TRUE(ring.tryPop(popped));
+    EXPECT_EQ(popped.message.data(), data);
+    EXPECT_EQ(largeAllocations, allocations);
+}
+
+TEST(TelegramMoveTest, noCopyAfterFraming)
+{
+    auto block = sbfBlock(4027, BLOCK_SIZE);
+    TelegramQueue queue;
+    io::TelegramPool pool(4);
+    io::TelegramFramer framer(&queue, &pool);
+
+    // Framing copies the block once into a pooled buffer, which is reserved
+    // already, afterwards the telegram is only handed over
+    size_t allocations = largeAllocations;
+    framer.feed(block.data(), block.size(), 0);
+    std::shared_ptr<Telegram> telegram;
+    queue.pop(telegram);
+    EXPECT_EQ(largeAllocations, allocations);
+
+    ASSERT_TRUE(telegram);
+    EXPECT_EQ(telegram->message, block);
+    EXPECT_EQ(telegram.use_count(), 2);
+}
@@ -0,0 +1,113 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <gtest/gtest.h>
+
+#include <septentrio_gnss_driver/communication/telegram_pool.hpp>
+
+TEST(TelegramPoolTest, recycling)
+{
+    io::TelegramPool pool(4);
+
+    Telegram* first;
+    {
+        auto telegram = pool.acquire(3);
+        first = telegram.get();
+        EXPECT_EQ(telegram->message.size(), 3u);
+        EXPECT_GE(telegram->message.capacity(), io::TELEGRAM_RESERVE);
+        telegram->type = telegram_type::SBF;
+        telegram->stamp = 42;
+        telegram->message.assign(1000, 0xAB);
+    }
+
+    // All slots are handed out once before a slot is reused
+    for (size_t i = 1; i < pool.size(); ++i)
+        EXPECT_NE(pool.acquire().get(), first);
+
+    auto telegram = pool.acquire();
+    EXPECT_EQ(telegram.get(), first);
+    EXPECT_EQ(telegram->type, telegram_type::EMPTY);
+    EXPECT_EQ(telegram->stamp, 0u);
+    EXPECT_TRUE(telegram->message.empty());
+    EXPECT_GE(telegram->message.capacity(), 1000u);
+
+    EXPECT_EQ(pool.statistics().hits, 5u);
+    EXPECT_EQ(pool.statistics().misses, 0u);
+    EXPECT_EQ(pool.statistics().highWaterMark, 1u);
+}
+
+TEST(TelegramPoolTest, exhaustion)
+{
+    io::TelegramPool pool(4);
+
+    std::vector<std::shared_ptr<Telegram>> held;
+    for (size_t i = 0; i < pool.size(); ++i)
+        held.push_back(pool.acquire());
+    EXPECT_EQ(pool.statistics().highWaterMark, 4u);
+
+    auto extra = pool.acquire(5);
+    ASSERT_TRUE(extra);
+    EXPECT_EQ(extra->message.size(), 5u);
+    EXPECT_EQ(pool.statistics().misses, 1u);
+
+    // Released telegrams are reused, the unpooled one is not
+    Telegram* released = held[2].get();
+    held[2].reset();
+    extra.reset();
+    EXPECT_EQ(pool.acquire().get(), released);
+    EXPECT_EQ(pool.statistics().hits, 5u);
+}
+
+TEST(TelegramPoolTest, outOfOrderRelease)
+{
+    io::TelegramPool pool(6);
+
+    std::vector<std::shared_ptr<Telegram>> held;
+    for (size_t i = 0; i < 3; ++i)
+        held.push_back(pool.acquire());
+    EXPECT_EQ(pool.statistics().highWaterMark, 3u);
+
+    // A telegram handed out in between is released first, e.g. by another lane
+    held[1].reset();
+    held.push_back(pool.acquire());
+    EXPECT_EQ(pool.statistics().highWaterMark, 3u);
+    held.push_back(pool.acquire());
+    EXPECT_EQ(pool.statistics().highWaterMark, 4u);
+}
+
+TEST(TelegramPoolTest, disabled)
+{
+    io::TelegramPool pool(0);
+
+    auto telegram = pool.acquire(3);
+    ASSERT_TRUE(telegram);
+    EXPECT_EQ(telegram->message.size(), 3u);
+    EXPECT_EQ(pool.statistics().misses, 1u);
+}
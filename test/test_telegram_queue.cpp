@@ -0,0 +1,441 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <septentrio_gnss_driver/communication/telegram_queue.hpp>
+#include <septentrio_gnss_driver/parsers/parsing_utilities.hpp>
+
+namespace {
+    std::shared_ptr<Telegram> telegramWithStamp(Timestamp stamp)
+    {
+        auto telegram = std::make_shared<Telegram>();
+        telegram->stamp = stamp;
+        return telegram;
+    }
+
+    std::shared_ptr<Telegram> sbfTelegram(uint16_t id, uint32_t tow = 0)
+    {
+        // Header plus TOW and WNc
+        const uint16_t size = SBF_HEADER_SIZE + 6;
+        auto telegram = std::make_shared<Telegram>(size);
+        telegram->type = telegram_type::SBF;
+        telegram->message[0] = SYNC_BYTE_1;
+        telegram->message[1] = SBF_SYNC_BYTE_2;
+        telegram->message[4] = id & 0xFF;
+        telegram->message[5] = id >> 8;
+        telegram->message[6] = size;
+        for (size_t i = 0; i < 4; ++i)
+            telegram->message[8 + i] = (tow >> (8 * i)) & 0xFF;
+        return telegram;
+    }
+
+    std::vector<uint16_t> drainIds(TelegramQueue& queue)
+    {
+        std::vector<uint16_t> ids;
+        std::shared_ptr<Telegram> telegram;
+        while (!queue.empty() && queue.pop(telegram))
+            ids.push_back(parsing_utilities::getId(telegram->message));
+        return ids;
+    }
+
+    std::vector<Timestamp> drain(TelegramQueue& queue)
+    {
+        std::vector<Timestamp> stamps;
+        while (!queue.empty())
+        {
+            std::shared_ptr<Telegram> telegram;
+            queue.pop(telegram);
+            stamps.push_back(telegram->stamp);
+        }
+        return stamps;
+    }
+} // namespace
+
+TEST(TelegramQueueTest, ringCapacity)
+{
+    io::SpscRing<int> ring(5);
+    EXPECT_EQ(ring.capacity(), 8u);
+    for (int i = 0; i < 8; ++i)
+        EXPECT_TRUE(ring.tryPush(std::move(i)));
+    EXPECT_FALSE(ring.tryPush(8));
+    EXPECT_EQ(ring.size(), 8u);
+
+    io::MpmcRing<int> mpmc(3);
+    EXPECT_EQ(mpmc.capacity(), 4u);
+    for (int i = 0; i < 4; ++i)
+        EXPECT_TRUE(mpmc.tryPush(std::move(i)));
+    EXPECT_FALSE(mpmc.tryPush(4));
+    for (int i = 0; i < 4; ++i)
+    {
+        int value;
+        EXPECT_TRUE(mpmc.tryPop(value));
+        EXPECT_EQ(value, i);
+    }
+    int value;
+    EXPECT_FALSE(mpmc.tryPop(value));
+}
+
+TEST(TelegramQueueTest, dropNewest)
+{
+    TelegramQueue queue;
+    queue.configure(4, overflow_policy::DROP_NEWEST, false, 0);
+    for (Timestamp i = 0; i < 6; ++i)
+        queue.push(telegramWithStamp(i));
+
+    EXPECT_EQ(drain(queue), (std::vector<Timestamp>{0, 1, 2, 3}));
+    EXPECT_EQ(queue.statistics(telegram_lane::BULK).pushed, 4u);
+    EXPECT_EQ(queue.statistics(telegram_lane::BULK).dropped, 2u);
+    EXPECT_EQ(queue.statistics(telegram_lane::BULK).highWaterMark, 4u);
+}
+
+TEST(TelegramQueueTest, dropOldest)
+{
+    TelegramQueue queue;
+    queue.configure(4, overflow_policy::DROP_OLDEST, false, 0);
+    for (Timestamp i = 0; i < 6; ++i)
+        queue.push(telegramWithStamp(i));
+
+    EXPECT_EQ(drain(queue), (std::vector<Timestamp>{2, 3, 4, 5}));
+    EXPECT_EQ(queue.statistics(telegram_lane::BULK).pushed, 6u);
+    EXPECT_EQ(queue.statistics(telegram_lane::BULK).dropped, 2u);
+}
+
+TEST(TelegramQueueTest, dropReleasesTelegram)
+{
+    TelegramQueue queue;
+    queue.configure(1, overflow_policy::DROP_OLDEST, false, 0);
+    auto oldest = telegramWithStamp(0);
+    queue.push(std::shared_ptr<Telegram>(oldest));
+    EXPECT_EQ(oldest.use_count(), 2);
+    queue.push(telegramWithStamp(1));
+    EXPECT_EQ(oldest.use_count(), 1);
+}
+
+TEST(TelegramQueueTest, blockKeepsAllTelegrams)
+{
+    for (uint32_t spinCount : {0u, 1000u})
+    {
+        const Timestamp count = 100000;
+        TelegramQueue queue;
+        queue.configure(8, overflow_policy::BLOCK, false, spinCount);
+
+        std::thread producer([&queue]() {
+            for (Timestamp i = 0; i < count; ++i)
+                queue.push(telegramWithStamp(i));
+        });
+
+        for (Timestamp i = 0; i < count; ++i)
+        {
+            std::shared_ptr<Telegram> telegram;
+            ASSERT_TRUE(queue.pop(telegram));
+            ASSERT_EQ(telegram->stamp, i);
+        }
+        producer.join();
+        EXPECT_EQ(queue.statistics(telegram_lane::BULK).dropped, 0u);
+        EXPECT_LE(queue.statistics(telegram_lane::BULK).highWaterMark, 8u);
+    }
+}
+
+TEST(TelegramQueueTest, multipleProducers)
+{
+    const Timestamp producers = 3;
+    const Timestamp count = 50000;
+    TelegramQueue queue;
+    queue.configure(16, overflow_policy::BLOCK, true, 0);
+
+    std::vector<std::thread> threads;
+    for (Timestamp p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&queue, p]() {
+            for (Timestamp i = 0; i < count; ++i)
+                queue.push(telegramWithStamp(p * count + i));
+        });
+    }
+
+    // Telegrams of each producer arrive in order
+    std::vector<Timestamp> next(producers, 0);
+    for (Timestamp n = 0; n < producers * count; ++n)
+    {
+        std::shared_ptr<Telegram> telegram;
+        ASSERT_TRUE(queue.pop(telegram));
+        Timestamp p = telegram->stamp / count;
+        ASSERT_EQ(telegram->stamp % count, next[p]);
+        ++next[p];
+    }
+    for (auto& thread : threads)
+        thread.join();
+    EXPECT_EQ(queue.statistics(telegram_lane::BULK).pushed, producers * count);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(TelegramQueueTest, closeWakesThreads)
+{
+    TelegramQueue queue;
+    queue.configure(1, overflow_policy::BLOCK, false, 0);
+
+    bool popped = true;
+    std::thread consumer([&queue, &popped]() {
+        std::shared_ptr<Telegram> telegram;
+        popped = queue.pop(telegram);
+    });
+    queue.close();
+    consumer.join();
+    EXPECT_FALSE(popped);
+    EXPECT_FALSE(queue.push(telegramWithStamp(0)));
+}
+
+TEST(TelegramQueueTest, offerResumesAtHalfCapacity)
+{
+    TelegramQueue queue;
+    queue.configure(4, overflow_policy::BLOCK, false, 0);
+    for (Timestamp i = 0; i < 4; ++i)
+    {
+        auto telegram = telegramWithStamp(i);
+        EXPECT_TRUE(queue.offer(telegram));
+        EXPECT_FALSE(telegram);
+    }
+    auto refused = telegramWithStamp(4);
+    EXPECT_FALSE(queue.offer(refused));
+    ASSERT_TRUE(refused);
+
+    int resumed = 0;
+    int cancelled = 0;
+    ASSERT_TRUE(queue.resumeWhenDrained(*refused, &queue, [&]() { ++resumed; }));
+    ASSERT_TRUE(
+        queue.resumeWhenDrained(*refused, &cancelled, [&]() { ++cancelled; }));
+    queue.cancel(&cancelled);
+
+    std::shared_ptr<Telegram> telegram;
+    ASSERT_TRUE(queue.pop(telegram));
+    EXPECT_EQ(resumed, 0);
+    ASSERT_TRUE(queue.pop(telegram));
+    EXPECT_EQ(resumed, 1);
+    EXPECT_EQ(cancelled, 0);
+
+    // The lane has space, the telegram is offered again right away
+    EXPECT_FALSE(queue.resumeWhenDrained(*refused, &queue, [&]() { ++resumed; }));
+    EXPECT_TRUE(queue.offer(refused));
+    EXPECT_EQ(drain(queue), (std::vector<Timestamp>{2, 3, 4}));
+    EXPECT_EQ(resumed, 1);
+    EXPECT_EQ(queue.statistics(telegram_lane::BULK).dropped, 0u);
+}
+
+TEST(TelegramQueueTest, closeResumesProducers)
+{
+    TelegramQueue queue;
+    queue.configure(1, overflow_policy::BLOCK, false, 0);
+    EXPECT_TRUE(queue.push(telegramWithStamp(0)));
+    auto refused = telegramWithStamp(1);
+    EXPECT_FALSE(queue.offer(refused));
+
+    bool resumed = false;
+    ASSERT_TRUE(
+        queue.resumeWhenDrained(*refused, &queue, [&]() { resumed = true; }));
+    queue.close();
+    EXPECT_TRUE(resumed);
+    // Discarded, since the queue is closed
+    EXPECT_TRUE(queue.offer(refused));
+}
+
+TEST(TelegramQueueTest, wakeupLatency)
+{
+    TelegramQueue queue;
+    queue.configure(4, overflow_policy::BLOCK, false, 0);
+
+    std::thread consumer([&queue]() {
+        std::shared_ptr<Telegram> telegram;
+        queue.pop(telegram);
+    });
+    // Lets the consumer park before the push wakes it up
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_TRUE(queue.push(telegramWithStamp(1)));
+    consumer.join();
+
+    const io::SchedulingLatency& latency = queue.wakeupLatency();
+    EXPECT_EQ(latency.count, 1u);
+    EXPECT_EQ(latency.maxNs, latency.sumNs);
+}
+
+TEST(TelegramQueueTest, classification)
+{
+    Telegram response;
+    response.type = telegram_type::RESPONSE;
+    EXPECT_EQ(classifyTelegram(response), telegram_lane::CONTROL);
+    Telegram descriptor;
+    descriptor.type = telegram_type::CONNECTION_DESCRIPTOR;
+    EXPECT_EQ(classifyTelegram(descriptor), telegram_lane::CONTROL);
+    Telegram line;
+    line.type = telegram_type::UNKNOWN;
+    EXPECT_EQ(classifyTelegram(line), telegram_lane::BULK);
+    Telegram nmea;
+    nmea.type = telegram_type::NMEA;
+    EXPECT_EQ(classifyTelegram(nmea), telegram_lane::BULK);
+
+    EXPECT_EQ(classifyTelegram(*sbfTelegram(4226)), telegram_lane::REALTIME);
+    EXPECT_EQ(classifyTelegram(*sbfTelegram(4050)), telegram_lane::REALTIME);
+    EXPECT_EQ(classifyTelegram(*sbfTelegram(5924)), telegram_lane::REALTIME);
+    EXPECT_EQ(classifyTelegram(*sbfTelegram(4027)), telegram_lane::BULK);
+    EXPECT_EQ(classifyTelegram(*sbfTelegram(4013)), telegram_lane::BULK);
+}
+
+TEST(TelegramQueueTest, lanePriority)
+{
+    TelegramQueue queue;
+    queue.configure(16, overflow_policy::DROP_OLDEST, false, 0);
+    for (uint32_t i = 0; i < 10; ++i)
+        queue.push(sbfTelegram(4027, i * 100));
+    queue.push(sbfTelegram(4226, 1000));
+    auto response = std::make_shared<Telegram>();
+    response->type = telegram_type::RESPONSE;
+    queue.push(std::move(response));
+    EXPECT_EQ(queue.size(), 12u);
+
+    std::shared_ptr<Telegram> telegram;
+    ASSERT_TRUE(queue.pop(telegram));
+    EXPECT_EQ(telegram->type, telegram_type::RESPONSE);
+    ASSERT_TRUE(queue.pop(telegram));
+    EXPECT_EQ(parsing_utilities::getId(telegram->message), 4226);
+    for (int i = 0; i < 10; ++i)
+    {
+        ASSERT_TRUE(queue.pop(telegram));
+        EXPECT_EQ(parsing_utilities::getId(telegram->message), 4027);
+    }
+
+    EXPECT_EQ(queue.statistics(telegram_lane::CONTROL).popped, 1u);
+    EXPECT_EQ(queue.statistics(telegram_lane::REALTIME).popped, 1u);
+    EXPECT_EQ(queue.statistics(telegram_lane::BULK).popped, 10u);
+    EXPECT_EQ(queue.statistics(telegram_lane::BULK).highWaterMark, 10u);
+    EXPECT_GE(queue.statistics(telegram_lane::BULK).latencyMaxNs,
+              queue.statistics(telegram_lane::CONTROL).latencyMaxNs);
+}
+
+TEST(TelegramQueueTest, responseKeepsOrder)
+{
+    TelegramQueue queue;
+    queue.configure(16, overflow_policy::DROP_OLDEST, false, 0);
+    const std::vector<telegram_type::TelegramType> types = {
+        telegram_type::RESPONSE, telegram_type::UNKNOWN, telegram_type::UNKNOWN,
+        telegram_type::UNKNOWN, telegram_type::CONNECTION_DESCRIPTOR};
+    for (Timestamp i = 0; i < types.size(); ++i)
+    {
+        queue.push(sbfTelegram(4007));
+        auto telegram = telegramWithStamp(i);
+        telegram->type = types[i];
+        queue.push(std::move(telegram));
+    }
+
+    // The response, its output lines and the prompt are handled in order, the
+    // prompt still overtakes the blocks pushed after the last line
+    std::vector<telegram_type::TelegramType> text;
+    size_t blocksBeforePrompt = 0;
+    std::shared_ptr<Telegram> telegram;
+    while (text.size() < types.size())
+    {
+        ASSERT_TRUE(queue.pop(telegram));
+        if (telegram->type == telegram_type::SBF)
+            ++blocksBeforePrompt;
+        else
+        {
+            EXPECT_EQ(telegram->stamp, text.size());
+            text.push_back(telegram->type);
+        }
+    }
+    EXPECT_EQ(text, types);
+    EXPECT_EQ(blocksBeforePrompt, types.size() - 1);
+    ASSERT_TRUE(queue.pop(telegram));
+    EXPECT_EQ(telegram->type, telegram_type::SBF);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(TelegramQueueTest, realtimeKeepsEpochOrder)
+{
+    TelegramQueue queue;
+    queue.configure(16, overflow_policy::DROP_OLDEST, false, 0);
+    // Backlog of an earlier epoch, then PVT and INS of the current one
+    queue.push(sbfTelegram(4027, 100));
+    queue.push(sbfTelegram(4027, 100));
+    queue.push(sbfTelegram(4007, 200));
+    queue.push(sbfTelegram(4226, 200));
+    queue.push(sbfTelegram(4226, 220));
+    // The INS block of epoch 200 waits for its PVT block, the one of epoch 220
+    // is not held back by anything
+    EXPECT_EQ(drainIds(queue),
+              (std::vector<uint16_t>{4027, 4027, 4007, 4226, 4226}));
+
+    queue.push(sbfTelegram(4027, 300));
+    queue.push(sbfTelegram(4027, 300));
+    queue.push(sbfTelegram(4226, 320));
+    EXPECT_EQ(drainIds(queue), (std::vector<uint16_t>{4226, 4027, 4027}));
+}
+
+TEST(TelegramQueueTest, replayKeepsLogOrder)
+{
+    TelegramQueue queue;
+    queue.configure(16, overflow_policy::BLOCK, false, 0, false);
+    queue.push(sbfTelegram(4027, 100));
+    queue.push(sbfTelegram(4007, 200));
+    queue.push(sbfTelegram(4226, 220));
+    EXPECT_EQ(drainIds(queue), (std::vector<uint16_t>{4027, 4007, 4226}));
+    EXPECT_EQ(queue.statistics(telegram_lane::REALTIME).pushed, 0u);
+}
+
+TEST(TelegramQueueTest, controlLaneIsLossless)
+{
+    TelegramQueue queue;
+    queue.configure(2, overflow_policy::DROP_NEWEST, false, 0);
+    for (int i = 0; i < 4; ++i)
+        queue.push(sbfTelegram(4027));
+
+    std::thread producer([&queue]() {
+        for (Timestamp i = 0; i < 4; ++i)
+        {
+            auto response = telegramWithStamp(i);
+            response->type = telegram_type::RESPONSE;
+            queue.push(std::move(response));
+        }
+    });
+    std::vector<Timestamp> responses;
+    while (responses.size() < 4)
+    {
+        std::shared_ptr<Telegram> telegram;
+        ASSERT_TRUE(queue.pop(telegram));
+        if (telegram->type == telegram_type::RESPONSE)
+            responses.push_back(telegram->stamp);
+    }
+    producer.join();
+    EXPECT_EQ(responses, (std::vector<Timestamp>{0, 1, 2, 3}));
+    EXPECT_EQ(queue.statistics(telegram_lane::CONTROL).dropped, 0u);
+    EXPECT_EQ(queue.statistics(telegram_lane::BULK).dropped, 2u);
+}
@@ -0,0 +1,92 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+#include <gtest/gtest.h>
+
+#include <sched.h>
+
+#include <string>
+#include <thread>
+
+#include <septentrio_gnss_driver/communication/thread_scheduling.hpp>
+
+TEST(ThreadSchedulingTest, parseCpuList)
+{
+    std::vector<int> cpus;
+    EXPECT_TRUE(io::parseCpuList("", cpus));
+    EXPECT_TRUE(cpus.empty());
+    EXPECT_TRUE(io::parseCpuList("0,2-4", cpus));
+    EXPECT_EQ(cpus, (std::vector<int>{0, 2, 3, 4}));
+    EXPECT_TRUE(io::parseCpuList("1, 3", cpus));
+    EXPECT_EQ(cpus, (std::vector<int>{1, 3}));
+
+    EXPECT_FALSE(io::parseCpuList("a", cpus));
+    EXPECT_FALSE(io::parseCpuList("3-1", cpus));
+    EXPECT_FALSE(io::parseCpuList("1-", cpus));
+    EXPECT_FALSE(io::parseCpuList("1-2-3", cpus));
+    EXPECT_FALSE(io::parseCpuList("-1", cpus));
+}
+
+TEST(ThreadSchedulingTest, parseSchedulingPolicy)
+{
+    int policy;
+    EXPECT_TRUE(io::parseSchedulingPolicy("fifo", policy));
+    EXPECT_EQ(policy, SCHED_FIFO);
+    EXPECT_TRUE(io::parseSchedulingPolicy("rr", policy));
+    EXPECT_EQ(policy, SCHED_RR);
+    EXPECT_TRUE(io::parseSchedulingPolicy("other", policy));
+    EXPECT_EQ(policy, SCHED_OTHER);
+    EXPECT_FALSE(io::parseSchedulingPolicy("batch", policy));
+}
+
+TEST(ThreadSchedulingTest, configureThread)
+{
+    // A thread of its own, so that the test thread is not pinned
+    std::thread thread([]() {
+        io::ThreadScheduling scheduling;
+        scheduling.cpus = {0};
+        std::string error;
+        EXPECT_TRUE(io::configureThread(pthread_self(), "septentrio_test",
+                                        scheduling, error))
+            << error;
+
+        char name[16];
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        EXPECT_STREQ(name, "septentrio_test");
+        EXPECT_EQ(sched_getcpu(), 0);
+
+        // Real-time priorities start at 1
+        scheduling.policy = SCHED_FIFO;
+        scheduling.priority = 0;
+        EXPECT_FALSE(io::configureThread(pthread_self(), "septentrio_test",
+                                         scheduling, error));
+        EXPECT_NE(error.find("scheduling"), std::string::npos);
+    });
+    thread.join();
+}
@@ -0,0 +1,95 @@
+// *****************************************************************************
+//
+// © Copyright 2020, Septentrio NV/SA.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//    1. Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//    2. Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//    3. Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// *****************************************************************************
+#include <gtest/gtest.h>
+
+#include <string>
+#include <tuple>
+
+#include <septentrio_gnss_driver/communication/write_queue.hpp>
+
+TEST(WriteQueueTest, oneWriteInFlight)
+{
+    io::WriteQueue queue;
+    EXPECT_TRUE(queue.push("sso, all, none, none, off\r", write_priority::COMMAND));
+    EXPECT_FALSE(queue.push("sno, all, none, none, off\r", write_priority::COMMAND));
+
+    auto batch = queue.gather();
+    ASSERT_EQ(batch.size(), 2u);
+    EXPECT_EQ(batch[0], "sso, all, none, none, off\r");
+    EXPECT_EQ(batch[1], "sno, all, none, none, off\r");
+    EXPECT_EQ(queue.depth(), 0u);
+
+    // Pushed while writing, continued by the writer
+    EXPECT_FALSE(queue.push("grc\r", write_priority::COMMAND));
+    EXPECT_TRUE(queue.complete(true));
+    EXPECT_EQ(queue.gather().size(), 1u);
+    EXPECT_FALSE(queue.complete(true));
+
+    // Idle again
+    EXPECT_TRUE(queue.push("grc\r", write_priority::COMMAND));
+
+    const io::WriteStatistics& stats = queue.statistics();
+    EXPECT_EQ(stats.messages, 3u);
+    EXPECT_EQ(stats.writes, 2u);
+    EXPECT_EQ(stats.maxDepth, 2u);
+    EXPECT_GE(stats.latencyMaxNs, stats.latencySumNs / stats.messages);
+}
+
+TEST(WriteQueueTest, realtimeFirst)
+{
+    io::WriteQueue queue;
+    EXPECT_TRUE(queue.push("cmd1", write_priority::COMMAND));
+    EXPECT_FALSE(queue.push("cmd2", write_priority::COMMAND));
+    EXPECT_FALSE(queue.push("vel1", write_priority::REALTIME));
+    EXPECT_FALSE(queue.push("vel2", write_priority::REALTIME));
+
+    auto batch = queue.gather();
+    ASSERT_EQ(batch.size(), 4u);
+    EXPECT_EQ(batch[0], "vel1");
+    EXPECT_EQ(batch[1], "vel2");
+    EXPECT_EQ(batch[2], "cmd1");
+    EXPECT_EQ(batch[3], "cmd2");
+    EXPECT_FALSE(queue.complete(false));
+    EXPECT_EQ(queue.statistics().failures, 4u);
+    EXPECT_EQ(queue.statistics().messages, 0u);
+}
+
+TEST(WriteQueueTest, gatherLimit)
+{
+    io::WriteQueue queue;
+    for (size_t i = 0; i < io::MAX_WRITE_GATHER + 1; ++i)
+        std::ignore = queue.push(std::to_string(i), write_priority::COMMAND);
+
+    EXPECT_EQ(queue.gather().size(), io::MAX_WRITE_GATHER);
+    EXPECT_EQ(queue.depth(), 1u);
+    EXPECT_TRUE(queue.complete(true));
+    EXPECT_EQ(queue.gather().front(), std::to_string(io::MAX_WRITE_GATHER));
+    EXPECT_FALSE(queue.complete(true));
+}